@@ -67,13 +67,13 @@ public:
   void Run ();
   /// Report results
   void Report (std::ostream & os);
-  void CourseChange (std::string context, Ptr<const MobilityModel> mobility);
+  void CourseChange (uint32_t nodeid, Ptr<const MobilityModel> mobility);
   void SetupPacketSend (uint32_t nodeid);
-  void DevTxTrace (std::string context, Ptr<const Packet> p);
+  void DevTxTrace (uint32_t nodeid, Ptr<const Packet> p);
   void SetupPacketReceive (Ipv4Address addr, Ptr <Node> node, uint16_t port);
   void ReceivePacket (Ptr<Socket> socket);
-  void WifiMacRxTrace (std::string context, Ptr<const Packet> p);
-  void RxTrace (std::string context, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t i);
+  void WifiMacRxTrace (uint32_t nodeid, Ptr<const Packet> p);
+  void RxTrace (uint32_t nodeid, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t i);
   
 private:
   ///\name parameters
@@ -148,15 +148,8 @@ private:
 };
 
 void
-GpsrExample::CourseChange (std::string context, Ptr<const MobilityModel> mobility)
-{  
-  size_t first_delimit = context.find_first_of ('/', 1);
-  size_t second_delimit = context.find_first_of ('/', first_delimit + 1);
-  std::string nodeid_str = context.substr (first_delimit + 1, second_delimit - 1 - first_delimit);
-  stringstream ss (nodeid_str);
-  uint32_t nodeid;
-  ss >> nodeid;
-
+GpsrExample::CourseChange (uint32_t nodeid, Ptr<const MobilityModel> mobility)
+{
   if (Simulator::Now ().GetSeconds () == 0) {
     std::cout << nodeid << " " << mobility->GetPosition () << std::endl;
   }
@@ -300,43 +293,22 @@ GpsrExample::CourseChange (std::string context, Ptr<const MobilityModel> mobilit
 // }
 
 static void 
-MacTxDrop (std::string context, Ptr<const Packet> packet)
+MacTxDrop (uint32_t nodeid, Ptr<const Packet> packet)
 {
-   size_t first_delimit = context.find_first_of ('/', 1);
-   size_t second_delimit = context.find_first_of ('/', first_delimit + 1);
-   std::string nodeid_str = context.substr (first_delimit + 1, second_delimit - 1 - first_delimit);
-   stringstream ss (nodeid_str);
-   uint32_t nodeid;
-   ss >> nodeid;
-
    count_txDrop[nodeid] = count_txDrop[nodeid] + 1;
 }
 
 static void 
-MacRxDrop (std::string context, Ptr<const Packet> p)
+MacRxDrop (uint32_t nodeid, Ptr<const Packet> p)
 {
-  size_t first_delimit = context.find_first_of ('/', 1);
-  size_t second_delimit = context.find_first_of ('/', first_delimit + 1);
-  std::string nodeid_str = context.substr (first_delimit + 1, second_delimit - 1 - first_delimit);
-  stringstream ss (nodeid_str);
-  uint32_t nodeid;
-  ss >> nodeid;
-  
   count_rxDrop[nodeid] = count_rxDrop[nodeid] + 1;
  
   //std::cout << *p << std::endl;
 }
 
 void
-GpsrExample::WifiMacRxTrace (std::string context, Ptr<const Packet> p)
+GpsrExample::WifiMacRxTrace (uint32_t nodeid, Ptr<const Packet> p)
 {
-  size_t first_delimit = context.find_first_of ('/', 1);
-  size_t second_delimit = context.find_first_of ('/', first_delimit + 1);
-  std::string nodeid_str = context.substr (first_delimit + 1, second_delimit - 1 - first_delimit);
-  stringstream ss (nodeid_str);
-  uint32_t nodeid;
-  ss >> nodeid;
-  
   Ptr<Node> network_node = nodes.Get(nodeid); 
   Ptr<MobilityModel> node_mob = network_node->GetObject<MobilityModel>();
 
@@ -380,15 +352,8 @@ GpsrExample::WifiMacRxTrace (std::string context, Ptr<const Packet> p)
 }
 
 void 
-GpsrExample::RxTrace (std::string context, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t i)
+GpsrExample::RxTrace (uint32_t nodeid, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t i)
 {
-  size_t first_delimit = context.find_first_of ('/', 1);
-  size_t second_delimit = context.find_first_of ('/', first_delimit + 1);
-  std::string nodeid_str = context.substr (first_delimit + 1, second_delimit - 1 - first_delimit);
-  stringstream ss (nodeid_str);
-  uint32_t nodeid;
-  ss >> nodeid; 
-
   Ptr<Node> network_node = nodes.Get(nodeid); 
   Ptr<MobilityModel> node_mob = network_node->GetObject<MobilityModel>();
 
@@ -414,16 +379,8 @@ GpsrExample::RxTrace (std::string context, Ptr<const Packet> packet, Ptr<Ipv4> i
 }
 
 void
-GpsrExample::DevTxTrace (std::string context, Ptr<const Packet> p)
+GpsrExample::DevTxTrace (uint32_t nodeid, Ptr<const Packet> p)
 {
-
-  size_t first_delimit = context.find_first_of ('/', 1);
-  size_t second_delimit = context.find_first_of ('/', first_delimit + 1);
-  std::string nodeid_str = context.substr (first_delimit + 1, second_delimit - 1 - first_delimit);
-  stringstream ss (nodeid_str);
-  uint32_t nodeid;
-  ss >> nodeid; 
-
   Ptr<Node> network_node = nodes.Get(nodeid); 
   Ptr<MobilityModel> node_mob = network_node->GetObject<MobilityModel>();
 
@@ -609,18 +566,20 @@ GpsrExample::Run ()
   os_rlf.open (rxlogFile.c_str());
   os_tlf.open (txlogFile.c_str());
 
-  // Connecting to trace sources
-  Config::Connect ("/NodeList/*/$ns3::MobilityModel/CourseChange", MakeCallback (&GpsrExample::CourseChange, this));
+  // Connecting to trace sources. The paths are resolved once and the
+  // callbacks receive the node id (first index of the path) instead of
+  // a context string which would have to be parsed on every event.
+  Config::Path ("/NodeList/*/$ns3::MobilityModel/CourseChange").ConnectWithIndex (MakeCallback (&GpsrExample::CourseChange, this));
 
-  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxDrop", MakeCallback(&MacTxDrop));
+  Config::Path ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxDrop").ConnectWithIndex (MakeCallback (&MacTxDrop));
 
-  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxDrop", MakeCallback(&MacRxDrop));
+  Config::Path ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxDrop").ConnectWithIndex (MakeCallback (&MacRxDrop));
 
-  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacRx", MakeCallback (&GpsrExample::WifiMacRxTrace, this));
+  Config::Path ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacRx").ConnectWithIndex (MakeCallback (&GpsrExample::WifiMacRxTrace, this));
 
-  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacTx", MakeCallback (&GpsrExample::DevTxTrace, this));
+  Config::Path ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacTx").ConnectWithIndex (MakeCallback (&GpsrExample::DevTxTrace, this));
 
-  //Config::Connect ("/NodeList/2/$ns3::Ipv4L3Protocol/Rx", MakeCallback (&GpsrExample::RxTrace, this));
+  //Config::Path ("/NodeList/2/$ns3::Ipv4L3Protocol/Rx").ConnectWithIndex (MakeCallback (&GpsrExample::RxTrace, this));
   
   std::cout << "Starting simulation for " << totalTime << " s ...\n";
   
@@ -25,8 +25,12 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "abort.h"
+#include "trace-source-accessor.h"
 
 #include <sstream>
+#include <set>
+#include <limits>
 
 NS_LOG_COMPONENT_DEFINE ("Config");
 
@@ -128,79 +132,79 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 
 } // namespace Config
 
+//
+// An array path segment ("*", "3", "[2-5]", "1|[4-6]") compiled into a set
+// of index ranges, so that matching an index does not parse strings.
+//
 class ArrayMatcher
 {
 public:
   ArrayMatcher (std::string element);
   bool Matches (uint32_t i) const;
 private:
+  void Compile (std::string element);
   bool StringToUint32 (std::string str, uint32_t *value) const;
   std::string m_element;
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
   : m_element (element)
 {
+  Compile (element);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+void
+ArrayMatcher::Compile (std::string element)
 {
-  if (m_element == "*")
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_ranges.push_back (std::make_pair (0U, std::numeric_limits<uint32_t>::max ()));
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      Compile (left);
+      Compile (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
-          StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin (); j != m_ranges.end (); ++j)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-      return true;
+      if (i >= j->first && i <= j->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
     }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
@@ -216,6 +220,14 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 }
 
 
+//
+// The path is split into its segments once, when the resolver is built.
+// Type ids named by "$" segments and the kind of the attributes named by the
+// other segments are looked up the first time they are needed and cached,
+// per object type for the attributes, so that resolving the same path over
+// many objects, or many times, does no string work beyond name service
+// lookups.
+//
 class Resolver
 {
 public:
@@ -223,21 +235,62 @@ public:
   virtual ~Resolver ();
 
   void Resolve (Ptr<Object> root);
+protected:
+  std::string GetResolvedPath (void) const;
+  void GetResolvedIndices (std::vector<uint32_t> *indices) const;
 private:
+  enum AttributeKind {
+    ATTRIBUTE_OTHER,
+    ATTRIBUTE_POINTER,
+    ATTRIBUTE_VECTOR
+  };
+  struct AttributeCache
+  {
+    uint16_t tid;
+    enum AttributeKind kind;
+    Ptr<const AttributeAccessor> accessor;
+  };
+  struct Segment
+  {
+    Segment (std::string item);
+    std::string item;
+    ArrayMatcher matcher;
+    bool tidResolved;
+    TypeId tid;
+    std::vector<struct AttributeCache> attributes;
+  };
+  struct Frame
+  {
+    uint32_t segment;
+    uint32_t index;
+    bool isIndex;
+  };
+
   void Canonicalize (void);
-  void DoResolve (std::string path, Ptr<Object> root);
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void Compile (void);
+  void DoResolve (uint32_t i, Ptr<Object> root);
+  void DoArrayResolve (uint32_t i, const ObjectPtrContainerValue &vector);
   void DoResolveOne (Ptr<Object> object);
-  std::string GetResolvedPath (void) const;
-  virtual void DoOne (Ptr<Object> object, std::string path) = 0;
-  std::vector<std::string> m_workStack;
+  void Push (uint32_t segment, uint32_t index, bool isIndex);
+  const struct AttributeCache &LookupAttribute (Segment &segment, TypeId tid);
+  virtual void DoOne (Ptr<Object> object) = 0;
+  std::vector<Segment> m_segments;
+  std::vector<Frame> m_workStack;
   std::string m_path;
 };
 
+Resolver::Segment::Segment (std::string item)
+  : item (item),
+    matcher (item),
+    tidResolved (false)
+{
+}
+
 Resolver::Resolver (std::string path)
   : m_path (path)
 {
   Canonicalize ();
+  Compile ();
 }
 Resolver::~Resolver ()
 {
@@ -260,38 +313,117 @@ Resolver::Canonicalize (void)
     }
 }
 
+void
+Resolver::Compile (void)
+{
+  std::string::size_type cur = 0;
+  std::string::size_type next = m_path.find ("/", cur + 1);
+  while (next != std::string::npos)
+    {
+      m_segments.push_back (Segment (m_path.substr (cur + 1, next - (cur + 1))));
+      cur = next;
+      next = m_path.find ("/", cur + 1);
+    }
+}
+
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
-  DoResolve (m_path, root);
+  m_workStack.clear ();
+  DoResolve (0, root);
 }
 
 std::string
 Resolver::GetResolvedPath (void) const
 {
-  std::string fullPath = "/";
-  for (std::vector<std::string>::const_iterator i = m_workStack.begin (); i != m_workStack.end (); i++)
+  std::ostringstream oss;
+  oss << "/";
+  for (std::vector<Frame>::const_iterator i = m_workStack.begin (); i != m_workStack.end (); i++)
     {
-      fullPath += *i + "/";
+      if (i->isIndex)
+        {
+          oss << i->index << "/";
+        }
+      else
+        {
+          oss << m_segments[i->segment].item << "/";
+        }
+    }
+  return oss.str ();
+}
+
+void
+Resolver::GetResolvedIndices (std::vector<uint32_t> *indices) const
+{
+  for (std::vector<Frame>::const_iterator i = m_workStack.begin (); i != m_workStack.end (); i++)
+    {
+      if (i->isIndex)
+        {
+          indices->push_back (i->index);
+        }
     }
-  return fullPath;
+}
+
+void
+Resolver::Push (uint32_t segment, uint32_t index, bool isIndex)
+{
+  Frame frame;
+  frame.segment = segment;
+  frame.index = index;
+  frame.isIndex = isIndex;
+  m_workStack.push_back (frame);
 }
 
 void 
 Resolver::DoResolveOne (Ptr<Object> object)
 {
   NS_LOG_DEBUG ("resolved="<<GetResolvedPath ());
-  DoOne (object, GetResolvedPath ());
+  DoOne (object);
+}
+
+const struct Resolver::AttributeCache &
+Resolver::LookupAttribute (Segment &segment, TypeId tid)
+{
+  uint16_t uid = tid.GetUid ();
+  for (std::vector<struct AttributeCache>::const_iterator i = segment.attributes.begin ();
+       i != segment.attributes.end (); ++i)
+    {
+      if (i->tid == uid)
+        {
+          return *i;
+        }
+    }
+  struct AttributeCache cache;
+  cache.tid = uid;
+  cache.kind = ATTRIBUTE_OTHER;
+  struct TypeId::AttributeInformation info;
+  if (!tid.LookupAttributeByName (segment.item, &info))
+    {
+      NS_LOG_DEBUG ("Requested item="<<segment.item<<" does not exist on path="<<GetResolvedPath ());
+    }
+  else if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+    {
+      cache.kind = ATTRIBUTE_POINTER;
+    }
+  else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+    {
+      cache.kind = ATTRIBUTE_VECTOR;
+    }
+  if (cache.kind != ATTRIBUTE_OTHER &&
+      (info.flags & TypeId::ATTR_GET) && info.accessor->HasGetter ())
+    {
+      cache.accessor = info.accessor;
+    }
+  segment.attributes.push_back (cache);
+  return segment.attributes.back ();
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t i, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (i << root);
 
-  if (next == std::string::npos)
+  if (i == m_segments.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -307,8 +439,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  Segment &segment = m_segments[i];
+  const std::string &item = segment.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -319,11 +451,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          Push (i, 0, false);
+          DoResolve (i + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -339,8 +470,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   if (namedObject)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      Push (i, 0, false);
+      DoResolve (i + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -356,40 +487,41 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (item.find ("$") == 0)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      if (!segment.tidResolved)
+        {
+          segment.tid = TypeId::LookupByName (item.substr (1, item.size () - 1));
+          segment.tidResolved = true;
+        }
+      NS_LOG_DEBUG ("GetObject="<<segment.tid.GetName ()<<" on path="<<GetResolvedPath ());
+      Ptr<Object> object = root->GetObject<Object> (segment.tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<segment.tid.GetName ()<<") failed on path="<<GetResolvedPath ());
           return;
         }
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      Push (i, 0, false);
+      DoResolve (i + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid = root->GetInstanceTypeId ();
-      struct TypeId::AttributeInformation info;
-      if (!tid.LookupAttributeByName (item, &info))
-        {
-          NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
-          return;
-        }
-      // attempt to cast to a pointer checker.
-      const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-      if (ptr != 0)
+      const struct AttributeCache &attribute = LookupAttribute (segment, root->GetInstanceTypeId ());
+      if (attribute.kind == ATTRIBUTE_POINTER)
         {
           NS_LOG_DEBUG ("GetAttribute(ptr)="<<item<<" on path="<<GetResolvedPath ());
           PointerValue ptr;
-          root->GetAttribute (item, ptr);
+          if (attribute.accessor != 0)
+            {
+              attribute.accessor->Get (PeekPointer (root), ptr);
+            }
+          else
+            {
+              root->GetAttribute (item, ptr);
+            }
           Ptr<Object> object = ptr.Get<Object> ();
           if (object == 0)
             {
@@ -398,19 +530,24 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
                             " but is null.");
               return;
             }
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, object);
+          Push (i, 0, false);
+          DoResolve (i + 1, object);
           m_workStack.pop_back ();
         }
-      // attempt to cast to an object vector.
-      const ObjectPtrContainerChecker *vectorChecker = dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-      if (vectorChecker != 0)
+      else if (attribute.kind == ATTRIBUTE_VECTOR)
         {
           NS_LOG_DEBUG ("GetAttribute(vector)="<<item<<" on path="<<GetResolvedPath ());
           ObjectPtrContainerValue vector;
-          root->GetAttribute (item, vector);
-          m_workStack.push_back (item);
-          DoArrayResolve (pathLeft, vector);
+          if (attribute.accessor != 0)
+            {
+              attribute.accessor->Get (PeekPointer (root), vector);
+            }
+          else
+            {
+              root->GetAttribute (item, vector);
+            }
+          Push (i, 0, false);
+          DoArrayResolve (i + 1, vector);
           m_workStack.pop_back ();
         }
       // this could be anything else and we don't know what to do with it.
@@ -419,27 +556,19 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector)
+Resolver::DoArrayResolve (uint32_t i, const ObjectPtrContainerValue &vector)
 {
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  if (i == m_segments.size ())
     {
-      NS_FATAL_ERROR ("vector path includes no index data on path=\""<<path<<"\"");
+      NS_FATAL_ERROR ("vector path includes no index data on path=\""<<m_path<<"\"");
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
-
-  ArrayMatcher matcher = ArrayMatcher (item);
-  for (uint32_t i = 0; i < vector.GetN (); i++)
+  const ArrayMatcher &matcher = m_segments[i].matcher;
+  for (uint32_t j = 0; j < vector.GetN (); j++)
     {
-      if (matcher.Matches (i))
+      if (matcher.Matches (j))
         {
-          std::ostringstream oss;
-          oss << i;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, vector.Get (i));
+          Push (i, j, true);
+          DoResolve (i + 1, vector.Get (j));
           m_workStack.pop_back ();
         }
     }
@@ -481,18 +610,12 @@ ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) c
 void 
 ConfigImpl::Set (std::string path, const AttributeValue &value)
 {
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.Set (leaf, value);
+  Config::Path (path).Set (value);
 }
 void 
 ConfigImpl::ConnectWithoutContext (std::string path, const CallbackBase &cb)
 {
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.ConnectWithoutContext (leaf, cb);
+  Config::Path (path).ConnectWithoutContext (cb);
 }
 void 
 ConfigImpl::DisconnectWithoutContext (std::string path, const CallbackBase &cb)
@@ -505,10 +628,7 @@ ConfigImpl::DisconnectWithoutContext (std::string path, const CallbackBase &cb)
 void 
 ConfigImpl::Connect (std::string path, const CallbackBase &cb)
 {
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.Connect (leaf, cb);
+  Config::Path (path).Connect (cb);
 }
 void 
 ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
@@ -529,9 +649,9 @@ public:
     LookupMatchesResolver (std::string path)
       : Resolver (path)
     {}
-    virtual void DoOne (Ptr<Object> object, std::string path) {
+    virtual void DoOne (Ptr<Object> object) {
       m_objects.push_back (object);
-      m_contexts.push_back (path);
+      m_contexts.push_back (GetResolvedPath ());
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
@@ -581,6 +701,340 @@ ConfigImpl::GetRootNamespaceObject (uint32_t i) const
   return m_roots[i];
 }
 
+//
+// The shared state behind Config::Path: the compiled path, the result of
+// the last match and the connections made so far.
+//
+class PathResolver : public Resolver
+{
+public:
+  enum ContextKind {
+    CONTEXT_NONE,
+    CONTEXT_STRING,
+    CONTEXT_INDEX
+  };
+  struct Connection
+  {
+    CallbackBase cb;
+    enum ContextKind kind;
+    uint32_t level;
+  };
+
+  PathResolver (std::string path, std::string root, std::string leaf);
+  virtual ~PathResolver ();
+
+  static std::set<PathResolver *> *GetResolvers (void);
+  static void Forget (Object *object);
+  static void SetConnected (Object *object);
+
+  void Lookup (bool withContexts);
+  Ptr<const TraceSourceAccessor> LookupTraceSource (Ptr<Object> object);
+
+  std::string m_path;
+  std::string m_root;
+  std::string m_leaf;
+  uint32_t m_count;
+
+  // result of the last Lookup, cleared once used so that the path does
+  // not keep the objects alive.
+  std::vector<Ptr<Object> > m_objects;
+  std::vector<std::string> m_contexts;
+  std::vector<uint32_t> m_indices;
+  std::vector<uint32_t> m_indexStart;
+
+  std::vector<struct Connection> m_connections;
+  // the objects are not held: they are erased by ForgetObject when they
+  // are deleted, before a new object can be allocated at their address.
+  std::set<const Object *> m_connected;
+  std::vector<std::pair<uint16_t, Ptr<const TraceSourceAccessor> > > m_traceSources;
+private:
+  virtual void DoOne (Ptr<Object> object);
+  bool m_withContexts;
+};
+
+PathResolver::PathResolver (std::string path, std::string root, std::string leaf)
+  : Resolver (root),
+    m_path (path),
+    m_root (root),
+    m_leaf (leaf),
+    m_count (1),
+    m_withContexts (false)
+{
+  GetResolvers ()->insert (this);
+}
+
+PathResolver::~PathResolver ()
+{
+  GetResolvers ()->erase (this);
+}
+
+std::set<PathResolver *> *
+PathResolver::GetResolvers (void)
+{
+  // never deleted, so that the objects deleted during the static
+  // destruction can still look it up.
+  static std::set<PathResolver *> *resolvers = new std::set<PathResolver *> ();
+  return resolvers;
+}
+
+void
+PathResolver::Forget (Object *object)
+{
+  std::set<PathResolver *> *resolvers = GetResolvers ();
+  for (std::set<PathResolver *>::iterator i = resolvers->begin (); i != resolvers->end (); ++i)
+    {
+      (*i)->m_connected.erase (object);
+    }
+}
+
+void
+PathResolver::SetConnected (Object *object)
+{
+  object->m_pathConnected = true;
+}
+
+void
+PathResolver::Lookup (bool withContexts)
+{
+  NS_LOG_FUNCTION (m_path << withContexts);
+  m_objects.clear ();
+  m_contexts.clear ();
+  m_indices.clear ();
+  m_indexStart.clear ();
+  m_withContexts = withContexts;
+
+  ConfigImpl *config = Singleton<ConfigImpl>::Get ();
+  for (uint32_t i = 0; i < config->GetRootNamespaceObjectN (); i++)
+    {
+      Resolve (config->GetRootNamespaceObject (i));
+    }
+  Resolve (0);
+  m_indexStart.push_back (m_indices.size ());
+}
+
+void
+PathResolver::DoOne (Ptr<Object> object)
+{
+  m_objects.push_back (object);
+  if (m_withContexts)
+    {
+      m_contexts.push_back (GetResolvedPath ());
+    }
+  m_indexStart.push_back (m_indices.size ());
+  GetResolvedIndices (&m_indices);
+}
+
+Ptr<const TraceSourceAccessor>
+PathResolver::LookupTraceSource (Ptr<Object> object)
+{
+  TypeId tid = object->GetInstanceTypeId ();
+  uint16_t uid = tid.GetUid ();
+  for (std::vector<std::pair<uint16_t, Ptr<const TraceSourceAccessor> > >::const_iterator i = m_traceSources.begin ();
+       i != m_traceSources.end (); ++i)
+    {
+      if (i->first == uid)
+        {
+          return i->second;
+        }
+    }
+  Ptr<const TraceSourceAccessor> accessor = tid.LookupTraceSourceByName (m_leaf);
+  m_traceSources.push_back (std::make_pair (uid, accessor));
+  return accessor;
+}
+
+namespace Config {
+
+Path::Path (std::string path)
+{
+  std::string::size_type slash = path.find_last_of ("/");
+  NS_ASSERT (slash != std::string::npos);
+  std::string root = path.substr (0, slash);
+  std::string leaf = path.substr (slash+1, path.size ()-(slash+1));
+  NS_LOG_FUNCTION (path << root << leaf);
+  m_resolver = new PathResolver (path, root, leaf);
+}
+Path::Path (const Path &o)
+  : m_resolver (o.m_resolver)
+{
+  m_resolver->m_count++;
+}
+Path &
+Path::operator = (const Path &o)
+{
+  o.m_resolver->m_count++;
+  if (--m_resolver->m_count == 0)
+    {
+      delete m_resolver;
+    }
+  m_resolver = o.m_resolver;
+  return *this;
+}
+Path::~Path ()
+{
+  if (--m_resolver->m_count == 0)
+    {
+      delete m_resolver;
+    }
+  m_resolver = 0;
+}
+
+std::string
+Path::GetPath (void) const
+{
+  return m_resolver->m_path;
+}
+
+MatchContainer
+Path::LookupMatches (void) const
+{
+  m_resolver->Lookup (true);
+  MatchContainer matches (m_resolver->m_objects, m_resolver->m_contexts, m_resolver->m_root);
+  m_resolver->m_objects.clear ();
+  return matches;
+}
+
+void
+Path::Set (const AttributeValue &value) const
+{
+  m_resolver->Lookup (false);
+  for (std::vector<Ptr<Object> >::const_iterator i = m_resolver->m_objects.begin ();
+       i != m_resolver->m_objects.end (); ++i)
+    {
+      (*i)->SetAttribute (m_resolver->m_leaf, value);
+    }
+  m_resolver->m_objects.clear ();
+}
+
+void
+Path::Connect (const CallbackBase &cb)
+{
+  struct PathResolver::Connection connection;
+  connection.cb = cb;
+  connection.kind = PathResolver::CONTEXT_STRING;
+  connection.level = 0;
+  m_resolver->m_connections.push_back (connection);
+  DoUpdate (true);
+}
+
+void
+Path::ConnectWithoutContext (const CallbackBase &cb)
+{
+  struct PathResolver::Connection connection;
+  connection.cb = cb;
+  connection.kind = PathResolver::CONTEXT_NONE;
+  connection.level = 0;
+  m_resolver->m_connections.push_back (connection);
+  DoUpdate (true);
+}
+
+void
+Path::ConnectWithIndex (const CallbackBase &cb, uint32_t level)
+{
+  struct PathResolver::Connection connection;
+  connection.cb = cb;
+  connection.kind = PathResolver::CONTEXT_INDEX;
+  connection.level = level;
+  m_resolver->m_connections.push_back (connection);
+  DoUpdate (true);
+}
+
+uint32_t
+Path::Update (void)
+{
+  return DoUpdate (false);
+}
+
+//
+// Objects matched for the first time get every connection made so far;
+// objects which were already connected only get the connection which was
+// just added, if any.
+//
+uint32_t
+Path::DoUpdate (bool newConnection)
+{
+  NS_LOG_FUNCTION (newConnection);
+  PathResolver *r = m_resolver;
+  if (r->m_connections.empty ())
+    {
+      return 0;
+    }
+  bool withContexts = false;
+  for (uint32_t c = 0; c < r->m_connections.size (); c++)
+    {
+      withContexts |= (r->m_connections[c].kind == PathResolver::CONTEXT_STRING);
+    }
+  r->Lookup (withContexts);
+
+  uint32_t newObjects = 0;
+  uint32_t last = r->m_connections.size () - 1;
+  for (uint32_t i = 0; i < r->m_objects.size (); i++)
+    {
+      Ptr<Object> object = r->m_objects[i];
+      bool isNew = r->m_connected.insert (PeekPointer (object)).second;
+      if (isNew)
+        {
+          PathResolver::SetConnected (PeekPointer (object));
+        }
+      if (!isNew && !newConnection)
+        {
+          continue;
+        }
+      std::string context = withContexts ? r->m_contexts[i] + r->m_leaf : std::string ();
+      uint32_t nIndices = r->m_indexStart[i + 1] - r->m_indexStart[i];
+      for (uint32_t c = isNew ? 0 : last; c <= last; c++)
+        {
+          uint32_t index = 0;
+          if (r->m_connections[c].kind == PathResolver::CONTEXT_INDEX)
+            {
+              uint32_t level = r->m_connections[c].level;
+              NS_ABORT_MSG_IF (level >= nIndices, "Config::Path::ConnectWithIndex(): path=\"" << r->m_path <<
+                               "\" has no array index at level " << level);
+              index = r->m_indices[r->m_indexStart[i] + level];
+            }
+          DoConnect (c, object, context, index);
+        }
+      if (isNew)
+        {
+          newObjects++;
+        }
+    }
+  r->m_objects.clear ();
+  return newObjects;
+}
+
+void
+Path::DoConnect (uint32_t connection, Ptr<Object> object, std::string context, uint32_t index)
+{
+  NS_LOG_FUNCTION (connection << object << context << index);
+  const struct PathResolver::Connection &c = m_resolver->m_connections[connection];
+  Ptr<const TraceSourceAccessor> accessor = m_resolver->LookupTraceSource (object);
+  if (accessor == 0)
+    {
+      NS_LOG_DEBUG ("No trace source " << m_resolver->m_leaf << " on " << object);
+      return;
+    }
+  switch (c.kind)
+    {
+    case PathResolver::CONTEXT_NONE:
+      accessor->ConnectWithoutContext (PeekPointer (object), c.cb);
+      break;
+    case PathResolver::CONTEXT_STRING:
+      accessor->Connect (PeekPointer (object), context, c.cb);
+      break;
+    case PathResolver::CONTEXT_INDEX:
+      accessor->Connect (PeekPointer (object), index, c.cb);
+      break;
+    }
+}
+
+void
+ForgetObject (Object *object)
+{
+  PathResolver::Forget (object);
+}
+
+} // namespace Config
+
 namespace Config {
 
 void Reset (void)
@@ -29,6 +29,7 @@ namespace ns3 {
 class AttributeValue;
 class Object;
 class CallbackBase;
+class PathResolver;
 
 /**
  * \brief Configuration of simulation parameters and tracing
@@ -222,6 +223,96 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \brief a configuration path which is parsed once and can be applied many
+ * times.
+ *
+ * Config::Set and Config::Connect parse their path string, look up type
+ * ids and attribute names again for every call and every matching object.
+ * A Path does this work once: the path is split into segments when it is
+ * constructed, array indices are compiled into ranges, and type id,
+ * attribute and trace source lookups are cached per object type.  The
+ * matching itself still walks the object graph, so a Path always sees the
+ * objects which exist when it is used.
+ *
+ * Connections made through a Path are remembered, so that Update can
+ * connect the same sinks to objects created later (new nodes, new devices)
+ * without touching the objects already connected.
+ */
+class Path
+{
+public:
+  /**
+   * \param path a path to match attributes or trace sources, as accepted by
+   *        Config::Set and Config::Connect.
+   */
+  Path (std::string path);
+  Path (const Path &o);
+  Path &operator = (const Path &o);
+  ~Path ();
+
+  /**
+   * \returns the path this object was created from.
+   */
+  std::string GetPath (void) const;
+
+  /**
+   * \returns the objects which hold the attribute or trace source named by
+   *          the last segment of the path.
+   */
+  MatchContainer LookupMatches (void) const;
+
+  /**
+   * \param value the value to set in all matching attributes.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value) const;
+  /**
+   * \param cb the callback to connect to the matching trace sources.
+   *
+   * The callback receives the matched path as a context string.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb);
+  /**
+   * \param cb the callback to connect to the matching trace sources.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb);
+  /**
+   * \param cb the callback to connect to the matching trace sources.
+   * \param level which array index of the matched path to pass as context.
+   *
+   * The callback receives, as a uint32_t first argument, the index matched
+   * by the level-th array segment of the path (starting at zero).  For
+   * "/NodeList/[i]/DeviceList/[j]/...", level 0 gives the node id i and
+   * level 1 the device index j.  No string is built or copied, neither when
+   * connecting nor when the trace source fires.
+   */
+  void ConnectWithIndex (const CallbackBase &cb, uint32_t level = 0);
+  /**
+   * \returns the number of newly matched objects.
+   *
+   * Match the path again and connect every callback previously connected
+   * through this object to the objects which were not matched before.
+   */
+  uint32_t Update (void);
+
+private:
+  uint32_t DoUpdate (bool newConnection);
+  void DoConnect (uint32_t connection, Ptr<Object> object, std::string context, uint32_t index);
+
+  PathResolver *m_resolver;
+};
+
+/**
+ * \param object an object which a Config::Path connected to.
+ *
+ * Invoked only by the destructor of Object, so that the paths forget
+ * the object.
+ */
+void ForgetObject (Object *object);
+
 /**
  * \param obj a new root object
  *
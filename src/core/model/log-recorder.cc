@@ -0,0 +1,806 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "log-recorder.h"
+#include "log.h"
+#include "nstime.h"
+#include "simulator.h"
+#include "fatal-impl.h"
+#include "abort.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include "system-mutex.h"
+#endif
+#include <map>
+#include <algorithm>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+static const char LOGR_MAGIC[8] = { 'n', 's', '3', 'l', 'o', 'g', 'r', 0 };
+static const uint16_t LOGR_VERSION = 1;
+
+enum FrameKind {
+  FRAME_SITE = 1,
+  FRAME_RECORD = 2,
+  FRAME_DUMP = 3
+};
+
+/* kind and payload size of a frame */
+static const uint32_t FRAME_HEADER_SIZE = 5;
+/* offset of the time in a record frame */
+static const uint32_t RECORD_TIME_OFFSET = 9;
+
+//
+// The records of a thread, oldest first, end at head and wrap around the
+// end of data.
+//
+struct LogRecorderRing
+{
+  std::vector<uint8_t> data;
+  uint32_t head;
+  uint32_t used;
+  uint32_t thread;
+  uint32_t generation;
+  // the records being built by LogRecord
+  std::vector<uint8_t> scratch;
+};
+
+bool LogRecorder::m_enabled = false;
+
+namespace {
+
+struct Site
+{
+  std::string component;
+  std::string function;
+  std::string file;
+  uint32_t line;
+  int32_t level;
+};
+
+struct RecorderState
+{
+  RecorderState ()
+    : fd (-1),
+      flight (false),
+      window (0),
+      bufferSize (0),
+      sitesWritten (0),
+      dropped (0),
+      generation (0),
+      fatalDumped (false)
+  {
+  }
+  ~RecorderState ();
+
+  // written with write(2) only, so that the fatal signal handler can
+  // write the records.
+  int fd;
+  bool flight;
+  int64_t window;
+  uint32_t bufferSize;
+  std::vector<Site> sites;
+  uint32_t sitesWritten;
+  uint64_t dropped;
+  uint32_t generation;
+  bool fatalDumped;
+  // all the rings ever created, a thread keeps its ring until it exits.
+  std::vector<LogRecorderRing *> rings;
+#ifdef HAVE_PTHREAD_H
+  SystemMutex mutex;
+#endif
+};
+
+RecorderState g_state;
+bool g_atExitRegistered = false;
+
+#ifdef HAVE_PTHREAD_H
+pthread_key_t g_ringKey;
+pthread_once_t g_ringKeyOnce = PTHREAD_ONCE_INIT;
+
+void
+CreateRingKey (void)
+{
+  pthread_key_create (&g_ringKey, 0);
+}
+#else
+LogRecorderRing *g_ring = 0;
+#endif
+
+// flushes or dumps the records when the fatal error handler flushes the
+// registered streams.
+class FatalDumpBuf : public std::streambuf
+{
+protected:
+  virtual int sync (void);
+};
+
+FatalDumpBuf g_fatalDumpBuf;
+std::ostream g_fatalDumpStream (&g_fatalDumpBuf);
+
+const int g_fatalSignals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGABRT };
+const uint32_t N_FATAL_SIGNALS = sizeof (g_fatalSignals) / sizeof (g_fatalSignals[0]);
+struct sigaction g_previousActions[N_FATAL_SIGNALS];
+
+void
+DumpOnFatal (void)
+{
+  if (!LogRecorder::IsEnabled () || g_state.fatalDumped)
+    {
+      return;
+    }
+  g_state.fatalDumped = true;
+  LogRecorder::Dump ();
+}
+
+int
+FatalDumpBuf::sync (void)
+{
+  DumpOnFatal ();
+  return 0;
+}
+
+void DumpRings (int64_t now);
+int64_t GetLatestTime (void);
+
+// async-signal-safe: the rings are written with write(2) only, without
+// taking the mutex, since the crashed thread may hold it.
+void
+FatalSignalHandler (int sig)
+{
+  if (LogRecorder::IsEnabled () && !g_state.fatalDumped)
+    {
+      g_state.fatalDumped = true;
+      DumpRings (GetLatestTime ());
+    }
+  // the handler was reset to the default action when it was called.
+  raise (sig);
+}
+
+void
+DisableAtExit (void)
+{
+  LogRecorder::Disable ();
+}
+
+void
+PutFixed (std::vector<uint8_t> &out, uint64_t v, uint32_t bytes)
+{
+  for (uint32_t i = 0; i < bytes; ++i)
+    {
+      out.push_back (static_cast<uint8_t> (v >> (8 * i)));
+    }
+}
+
+void
+PutString (std::vector<uint8_t> &out, std::string const &s)
+{
+  uint32_t size = std::min<uint32_t> (s.size (), 0xffff);
+  PutFixed (out, size, 2);
+  out.insert (out.end (), s.begin (), s.begin () + size);
+}
+
+void
+SetFixed (uint8_t *out, uint64_t v, uint32_t bytes)
+{
+  for (uint32_t i = 0; i < bytes; ++i)
+    {
+      out[i] = static_cast<uint8_t> (v >> (8 * i));
+    }
+}
+
+uint64_t
+GetFixed (uint8_t const *in, uint32_t bytes)
+{
+  uint64_t v = 0;
+  for (uint32_t i = 0; i < bytes; ++i)
+    {
+      v |= static_cast<uint64_t> (in[i]) << (8 * i);
+    }
+  return v;
+}
+
+void
+WriteRaw (uint8_t const *data, uint32_t size)
+{
+  while (size > 0)
+    {
+      ssize_t written = write (g_state.fd, data, size);
+      if (written < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          return;
+        }
+      data += written;
+      size -= written;
+    }
+}
+
+void
+Write (std::vector<uint8_t> const &frame)
+{
+  WriteRaw (&frame[0], frame.size ());
+}
+
+// the sites registered since the last write, called with the mutex held.
+void
+WriteSites (void)
+{
+  std::vector<uint8_t> frame;
+  for (; g_state.sitesWritten < g_state.sites.size (); g_state.sitesWritten++)
+    {
+      Site const &site = g_state.sites[g_state.sitesWritten];
+      frame.clear ();
+      PutFixed (frame, FRAME_SITE, 1);
+      PutFixed (frame, 0, 4);
+      PutFixed (frame, g_state.sitesWritten, 4);
+      PutFixed (frame, site.level, 4);
+      PutFixed (frame, site.line, 4);
+      PutString (frame, site.component);
+      PutString (frame, site.function);
+      PutString (frame, site.file);
+      uint32_t size = frame.size () - FRAME_HEADER_SIZE;
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          frame[1 + i] = static_cast<uint8_t> (size >> (8 * i));
+        }
+      Write (frame);
+    }
+}
+
+int64_t
+GetNow (void)
+{
+  // the time printer is only set while a simulator exists.
+  return LogGetTimePrinter () != 0 ? Simulator::Now ().GetTimeStep () : 0;
+}
+
+uint32_t
+GetContext (void)
+{
+  return LogGetTimePrinter () != 0 ? Simulator::GetContext () : 0xffffffff;
+}
+
+// write size bytes of the ring at offset.
+void
+WriteOut (LogRecorderRing const *ring, uint32_t offset, uint32_t size)
+{
+  uint32_t capacity = ring->data.size ();
+  uint32_t first = std::min (size, capacity - offset);
+  WriteRaw (&ring->data[offset], first);
+  WriteRaw (&ring->data[0], size - first);
+}
+
+// copy size bytes of the ring at offset.
+void
+CopyOut (LogRecorderRing const *ring, uint32_t offset, uint8_t *out, uint32_t size)
+{
+  uint32_t capacity = ring->data.size ();
+  uint32_t first = std::min (size, capacity - offset);
+  memcpy (out, &ring->data[offset], first);
+  memcpy (out + first, &ring->data[0], size - first);
+}
+
+void
+CopyIn (LogRecorderRing *ring, uint8_t const *in, uint32_t size)
+{
+  uint32_t capacity = ring->data.size ();
+  uint32_t first = std::min (size, capacity - ring->head);
+  memcpy (&ring->data[ring->head], in, first);
+  memcpy (&ring->data[0], in + first, size - first);
+  ring->head = (ring->head + size) % capacity;
+  ring->used += size;
+}
+
+uint32_t
+GetOldest (LogRecorderRing const *ring)
+{
+  uint32_t capacity = ring->data.size ();
+  return (ring->head + capacity - ring->used) % capacity;
+}
+
+// the size of the frame of the record at offset.
+uint32_t
+GetRecordSize (LogRecorderRing const *ring, uint32_t offset)
+{
+  uint8_t header[FRAME_HEADER_SIZE];
+  CopyOut (ring, offset, header, FRAME_HEADER_SIZE);
+  return FRAME_HEADER_SIZE + GetFixed (header + 1, 4);
+}
+
+// write out all the records of a ring, called with the mutex held or
+// from the fatal signal handler.
+void
+FlushRing (LogRecorderRing *ring)
+{
+  if (ring->used == 0)
+    {
+      return;
+    }
+  WriteOut (ring, GetOldest (ring), ring->used);
+  ring->head = 0;
+  ring->used = 0;
+}
+
+// the time of the latest record of the rings, from which the window of a
+// dump by the fatal signal handler is counted.
+int64_t
+GetLatestTime (void)
+{
+  int64_t latest = 0;
+  for (std::vector<LogRecorderRing *>::const_iterator i = g_state.rings.begin (); i != g_state.rings.end (); ++i)
+    {
+      LogRecorderRing const *ring = *i;
+      if (ring->generation != g_state.generation)
+        {
+          continue;
+        }
+      uint32_t offset = GetOldest (ring);
+      for (uint32_t done = 0; done < ring->used; )
+        {
+          uint8_t header[RECORD_TIME_OFFSET + 8];
+          CopyOut (ring, offset, header, sizeof (header));
+          latest = std::max (latest, static_cast<int64_t> (GetFixed (header + RECORD_TIME_OFFSET, 8)));
+          uint32_t size = FRAME_HEADER_SIZE + GetFixed (header + 1, 4);
+          offset = (offset + size) % ring->data.size ();
+          done += size;
+        }
+    }
+  return latest;
+}
+
+// write the records of the rings, called with the mutex held or from the
+// fatal signal handler: it neither allocates memory nor takes a lock.
+void
+DumpRings (int64_t now)
+{
+  if (!g_state.flight)
+    {
+      for (std::vector<LogRecorderRing *>::iterator i = g_state.rings.begin (); i != g_state.rings.end (); ++i)
+        {
+          if ((*i)->generation == g_state.generation)
+            {
+              FlushRing (*i);
+            }
+        }
+      return;
+    }
+  uint8_t frame[FRAME_HEADER_SIZE + 8];
+  SetFixed (frame, FRAME_DUMP, 1);
+  SetFixed (frame + 1, 8, 4);
+  SetFixed (frame + FRAME_HEADER_SIZE, now, 8);
+  WriteRaw (frame, sizeof (frame));
+  for (std::vector<LogRecorderRing *>::const_iterator i = g_state.rings.begin (); i != g_state.rings.end (); ++i)
+    {
+      LogRecorderRing const *ring = *i;
+      if (ring->generation != g_state.generation)
+        {
+          continue;
+        }
+      uint32_t offset = GetOldest (ring);
+      for (uint32_t done = 0; done < ring->used; )
+        {
+          uint8_t header[RECORD_TIME_OFFSET + 8];
+          CopyOut (ring, offset, header, sizeof (header));
+          uint32_t size = FRAME_HEADER_SIZE + GetFixed (header + 1, 4);
+          if (static_cast<int64_t> (GetFixed (header + RECORD_TIME_OFFSET, 8)) >= now - g_state.window)
+            {
+              WriteOut (ring, offset, size);
+            }
+          offset = (offset + size) % ring->data.size ();
+          done += size;
+        }
+    }
+}
+
+} // anonymous namespace
+
+RecorderState::~RecorderState ()
+{
+  // the recorder was disabled by DisableAtExit.
+  for (std::vector<LogRecorderRing *>::iterator i = rings.begin (); i != rings.end (); ++i)
+    {
+      delete *i;
+    }
+}
+
+void
+LogRecorder::Enable (std::string filename, uint32_t bufferSize)
+{
+  Disable ();
+  g_state.fd = open (filename.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  NS_ABORT_MSG_UNLESS (g_state.fd >= 0, "LogRecorder::Enable(): Unable to Open " << filename);
+  if (!g_atExitRegistered)
+    {
+      // registered after g_state was constructed, hence called before it
+      // is destroyed.
+      atexit (&DisableAtExit);
+      g_atExitRegistered = true;
+    }
+
+  std::vector<uint8_t> header;
+  header.insert (header.end (), LOGR_MAGIC, LOGR_MAGIC + sizeof (LOGR_MAGIC));
+  PutFixed (header, LOGR_VERSION, 2);
+  PutFixed (header, 0, 2);
+  PutFixed (header, Seconds (1.0).GetTimeStep (), 8);
+  Write (header);
+
+#ifdef HAVE_PTHREAD_H
+  pthread_once (&g_ringKeyOnce, &CreateRingKey);
+#endif
+  g_state.flight = false;
+  g_state.window = 0;
+  g_state.bufferSize = bufferSize;
+  g_state.dropped = 0;
+  g_state.fatalDumped = false;
+  g_state.generation++;
+  {
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (g_state.mutex);
+#endif
+    // the sites are written when they are registered, before their records.
+    g_state.sitesWritten = 0;
+    WriteSites ();
+  }
+
+  FatalImpl::RegisterStream (&g_fatalDumpStream);
+  struct sigaction action;
+  memset (&action, 0, sizeof (action));
+  action.sa_handler = &FatalSignalHandler;
+  action.sa_flags = SA_RESETHAND;
+  sigemptyset (&action.sa_mask);
+  for (uint32_t i = 0; i < N_FATAL_SIGNALS; i++)
+    {
+      sigaction (g_fatalSignals[i], &action, &g_previousActions[i]);
+    }
+  m_enabled = true;
+}
+
+void
+LogRecorder::EnableFlightRecorder (std::string filename, Time const &window, uint32_t bufferSize)
+{
+  Enable (filename, bufferSize);
+  g_state.flight = true;
+  g_state.window = window.GetTimeStep ();
+}
+
+void
+LogRecorder::Disable (void)
+{
+  if (!m_enabled)
+    {
+      return;
+    }
+  if (!g_state.flight)
+    {
+      Dump ();
+    }
+  m_enabled = false;
+  FatalImpl::UnregisterStream (&g_fatalDumpStream);
+  for (uint32_t i = 0; i < N_FATAL_SIGNALS; i++)
+    {
+      sigaction (g_fatalSignals[i], &g_previousActions[i], 0);
+    }
+  // the threads get a new ring when the recorder is enabled again.
+  for (std::vector<LogRecorderRing *>::iterator i = g_state.rings.begin (); i != g_state.rings.end (); ++i)
+    {
+      std::vector<uint8_t> ().swap ((*i)->data);
+    }
+  g_state.generation++;
+  close (g_state.fd);
+  g_state.fd = -1;
+}
+
+void
+LogRecorder::Dump (void)
+{
+  if (!m_enabled)
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (g_state.mutex);
+#endif
+  DumpRings (GetNow ());
+}
+
+uint64_t
+LogRecorder::GetDroppedRecords (void)
+{
+  return g_state.dropped;
+}
+
+uint32_t
+LogRecorder::RegisterSite (char const *component, char const *function,
+                           char const *file, uint32_t line, int32_t level)
+{
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (g_state.mutex);
+#endif
+  Site site;
+  site.component = component;
+  site.function = function;
+  site.file = file;
+  site.line = line;
+  site.level = level;
+  g_state.sites.push_back (site);
+  if (m_enabled)
+    {
+      WriteSites ();
+    }
+  return g_state.sites.size () - 1;
+}
+
+LogRecorderRing *
+LogRecorder::GetRing (void)
+{
+#ifdef HAVE_PTHREAD_H
+  LogRecorderRing *ring = static_cast<LogRecorderRing *> (pthread_getspecific (g_ringKey));
+#else
+  LogRecorderRing *ring = g_ring;
+#endif
+  if (ring != 0 && ring->generation == g_state.generation)
+    {
+      return ring;
+    }
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (g_state.mutex);
+#endif
+  if (ring == 0)
+    {
+      ring = new LogRecorderRing ();
+      ring->thread = g_state.rings.size ();
+      ring->scratch.reserve (256);
+      g_state.rings.push_back (ring);
+#ifdef HAVE_PTHREAD_H
+      pthread_setspecific (g_ringKey, ring);
+#else
+      g_ring = ring;
+#endif
+    }
+  ring->data.resize (g_state.bufferSize);
+  ring->head = 0;
+  ring->used = 0;
+  ring->generation = g_state.generation;
+  return ring;
+}
+
+void
+LogRecorder::Commit (LogRecorderRing *ring, uint8_t const *record, uint32_t size)
+{
+  uint32_t capacity = ring->data.size ();
+  if (!g_state.flight)
+    {
+      if (ring->used + size > capacity)
+        {
+#ifdef HAVE_PTHREAD_H
+          CriticalSection cs (g_state.mutex);
+#endif
+          FlushRing (ring);
+        }
+      if (size > capacity)
+        {
+          g_state.dropped++;
+          return;
+        }
+    }
+  else
+    {
+      if (size > capacity)
+        {
+          g_state.dropped++;
+          return;
+        }
+      while (ring->used + size > capacity)
+        {
+          ring->used -= GetRecordSize (ring, GetOldest (ring));
+          g_state.dropped++;
+        }
+    }
+  CopyIn (ring, record, size);
+}
+
+LogRecord::LogRecord (uint32_t site)
+  : m_ring (LogRecorder::GetRing ()),
+    m_buffer (m_ring->scratch),
+    m_start (m_buffer.size ())
+{
+  PutU8 (FRAME_RECORD);
+  PutFixed (0, 4);
+  PutFixed (site, 4);
+  PutFixed (GetNow (), 8);
+  PutFixed (GetContext (), 4);
+  PutFixed (m_ring->thread, 4);
+}
+
+LogRecord::~LogRecord ()
+{
+  uint32_t size = m_buffer.size () - m_start;
+  uint32_t payload = size - FRAME_HEADER_SIZE;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_buffer[m_start + 1 + i] = static_cast<uint8_t> (payload >> (8 * i));
+    }
+  LogRecorder::Commit (m_ring, &m_buffer[m_start], size);
+  m_buffer.resize (m_start);
+}
+
+bool
+LogRecorder::Decode (std::istream &is, std::ostream &os)
+{
+  char magic[sizeof (LOGR_MAGIC)];
+  uint8_t header[12];
+  is.read (magic, sizeof (magic));
+  is.read (reinterpret_cast<char *> (header), sizeof (header));
+  if (!is || memcmp (magic, LOGR_MAGIC, sizeof (magic)) != 0 || GetFixed (header, 2) != LOGR_VERSION)
+    {
+      return false;
+    }
+  double stepsPerSecond = static_cast<int64_t> (GetFixed (header + 4, 8));
+
+  std::map<uint32_t, Site> sites;
+  std::vector<uint8_t> frame;
+  while (true)
+    {
+      uint8_t frameHeader[FRAME_HEADER_SIZE];
+      is.read (reinterpret_cast<char *> (frameHeader), FRAME_HEADER_SIZE);
+      if (is.gcount () == 0)
+        {
+          return true;
+        }
+      uint32_t size = GetFixed (frameHeader + 1, 4);
+      frame.resize (size + 1);
+      is.read (reinterpret_cast<char *> (&frame[0]), size);
+      if (!is)
+        {
+          return false;
+        }
+      uint8_t const *p = &frame[0];
+      uint8_t const *end = p + size;
+      switch (frameHeader[0])
+        {
+        case FRAME_SITE:
+          {
+            if (size < 12)
+              {
+                return false;
+              }
+            Site &site = sites[GetFixed (p, 4)];
+            site.level = GetFixed (p + 4, 4);
+            site.line = GetFixed (p + 8, 4);
+            p += 12;
+            std::string *strings[] = { &site.component, &site.function, &site.file };
+            for (uint32_t i = 0; i < 3; i++)
+              {
+                if (p + 2 > end || p + 2 + GetFixed (p, 2) > end)
+                  {
+                    return false;
+                  }
+                strings[i]->assign (reinterpret_cast<char const *> (p + 2), GetFixed (p, 2));
+                p += 2 + GetFixed (p, 2);
+              }
+          }
+          break;
+        case FRAME_DUMP:
+          os << "# dump at " << static_cast<int64_t> (GetFixed (p, 8)) / stepsPerSecond << "s" << std::endl;
+          break;
+        case FRAME_RECORD:
+          {
+            if (size < 20)
+              {
+                return false;
+              }
+            uint32_t id = GetFixed (p, 4);
+            int64_t time = GetFixed (p + 4, 8);
+            uint32_t context = GetFixed (p + 12, 4);
+            p += 20;
+            os << time / stepsPerSecond << "s ";
+            if (context == 0xffffffff)
+              {
+                os << "-1 ";
+              }
+            else
+              {
+                os << context << " ";
+              }
+            std::map<uint32_t, Site>::const_iterator site = sites.find (id);
+            bool function = false;
+            if (site == sites.end ())
+              {
+                os << "site" << id << ": ";
+              }
+            else if (site->second.level == LOG_FUNCTION)
+              {
+                os << site->second.component << ":" << site->second.function << "(";
+                function = true;
+              }
+            else
+              {
+                os << site->second.component << ":" << site->second.function << "(): ";
+              }
+            for (uint32_t n = 0; p < end; n++)
+              {
+                if (function && n > 0)
+                  {
+                    os << ", ";
+                  }
+                uint8_t type = *p++;
+                uint32_t valueSize = type == LogRecord::CHAR || type == LogRecord::BOOL ? 1
+                  : type == LogRecord::STRING ? 2 : 8;
+                if (p + valueSize > end)
+                  {
+                    return false;
+                  }
+                switch (type)
+                  {
+                  case LogRecord::SIGNED:
+                    os << static_cast<int64_t> (GetFixed (p, 8));
+                    break;
+                  case LogRecord::UNSIGNED:
+                    os << GetFixed (p, 8);
+                    break;
+                  case LogRecord::REAL:
+                    {
+                      uint64_t bits = GetFixed (p, 8);
+                      double v;
+                      memcpy (&v, &bits, 8);
+                      os << v;
+                    }
+                    break;
+                  case LogRecord::CHAR:
+                    os << static_cast<char> (*p);
+                    break;
+                  case LogRecord::BOOL:
+                    os << (*p != 0);
+                    break;
+                  case LogRecord::POINTER:
+                    os << reinterpret_cast<void *> (static_cast<uintptr_t> (GetFixed (p, 8)));
+                    break;
+                  case LogRecord::STRING:
+                    valueSize += GetFixed (p, 2);
+                    if (p + valueSize > end)
+                      {
+                        return false;
+                      }
+                    os.write (reinterpret_cast<char const *> (p + 2), valueSize - 2);
+                    break;
+                  default:
+                    return false;
+                  }
+                p += valueSize;
+              }
+            if (function)
+              {
+                os << ")";
+              }
+            os << std::endl;
+          }
+          break;
+        default:
+          return false;
+        }
+    }
+}
+
+} // namespace ns3
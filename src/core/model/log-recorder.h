@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef LOG_RECORDER_H
+#define LOG_RECORDER_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <stdint.h>
+#include <string.h>
+#include "ptr.h"
+
+namespace ns3 {
+
+class Time;
+// the per-thread buffer of the records, private to log-recorder.cc
+struct LogRecorderRing;
+
+/**
+ * \ingroup logging
+ *
+ * \brief A binary backend of the log macros.
+ *
+ * While the recorder is enabled, the messages of the enabled log
+ * components are not formatted: the log macros store the values of their
+ * arguments, tagged with their type, in a binary record together with the
+ * id of the log statement (its component, function, file, line and level),
+ * the simulation time, the node context and the thread.  The records are
+ * written in a per-thread ring buffer and formatted offline by
+ * LogRecorder::Decode or by the log-recorder-to-ascii program in utils/.
+ *
+ * Integers, characters, booleans, floating point numbers, pointers and
+ * strings are stored as they are.  The values of the other types are
+ * formatted with their operator<< when the message is recorded.  Stream
+ * manipulators are ignored.
+ *
+ * In the streaming mode, the ring buffers are written to the file
+ * whenever they are full.  In the flight recorder mode, the oldest records
+ * are overwritten instead, and Dump () writes the records of the last
+ * window of simulation time to the file.  Dump () is called automatically
+ * on fatal errors (failed assertions, NS_FATAL_ERROR) and crashes, and can
+ * be called by a simulation to keep the records around a rare event.  On
+ * a crash, the window ends at the latest record.
+ *
+ * The file layout is:
+ *
+ * \verbatim
+ *   file header:  char magic[8] = "ns3logr", uint16 version, uint16 reserved,
+ *                 int64 time steps per second
+ *   frame:        uint8 kind, uint32 payload bytes, payload
+ *   site frame:   uint32 site, uint32 level, uint32 line,
+ *                 string component, string function, string file
+ *   record frame: uint32 site, int64 time, uint32 context, uint32 thread,
+ *                 argument[]
+ *   dump frame:   int64 time of the dump
+ *   argument:     uint8 type, value
+ *   string:       uint16 length, char[length]
+ * \endverbatim
+ *
+ * All integers are stored little-endian.
+ */
+class LogRecorder
+{
+public:
+  static const uint32_t BUFFER_SIZE_DEFAULT = 1 << 22; /**< Default size of the per-thread buffers */
+
+  /**
+   * \brief Record the log messages to a file in the streaming mode.
+   *
+   * \param filename The name of the file to create (truncated if it exists).
+   * \param bufferSize The size in bytes of the ring buffer of each thread.
+   */
+  static void Enable (std::string filename, uint32_t bufferSize = BUFFER_SIZE_DEFAULT);
+  /**
+   * \brief Keep the last log messages in memory, to be written by Dump ().
+   *
+   * \param filename The name of the file to create (truncated if it exists).
+   * \param window The simulation time before a dump of which the records
+   *        are written.  The records which were overwritten in the ring
+   *        buffers are lost even if they are more recent.
+   * \param bufferSize The size in bytes of the ring buffer of each thread.
+   */
+  static void EnableFlightRecorder (std::string filename, Time const &window,
+                                    uint32_t bufferSize = BUFFER_SIZE_DEFAULT);
+  /**
+   * \brief Write the pending records, close the file and go back to the
+   * text output.  Called at exit if the recorder is still enabled.
+   */
+  static void Disable (void);
+  /**
+   * \returns true if the log macros record their messages.
+   */
+  static bool IsEnabled (void)
+  {
+    return m_enabled;
+  }
+  /**
+   * \brief Write the records of the last window of simulation time.
+   *
+   * Only useful in the flight recorder mode, each dump is appended to the
+   * file.  In the streaming mode, the ring buffers are written out.
+   */
+  static void Dump (void);
+  /**
+   * \returns the number of records which did not fit in a ring buffer
+   * (streaming mode) or were overwritten (flight recorder mode).
+   */
+  static uint64_t GetDroppedRecords (void);
+
+  /**
+   * \brief Register a log statement.  Called once by each log macro.
+   *
+   * \returns the id of the log statement.
+   */
+  static uint32_t RegisterSite (char const *component, char const *function,
+                                char const *file, uint32_t line, int32_t level);
+
+  /**
+   * \brief Format the records of a file written by the recorder.
+   *
+   * \param is The stream to read the file from.
+   * \param os The stream to write the text to, one line per record.
+   * \returns false if the file is not a log recorder file or is truncated.
+   */
+  static bool Decode (std::istream &is, std::ostream &os);
+
+private:
+  friend class LogRecord;
+  static LogRecorderRing *GetRing (void);
+  static void Commit (LogRecorderRing *ring, uint8_t const *record, uint32_t size);
+  static bool m_enabled;
+};
+
+/**
+ * \ingroup logging
+ *
+ * \brief One record of the LogRecorder, built by the log macros.
+ *
+ * The record is committed to the ring buffer of the thread when this
+ * object is destroyed, that is, at the end of the log statement.
+ */
+class LogRecord
+{
+public:
+  enum Type
+  {
+    SIGNED = 'i',
+    UNSIGNED = 'u',
+    REAL = 'd',
+    CHAR = 'c',
+    BOOL = 'b',
+    POINTER = 'p',
+    STRING = 's'
+  };
+
+  LogRecord (uint32_t site);
+  ~LogRecord ();
+
+  LogRecord & operator<< (char v) { return PutChar (v); }
+  LogRecord & operator<< (signed char v) { return PutChar (v); }
+  LogRecord & operator<< (unsigned char v) { return PutChar (v); }
+  LogRecord & operator<< (bool v)
+  {
+    PutU8 (BOOL);
+    PutU8 (v);
+    return *this;
+  }
+  LogRecord & operator<< (short v) { return PutSigned (v); }
+  LogRecord & operator<< (int v) { return PutSigned (v); }
+  LogRecord & operator<< (long v) { return PutSigned (v); }
+  LogRecord & operator<< (long long v) { return PutSigned (v); }
+  LogRecord & operator<< (unsigned short v) { return PutUnsigned (v); }
+  LogRecord & operator<< (unsigned int v) { return PutUnsigned (v); }
+  LogRecord & operator<< (unsigned long v) { return PutUnsigned (v); }
+  LogRecord & operator<< (unsigned long long v) { return PutUnsigned (v); }
+  LogRecord & operator<< (float v) { return PutReal (v); }
+  LogRecord & operator<< (double v) { return PutReal (v); }
+  LogRecord & operator<< (long double v) { return PutReal (v); }
+  LogRecord & operator<< (char const *v) { return PutString (v, strlen (v)); }
+  LogRecord & operator<< (char *v) { return PutString (v, strlen (v)); }
+  LogRecord & operator<< (std::string const &v) { return PutString (v.data (), v.size ()); }
+  template <typename T>
+  LogRecord & operator<< (T *v) { return PutPointer ((void const *)v); }
+  template <typename T>
+  LogRecord & operator<< (Ptr<T> const &v) { return PutPointer (PeekPointer (v)); }
+  template <typename T>
+  LogRecord & operator<< (T const &v)
+  {
+    // the same overload as the text output, some of which take a
+    // non-const reference.
+    std::ostringstream oss;
+    std::ostream &os = oss;
+    os << const_cast<T &> (v);
+    return *this << oss.str ();
+  }
+  // stream manipulators
+  LogRecord & operator<< (std::ostream & (*) (std::ostream &)) { return *this; }
+  LogRecord & operator<< (std::ios_base & (*) (std::ios_base &)) { return *this; }
+
+private:
+  LogRecord (LogRecord const &);
+  LogRecord & operator= (LogRecord const &);
+
+  void PutU8 (uint8_t v)
+  {
+    m_buffer.push_back (v);
+  }
+  void PutFixed (uint64_t v, uint32_t bytes)
+  {
+    for (uint32_t i = 0; i < bytes; i++)
+      {
+        m_buffer.push_back (static_cast<uint8_t> (v >> (8 * i)));
+      }
+  }
+  LogRecord & PutChar (char v)
+  {
+    PutU8 (CHAR);
+    PutU8 (v);
+    return *this;
+  }
+  LogRecord & PutSigned (int64_t v)
+  {
+    PutU8 (SIGNED);
+    PutFixed (v, 8);
+    return *this;
+  }
+  LogRecord & PutUnsigned (uint64_t v)
+  {
+    PutU8 (UNSIGNED);
+    PutFixed (v, 8);
+    return *this;
+  }
+  LogRecord & PutReal (double v)
+  {
+    uint64_t bits;
+    memcpy (&bits, &v, 8);
+    PutU8 (REAL);
+    PutFixed (bits, 8);
+    return *this;
+  }
+  LogRecord & PutPointer (void const *v)
+  {
+    PutU8 (POINTER);
+    PutFixed (reinterpret_cast<uintptr_t> (v), 8);
+    return *this;
+  }
+  LogRecord & PutString (char const *v, uint32_t size)
+  {
+    size = size < 0xffff ? size : 0xffff;
+    PutU8 (STRING);
+    PutFixed (size, 2);
+    m_buffer.insert (m_buffer.end (), v, v + size);
+    return *this;
+  }
+
+  LogRecorderRing *m_ring;
+  std::vector<uint8_t> &m_buffer;
+  // a nested record (logged by an operator<< of an argument) is built
+  // after this one in the buffer of the thread.
+  uint32_t m_start;
+};
+
+} // namespace ns3
+
+#endif /* LOG_RECORDER_H */
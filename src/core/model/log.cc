@@ -225,13 +225,6 @@ LogComponent::EnvVarCheck (char const * name)
 }
 
 
-bool 
-LogComponent::IsEnabled (enum LogLevel level) const
-{
-  //  LogComponentEnableEnvVar ();
-  return (level & m_levels) ? 1 : 0;
-}
-
 bool
 LogComponent::IsNoneEnabled (void) const
 {
@@ -321,6 +314,22 @@ LogComponentDisableAll (enum LogLevel level)
     }
 }
 
+bool
+LogComponentIsEnabled (char const *name)
+{
+  ComponentList *components = GetComponentList ();
+  for (ComponentListI i = components->begin ();
+       i != components->end ();
+       i++)
+    {
+      if (i->first.compare (name) == 0)
+        {
+          return !i->second->IsNoneEnabled ();
+        }
+    }
+  return false;
+}
+
 void 
 LogComponentPrintList (void)
 {
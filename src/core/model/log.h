@@ -101,6 +101,15 @@ void LogComponentDisable (char const *name, enum LogLevel level);
  */
 void LogComponentDisableAll (enum LogLevel level);
 
+/**
+ * \param name a log component name
+ * \returns true if any logging output associated with that log
+ *          component is enabled, false if none is or if no log
+ *          component has that name.
+ * \ingroup logging
+ */
+bool LogComponentIsEnabled (char const *name);
+
 
 } // namespace ns3
 
@@ -117,7 +126,47 @@ void LogComponentDisableAll (enum LogLevel level);
  * environment variable.
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
-  static ns3::LogComponent g_log = ns3::LogComponent (name)
+  NS_LOG_COMPONENT_DEFINE_MASK (name, ns3::LOG_ALL)
+
+/**
+ * \ingroup logging
+ * \param name a string
+ * \param mask the log levels which can be enabled for this component.
+ *
+ * Define a Log component like NS_LOG_COMPONENT_DEFINE, but whose
+ * messages of the levels which are not in mask are removed at compile
+ * time, together with the formatting of their arguments, whatever the
+ * levels enabled at run time.  For example, the log component of a hot
+ * path can be defined with:
+ * \code
+ * NS_LOG_COMPONENT_DEFINE_MASK ("MacLow", ns3::LOG_LEVEL_WARN);
+ * \endcode
+ */
+#define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
+  static ns3::LogComponent g_log = ns3::LogComponent (name);    \
+  static const int32_t g_logCompiledLevels = (mask) & NS3_LOG_LEVELS
+
+/**
+ * \ingroup logging
+ *
+ * The log levels compiled in all the log components, set with the
+ * --log-levels option of waf configure.  Defaults to all the levels.
+ */
+#ifndef NS3_LOG_LEVELS
+#define NS3_LOG_LEVELS ns3::LOG_ALL
+#endif /* NS3_LOG_LEVELS */
+
+/**
+ * \ingroup logging
+ * \param level a log level
+ *
+ * True if the messages of this level of the current log component are
+ * compiled in and enabled.  The first test is a compile time constant
+ * so that the compiler removes the messages of the levels which are not
+ * compiled in.
+ */
+#define NS_LOG_IS_ENABLED(level)                                \
+  ((g_logCompiledLevels & (level)) != 0 && g_log.IsEnabled (level))
 
 #define NS_LOG_APPEND_TIME_PREFIX                               \
   if (g_log.IsEnabled (ns3::LOG_PREFIX_TIME))                   \
@@ -152,6 +201,29 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG_APPEND_CONTEXT
 #endif /* NS_LOG_APPEND_CONTEXT */
 
+/**
+ * \ingroup logging
+ * \param level the log level
+ *
+ * Declare a record of the LogRecorder, nsLogRecord, for the current log
+ * statement.  The statement is registered the first time it is recorded.
+ */
+#define NS_LOG_RECORD_DECLARE(level)                            \
+  static uint32_t nsLogSite = ns3::LogRecorder::RegisterSite    \
+      (g_log.Name (), __FUNCTION__, __FILE__, __LINE__, level); \
+  ns3::LogRecord nsLogRecord (nsLogSite)
+
+/**
+ * \ingroup logging
+ * \param level the log level
+ *
+ * Start a record of the LogRecorder for the current log statement, to
+ * which the arguments are streamed.
+ */
+#define NS_LOG_RECORD(level)                                    \
+  NS_LOG_RECORD_DECLARE (level);                                \
+  nsLogRecord
+
 
 
 #ifdef NS3_LOG_ENABLE
@@ -202,13 +274,20 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG(level, msg)                                      \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (level))                              \
+      if (NS_LOG_IS_ENABLED (level))                            \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          NS_LOG_APPEND_FUNC_PREFIX;                            \
-          std::clog << msg << std::endl;                        \
+          if (ns3::LogRecorder::IsEnabled ())                   \
+            {                                                   \
+              NS_LOG_RECORD (level) << msg;                     \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              NS_LOG_APPEND_FUNC_PREFIX;                        \
+              std::clog << msg << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -257,13 +336,20 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG_FUNCTION_NOARGS()                                \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_IS_ENABLED (ns3::LOG_FUNCTION))                \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "()" << std::endl;       \
+          if (ns3::LogRecorder::IsEnabled ())                   \
+            {                                                   \
+              NS_LOG_RECORD_DECLARE (ns3::LOG_FUNCTION);        \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "()" << std::endl;   \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -288,15 +374,22 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG_FUNCTION(parameters)                             \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_IS_ENABLED (ns3::LOG_FUNCTION))                \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "(";                     \
-          ns3::ParameterLogger (std::clog) << parameters;      \
-          std::clog << ")" << std::endl;                        \
+          if (ns3::LogRecorder::IsEnabled ())                   \
+            {                                                   \
+              NS_LOG_RECORD (ns3::LOG_FUNCTION) << parameters;  \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "(";                 \
+              ns3::ParameterLogger (std::clog) << parameters;  \
+              std::clog << ")" << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -363,7 +456,10 @@ class LogComponent {
 public:
   LogComponent (char const *name);
   void EnvVarCheck (char const *name);
-  bool IsEnabled (enum LogLevel level) const;
+  bool IsEnabled (enum LogLevel level) const
+  {
+    return (level & m_levels) != 0;
+  }
   bool IsNoneEnabled (void) const;
   void Enable (enum LogLevel level);
   void Disable (enum LogLevel level);
@@ -399,5 +495,6 @@ public:
 
 } // namespace ns3
 
+#include "log-recorder.h"
 
 #endif /* LOG_H */
@@ -25,6 +25,7 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#include "config.h"
 #include <vector>
 #include <sstream>
 #include <stdlib.h>
@@ -86,13 +87,18 @@ Object::Object ()
     m_disposed (false),
     m_started (false),
     m_aggregates ((struct Aggregates *) malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_getObjectCount (0),
+    m_pathConnected (false)
 {
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object () 
 {
+  if (m_pathConnected)
+    {
+      Config::ForgetObject (this);
+    }
   // remove this object from the aggregate list
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
@@ -119,7 +125,8 @@ Object::Object (const Object &o)
     m_disposed (false),
     m_started (false),
     m_aggregates ((struct Aggregates *) malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_getObjectCount (0),
+    m_pathConnected (false)
 {
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
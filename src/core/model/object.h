@@ -224,6 +224,7 @@ private:
 
   friend class ObjectFactory;
   friend class AggregateIterator;
+  friend class PathResolver;
   friend struct ObjectDeleter;
 
   /**
@@ -299,6 +300,12 @@ private:
    * of the array the most-frequently accessed elements.
    */
   uint32_t m_getObjectCount;
+  /**
+   * Set when a Config::Path connected to a trace source of this object.
+   * The paths then forget the object when it is deleted, so that they
+   * connect a new object allocated at the same address.
+   */
+  bool m_pathConnected;
 };
 
 /**
@@ -0,0 +1,478 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "replication-runner.h"
+#include "random-variable.h"
+#include "rng-stream.h"
+#include "simulator.h"
+#include "config.h"
+#include "string.h"
+#include "log.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+
+#if !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * The shared memory slot of a replication, written by the worker and read
+ * by the parent once the worker has exited.
+ */
+struct Slot
+{
+  uint32_t done;
+  uint32_t count;
+  struct
+  {
+    char name[ReplicationRunner::MAX_NAME];
+    double value;
+  } metrics[ReplicationRunner::MAX_METRICS];
+};
+
+// two-sided 95% quantiles of the Student t distribution, by degrees of freedom.
+const double g_student95[] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+} // anonymous namespace
+
+Replication::Replication (uint32_t point, uint32_t index, uint32_t run,
+                          std::map<std::string, std::string> const &parameters, void *slot)
+  : m_point (point),
+    m_index (index),
+    m_run (run),
+    m_parameters (parameters),
+    m_slot (slot)
+{
+}
+
+uint32_t
+Replication::GetPoint (void) const
+{
+  return m_point;
+}
+
+uint32_t
+Replication::GetIndex (void) const
+{
+  return m_index;
+}
+
+uint32_t
+Replication::GetRun (void) const
+{
+  return m_run;
+}
+
+std::string
+Replication::GetParameter (std::string name) const
+{
+  std::map<std::string, std::string>::const_iterator i = m_parameters.find (name);
+  if (i == m_parameters.end ())
+    {
+      NS_FATAL_ERROR ("Unknown sweep parameter \"" << name << "\"");
+    }
+  return i->second;
+}
+
+double
+Replication::GetParameterAsDouble (std::string name) const
+{
+  std::string value = GetParameter (name);
+  char *end;
+  double v = std::strtod (value.c_str (), &end);
+  if (end == value.c_str () || *end != 0)
+    {
+      NS_FATAL_ERROR ("Sweep parameter \"" << name << "\" is not a number: \"" << value << "\"");
+    }
+  return v;
+}
+
+void
+Replication::Record (std::string name, double value)
+{
+  if (name.size () >= ReplicationRunner::MAX_NAME)
+    {
+      NS_FATAL_ERROR ("Metric name too long, the maximum is " << ReplicationRunner::MAX_NAME - 1
+                      << " characters: " << name);
+    }
+  Slot *slot = static_cast<Slot *> (m_slot);
+  for (uint32_t i = 0; i < slot->count; i++)
+    {
+      if (name == slot->metrics[i].name)
+        {
+          slot->metrics[i].value = value;
+          return;
+        }
+    }
+  if (slot->count == ReplicationRunner::MAX_METRICS)
+    {
+      NS_FATAL_ERROR ("Too many metrics in a replication, the maximum is " << ReplicationRunner::MAX_METRICS);
+    }
+  std::strncpy (slot->metrics[slot->count].name, name.c_str (), ReplicationRunner::MAX_NAME - 1);
+  slot->metrics[slot->count].name[ReplicationRunner::MAX_NAME - 1] = 0;
+  slot->metrics[slot->count].value = value;
+  slot->count++;
+}
+
+ReplicationRunner::ReplicationRunner ()
+  : m_replications (1),
+    m_firstRun (1),
+    m_workers (0),
+    m_failed (0)
+{
+}
+
+void
+ReplicationRunner::AddParameter (std::string name, std::vector<std::string> const &values)
+{
+  NS_ASSERT_MSG (!values.empty (), "No value for the sweep parameter " << name);
+  m_parameters.push_back (std::make_pair (name, values));
+}
+
+void
+ReplicationRunner::AddParameter (std::string name, std::string values)
+{
+  std::vector<std::string> split;
+  std::string::size_type start = 0;
+  while (true)
+    {
+      std::string::size_type comma = values.find (',', start);
+      split.push_back (values.substr (start, comma - start));
+      if (comma == std::string::npos)
+        {
+          break;
+        }
+      start = comma + 1;
+    }
+  AddParameter (name, split);
+}
+
+void
+ReplicationRunner::SetReplications (uint32_t n)
+{
+  NS_ASSERT (n > 0);
+  m_replications = n;
+}
+
+void
+ReplicationRunner::SetFirstRun (uint32_t run)
+{
+  m_firstRun = run;
+}
+
+void
+ReplicationRunner::SetWorkers (uint32_t n)
+{
+  m_workers = n;
+}
+
+void
+ReplicationRunner::SetSetup (Callback<void> setup)
+{
+  m_setup = setup;
+}
+
+void
+ReplicationRunner::SetScenario (Callback<void, Replication &> scenario)
+{
+  m_scenario = scenario;
+}
+
+uint32_t
+ReplicationRunner::GetNPoints (void) const
+{
+  uint32_t n = 1;
+  for (uint32_t i = 0; i < m_parameters.size (); i++)
+    {
+      n *= m_parameters[i].second.size ();
+    }
+  return n;
+}
+
+std::map<std::string, std::string>
+ReplicationRunner::GetPoint (uint32_t point) const
+{
+  NS_ASSERT (point < GetNPoints ());
+  // the last parameter varies the fastest.
+  std::map<std::string, std::string> values;
+  for (uint32_t i = m_parameters.size (); i > 0; i--)
+    {
+      std::vector<std::string> const &axis = m_parameters[i - 1].second;
+      values[m_parameters[i - 1].first] = axis[point % axis.size ()];
+      point /= axis.size ();
+    }
+  return values;
+}
+
+void
+ReplicationRunner::RunReplication (uint32_t job, void *slot)
+{
+  uint32_t point = job / m_replications;
+  uint32_t index = job % m_replications;
+  uint32_t run = m_firstRun + index;
+  std::map<std::string, std::string> parameters = GetPoint (point);
+
+  SeedManager::SetRun (run);
+  // the streams created by the parent have read its run number already.
+  RngStream::ResetPackage ();
+  for (std::map<std::string, std::string>::const_iterator i = parameters.begin ();
+       i != parameters.end (); ++i)
+    {
+      if (i->first.find ("::") != std::string::npos)
+        {
+          Config::SetDefault (i->first, StringValue (i->second));
+        }
+    }
+  Replication replication (point, index, run, parameters, slot);
+  m_scenario (replication);
+  Simulator::Destroy ();
+}
+
+void
+ReplicationRunner::Collect (uint32_t job, void *slot)
+{
+  Slot const *s = static_cast<Slot const *> (slot);
+  Metrics &metrics = m_results[job / m_replications];
+  for (uint32_t i = 0; i < s->count; i++)
+    {
+      metrics[s->metrics[i].name].push_back (s->metrics[i].value);
+    }
+}
+
+uint32_t
+ReplicationRunner::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_scenario.IsNull (), "No scenario to run");
+  uint32_t jobs = GetNPoints () * m_replications;
+  m_results.clear ();
+  m_results.resize (GetNPoints ());
+  m_failed = 0;
+
+  if (!m_setup.IsNull ())
+    {
+      m_setup ();
+    }
+
+  uint32_t workers = m_workers;
+  if (workers == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      workers = cores > 0 ? cores : 1;
+    }
+
+  // the pages are zero filled.
+  size_t size = jobs * sizeof (Slot);
+  void *area = mmap (0, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (area == MAP_FAILED)
+    {
+      NS_FATAL_ERROR ("Could not map the shared memory of the replications: " << std::strerror (errno));
+    }
+  Slot *slots = static_cast<Slot *> (area);
+
+  // the buffered output would be written again by each worker.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 0;
+  while (next < jobs || !running.empty ())
+    {
+      while (next < jobs && running.size () < workers)
+        {
+          pid_t pid = fork ();
+          if (pid == 0)
+            {
+              RunReplication (next, &slots[next]);
+              std::cout.flush ();
+              std::cerr.flush ();
+              std::fflush (0);
+              _exit (0);
+            }
+          if (pid < 0)
+            {
+              if (running.empty ())
+                {
+                  NS_FATAL_ERROR ("Could not fork a replication: " << std::strerror (errno));
+                }
+              // wait for a worker to exit before trying again.
+              break;
+            }
+          NS_LOG_LOGIC ("replication " << next << " in process " << pid);
+          running[pid] = next;
+          next++;
+        }
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("Could not wait for the replications: " << std::strerror (errno));
+        }
+      std::map<pid_t, uint32_t>::iterator i = running.find (pid);
+      if (i == running.end ())
+        {
+          // not one of ours.
+          continue;
+        }
+      uint32_t job = i->second;
+      running.erase (i);
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+        {
+          slots[job].done = 1;
+        }
+      else
+        {
+          NS_LOG_WARN ("replication " << job % m_replications << " of point " << job / m_replications
+                                      << " failed with status " << status);
+          m_failed++;
+        }
+    }
+
+  for (uint32_t job = 0; job < jobs; job++)
+    {
+      if (slots[job].done)
+        {
+          Collect (job, &slots[job]);
+        }
+    }
+  munmap (area, size);
+  return m_failed;
+}
+
+std::vector<std::string>
+ReplicationRunner::GetMetrics (uint32_t point) const
+{
+  NS_ASSERT (point < m_results.size ());
+  std::vector<std::string> names;
+  for (Metrics::const_iterator i = m_results[point].begin (); i != m_results[point].end (); ++i)
+    {
+      names.push_back (i->first);
+    }
+  return names;
+}
+
+std::vector<double>
+ReplicationRunner::GetValues (uint32_t point, std::string metric) const
+{
+  NS_ASSERT (point < m_results.size ());
+  Metrics::const_iterator i = m_results[point].find (metric);
+  if (i == m_results[point].end ())
+    {
+      return std::vector<double> ();
+    }
+  return i->second;
+}
+
+struct ReplicationRunner::Summary
+ReplicationRunner::GetSummary (uint32_t point, std::string metric) const
+{
+  std::vector<double> values = GetValues (point, metric);
+  struct Summary summary;
+  summary.count = values.size ();
+  summary.mean = 0;
+  summary.stddev = 0;
+  summary.min = 0;
+  summary.max = 0;
+  summary.ci95 = 0;
+  if (values.empty ())
+    {
+      return summary;
+    }
+  summary.min = values[0];
+  summary.max = values[0];
+  double sum = 0;
+  for (uint32_t i = 0; i < values.size (); i++)
+    {
+      sum += values[i];
+      summary.min = std::min (summary.min, values[i]);
+      summary.max = std::max (summary.max, values[i]);
+    }
+  summary.mean = sum / values.size ();
+  if (values.size () > 1)
+    {
+      double squares = 0;
+      for (uint32_t i = 0; i < values.size (); i++)
+        {
+          squares += (values[i] - summary.mean) * (values[i] - summary.mean);
+        }
+      summary.stddev = std::sqrt (squares / (values.size () - 1));
+      uint32_t df = values.size () - 1;
+      uint32_t n = sizeof (g_student95) / sizeof (g_student95[0]);
+      double t = df <= n ? g_student95[df - 1] : 1.96;
+      summary.ci95 = t * summary.stddev / std::sqrt (static_cast<double> (values.size ()));
+    }
+  return summary;
+}
+
+uint32_t
+ReplicationRunner::GetFailed (void) const
+{
+  return m_failed;
+}
+
+void
+ReplicationRunner::Report (std::ostream &os) const
+{
+  for (uint32_t point = 0; point < m_results.size (); point++)
+    {
+      std::ostringstream parameters;
+      std::map<std::string, std::string> values = GetPoint (point);
+      for (std::map<std::string, std::string>::const_iterator i = values.begin (); i != values.end (); ++i)
+        {
+          parameters << i->first << "=" << i->second << " ";
+        }
+      for (Metrics::const_iterator i = m_results[point].begin (); i != m_results[point].end (); ++i)
+        {
+          struct Summary s = GetSummary (point, i->first);
+          os << parameters.str () << i->first
+             << " n=" << s.count
+             << " mean=" << s.mean
+             << " stddev=" << s.stddev
+             << " ci95=" << s.ci95
+             << " min=" << s.min
+             << " max=" << s.max
+             << std::endl;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <stdint.h>
+#include "callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ *
+ * \brief One replication of a point of a parameter sweep, as seen by the
+ * scenario which runs it.
+ */
+class Replication
+{
+public:
+  /**
+   * \returns the index of the point of the sweep.
+   */
+  uint32_t GetPoint (void) const;
+  /**
+   * \returns the index of the replication of the point, from 0.
+   */
+  uint32_t GetIndex (void) const;
+  /**
+   * \returns the run number given to SeedManager::SetRun.
+   */
+  uint32_t GetRun (void) const;
+  /**
+   * \param name the name of a parameter of the sweep.
+   * \returns the value of the parameter for this point.
+   */
+  std::string GetParameter (std::string name) const;
+  /**
+   * \param name the name of a parameter of the sweep.
+   * \returns the value of the parameter for this point, as a number.
+   */
+  double GetParameterAsDouble (std::string name) const;
+  /**
+   * \brief Record the value of a metric of this replication.
+   *
+   * \param name the name of the metric, at most MAX_NAME - 1 characters.
+   * \param value the value of the metric.
+   *
+   * Recording the same metric twice overwrites the first value.
+   */
+  void Record (std::string name, double value);
+
+private:
+  friend class ReplicationRunner;
+  Replication (uint32_t point, uint32_t index, uint32_t run,
+               std::map<std::string, std::string> const &parameters, void *slot);
+
+  uint32_t m_point;
+  uint32_t m_index;
+  uint32_t m_run;
+  std::map<std::string, std::string> const &m_parameters;
+  void *m_slot;
+};
+
+/**
+ * \ingroup core
+ *
+ * \brief Run the replications of a parameter sweep in parallel worker
+ * processes.
+ *
+ * The sweep is the cartesian product of the values of its parameters,
+ * each point of which is run SetReplications times.  Each replication
+ * runs in its own process forked from the process which calls Run, so it
+ * does not pay for the start of a program, the loading of the libraries,
+ * the registration of the TypeIds nor for the work of the setup callback,
+ * which is run once before the first fork.  Since each replication starts
+ * from the same image and exits at its end, the replications cannot leak
+ * state (global values, default attribute values, node ids, random
+ * streams) into each other.
+ *
+ * Each replication of a point gets the run number FirstRun + index: the
+ * replications of a point are statistically independent and the points
+ * of the sweep are compared with common random numbers.  The parameters
+ * of the sweep whose name contains "::" are set with Config::SetDefault
+ * before the scenario callback is called.
+ *
+ * The replications are started in order, at most SetWorkers at a time,
+ * whenever a worker exits, so that the long replications do not leave the
+ * other cores idle.  The scenario records its metrics with
+ * Replication::Record in a slot of a shared memory area which the parent
+ * process aggregates when the replication exits.  A replication which
+ * crashes or exits with a non zero status is reported as failed and its
+ * metrics are ignored.
+ */
+class ReplicationRunner
+{
+public:
+  static const uint32_t MAX_METRICS = 32; /**< Metrics per replication */
+  static const uint32_t MAX_NAME = 48; /**< Size of the name of a metric */
+
+  /**
+   * \brief Summary of the values of a metric over the replications of a point.
+   */
+  struct Summary
+  {
+    uint32_t count;
+    double mean;
+    double stddev;
+    double min;
+    double max;
+    /// half width of the 95% confidence interval of the mean.
+    double ci95;
+  };
+
+  ReplicationRunner ();
+
+  /**
+   * \param name the name of the parameter.
+   * \param values the values of the parameter, one per point of its axis.
+   */
+  void AddParameter (std::string name, std::vector<std::string> const &values);
+  /**
+   * \param name the name of the parameter.
+   * \param values the values of the parameter, separated by commas.
+   */
+  void AddParameter (std::string name, std::string values);
+  /**
+   * \param n the number of replications of each point.
+   */
+  void SetReplications (uint32_t n);
+  /**
+   * \param run the run number of the first replication of each point.
+   */
+  void SetFirstRun (uint32_t run);
+  /**
+   * \param n the maximum number of workers, 0 for one per online core.
+   */
+  void SetWorkers (uint32_t n);
+  /**
+   * \param setup called once in the parent before the first replication.
+   */
+  void SetSetup (Callback<void> setup);
+  /**
+   * \param scenario called in the worker process to build and run the
+   *        simulation of a replication.
+   */
+  void SetScenario (Callback<void, Replication &> scenario);
+
+  /**
+   * \returns the number of points of the sweep.
+   */
+  uint32_t GetNPoints (void) const;
+  /**
+   * \param point the index of a point of the sweep.
+   * \returns the values of the parameters of the point.
+   */
+  std::map<std::string, std::string> GetPoint (uint32_t point) const;
+
+  /**
+   * \brief Run all the replications and aggregate their metrics.
+   *
+   * \returns the number of failed replications.
+   */
+  uint32_t Run (void);
+
+  /**
+   * \param point the index of a point of the sweep.
+   * \returns the names of the metrics recorded by the replications of the point.
+   */
+  std::vector<std::string> GetMetrics (uint32_t point) const;
+  /**
+   * \param point the index of a point of the sweep.
+   * \param metric the name of a metric.
+   * \returns the values of the metric, in the order of the replications.
+   */
+  std::vector<double> GetValues (uint32_t point, std::string metric) const;
+  /**
+   * \param point the index of a point of the sweep.
+   * \param metric the name of a metric.
+   * \returns the summary of the values of the metric.
+   */
+  struct Summary GetSummary (uint32_t point, std::string metric) const;
+  /**
+   * \returns the number of replications which failed in the last Run.
+   */
+  uint32_t GetFailed (void) const;
+  /**
+   * \brief Print one line per point and metric: the parameters, the
+   * metric and its summary, separated by spaces.
+   */
+  void Report (std::ostream &os) const;
+
+private:
+  typedef std::map<std::string, std::vector<double> > Metrics;
+
+  void RunReplication (uint32_t job, void *slot);
+  void Collect (uint32_t job, void *slot);
+
+  std::vector<std::pair<std::string, std::vector<std::string> > > m_parameters;
+  uint32_t m_replications;
+  uint32_t m_firstRun;
+  uint32_t m_workers;
+  Callback<void> m_setup;
+  Callback<void, Replication &> m_scenario;
+  std::vector<Metrics> m_results;
+  uint32_t m_failed;
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
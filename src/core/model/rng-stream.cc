@@ -304,20 +304,24 @@ bool RngStream::CheckSeed (const uint32_t seed[6])
 uint32_t
 RngStream::EnsureGlobalInitialized (void)
 {
-  static bool initialized = false;
-  static uint32_t run = 0;
-  if (!initialized)
+  if (!globalInitialized)
     {
-      initialized = true;
+      globalInitialized = true;
       uint32_t seed;
       IntegerValue value;
       g_rngSeed.GetValue (value);
       seed = value.Get ();
       g_rngRun.GetValue (value);
-      run = value.Get ();
+      globalRun = value.Get ();
       SetPackageSeed (seed);
     }
-  return run;
+  return globalRun;
+}
+
+void
+RngStream::ResetPackage (void)
+{
+  globalInitialized = false;
 }
 
 //*************************************************************************
@@ -333,6 +337,8 @@ double RngStream::nextSeed[6] =
 {
   12345.0, 12345.0, 12345.0, 12345.0, 12345.0, 12345.0
 };
+bool RngStream::globalInitialized = false;
+uint32_t RngStream::globalRun = 0;
 
 //-------------------------------------------------------------------------
 // constructor
@@ -60,6 +60,12 @@ public: //public static api
   static uint32_t GetPackageRun (void);
   static bool CheckSeed (const uint32_t seed[6]);
   static bool CheckSeed (uint32_t seed);
+  /**
+   * Forget the seed and run number read by the first stream: the next
+   * stream reads the RngSeed and RngRun global values again and starts
+   * the sequence of streams from the seed.
+   */
+  static void ResetPackage (void);
 private: //members
   double Cg[6], Bg[6], Ig[6];
   bool anti, incPrec;
@@ -68,6 +74,8 @@ private: //members
   static uint32_t EnsureGlobalInitialized (void);
 private: //static data
   static double nextSeed[6];
+  static bool globalInitialized;
+  static uint32_t globalRun;
 };
 
 } // namespace ns3
@@ -54,6 +54,12 @@ public:
    * \param cb the callback to connect to the target trace source.
    */
   virtual bool Connect (ObjectBase *obj, std::string context, const CallbackBase &cb) const = 0;
+  /**
+   * \param obj the object instance which contains the target trace source.
+   * \param context the integer context to bind to the user callback.
+   * \param cb the callback to connect to the target trace source.
+   */
+  virtual bool Connect (ObjectBase *obj, uint32_t context, const CallbackBase &cb) const = 0;
   /**
    * \param obj the object instance which contains the target trace source.
    * \param cb the callback to disconnect from the target trace source.
@@ -107,6 +113,15 @@ DoMakeTraceSourceAccessor (SOURCE T::*a)
       (p->*m_source).Connect (cb, context);
       return true;
     }
+    virtual bool Connect (ObjectBase *obj, uint32_t context, const CallbackBase &cb) const {
+      T *p = dynamic_cast<T*> (obj);
+      if (p == 0)
+        {
+          return false;
+        }
+      (p->*m_source).Connect (cb, context);
+      return true;
+    }
     virtual bool DisconnectWithoutContext (ObjectBase *obj, const CallbackBase &cb) const {
       T *p = dynamic_cast<T*> (obj);
       if (p == 0)
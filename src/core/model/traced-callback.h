@@ -61,6 +61,15 @@ public:
    * user's callback as its first argument. 
    */
   void Connect (const CallbackBase & callback, std::string path);
+  /**
+   * \param callback callback to add to chain of callbacks
+   * \param context an integer to send back to the user callback.
+   *
+   * Same as Connect, but the user callback receives an integer context
+   * (typically a node or device index) as its first argument instead of a
+   * path string, which avoids carrying a string around with each call.
+   */
+  void Connect (const CallbackBase & callback, uint32_t context);
   /**
    * \param callback callback to remove from the chain of callbacks.
    *
@@ -130,6 +139,18 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   m_callbackList.push_back (realCb);
 }
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback, uint32_t context)
+{
+  Callback<void,uint32_t,T1,T2,T3,T4,T5,T6,T7,T8> cb;
+  cb.Assign (callback);
+  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (context);
+  m_callbackList.push_back (realCb);
+}
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
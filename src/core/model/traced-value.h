@@ -81,6 +81,9 @@ public:
   void Connect (const CallbackBase &cb, std::string path) {
     m_cb.Connect (cb, path);
   }
+  void Connect (const CallbackBase &cb, uint32_t context) {
+    m_cb.Connect (cb, context);
+  }
   void DisconnectWithoutContext (const CallbackBase &cb) {
     m_cb.DisconnectWithoutContext (cb);
   }
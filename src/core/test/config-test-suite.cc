@@ -595,6 +595,102 @@ ObjectVectorTraceConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/1/Source", "Trace 1 did not provide expected context");
 }
 
+// ===========================================================================
+// Test for pre-resolved paths: integer contexts and incremental updates.
+// ===========================================================================
+class PathConfigTestCase : public TestCase
+{
+public:
+  PathConfigTestCase ();
+  virtual ~PathConfigTestCase () {}
+
+  void TraceWithIndex (uint32_t index, int16_t old, int16_t newValue) { m_newValue = newValue; m_index = index; }
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue) { m_newValue = newValue; m_path = path; }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue;
+  uint32_t m_index;
+  std::string m_path;
+};
+
+PathConfigTestCase::PathConfigTestCase ()
+  : TestCase ("Check Config::Path integer contexts and incremental updates")
+{
+}
+
+void
+PathConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+
+  //
+  // Two levels of vectors: root->NodesA[i]->NodesB[j].
+  //
+  std::vector<Ptr<ConfigTestObject> > leaves;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+      root->AddNodeA (a);
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+          a->AddNodeB (b);
+          leaves.push_back (b);
+        }
+    }
+
+  Config::Path first ("/NodesA/*/NodesB/*/Source");
+  Config::Path second ("/NodesA/*/NodesB/[1-1]/Source");
+  first.ConnectWithIndex (MakeCallback (&PathConfigTestCase::TraceWithIndex, this), 0);
+  NS_TEST_ASSERT_MSG_EQ (first.LookupMatches ().GetN (), 6, "Unexpected number of matches");
+
+  m_newValue = 0;
+  m_index = 100;
+  leaves[5]->SetAttribute ("Source", IntegerValue (-5));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -5, "Trace did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_index, 2, "Trace did not provide the index of the first level");
+
+  second.ConnectWithIndex (MakeCallback (&PathConfigTestCase::TraceWithIndex, this), 1);
+  m_index = 100;
+  leaves[3]->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_index, 1, "Trace did not provide the index of the second level");
+
+  second.Connect (MakeCallback (&PathConfigTestCase::TraceWithPath, this));
+  m_path = "";
+  leaves[1]->SetAttribute ("Source", IntegerValue (-11));
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodesA/0/NodesB/1/Source", "Trace did not provide expected context");
+
+  //
+  // Add a new branch: only it should be connected by Update, the existing
+  // objects must not get a second connection.
+  //
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+  a->AddNodeB (b);
+  root->AddNodeA (a);
+  NS_TEST_ASSERT_MSG_EQ (first.Update (), 1, "Update did not find exactly one new object");
+  NS_TEST_ASSERT_MSG_EQ (first.Update (), 0, "Second Update found new objects");
+  // held by the test and by its parent only, not by the connected path.
+  NS_TEST_ASSERT_MSG_EQ (b->GetReferenceCount (), 2, "Path kept a reference to a connected object");
+  m_newValue = 0;
+  m_index = 100;
+  b->SetAttribute ("Source", IntegerValue (-7));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -7, "Trace on the new object did not fire");
+  NS_TEST_ASSERT_MSG_EQ (m_index, 3, "Trace on the new object did not provide its index");
+
+  Config::Path ("/NodesA/[1-2]/NodesB/0/A").Set (IntegerValue (3));
+  IntegerValue iv;
+  leaves[2]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 3, "Path::Set did not set a matching attribute");
+  leaves[0]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Path::Set set an attribute which does not match");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -610,6 +706,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new RootNamespaceConfigTestCase);
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
+  AddTestCase (new PathConfigTestCase);
 }
 
 static ConfigTestSuite configTestSuite;
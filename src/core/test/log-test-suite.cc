@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+
+NS_LOG_COMPONENT_DEFINE_MASK ("LogTestSuite", ns3::LOG_LEVEL_WARN);
+
+namespace ns3 {
+
+class LogCompiledLevelsTestCase : public TestCase
+{
+public:
+  LogCompiledLevelsTestCase ();
+  virtual void DoRun (void);
+private:
+  uint32_t Evaluate (void);
+  uint32_t m_evaluated;
+};
+
+LogCompiledLevelsTestCase::LogCompiledLevelsTestCase ()
+  : TestCase ("Check that the log levels which are not compiled in are never evaluated"),
+    m_evaluated (0)
+{
+}
+
+uint32_t
+LogCompiledLevelsTestCase::Evaluate (void)
+{
+  return ++m_evaluated;
+}
+
+void
+LogCompiledLevelsTestCase::DoRun (void)
+{
+  std::ostringstream oss;
+  std::streambuf *clog = std::clog.rdbuf (oss.rdbuf ());
+  LogComponentEnable ("LogTestSuite", LOG_LEVEL_ALL);
+
+  NS_LOG_FUNCTION (Evaluate ());
+  NS_LOG_DEBUG (Evaluate ());
+  NS_LOG_LOGIC (Evaluate ());
+  NS_LOG_WARN (Evaluate ());
+  NS_LOG_ERROR (Evaluate ());
+
+  LogComponentDisable ("LogTestSuite", LOG_LEVEL_ALL);
+  NS_LOG_ERROR (Evaluate ());
+  std::clog.rdbuf (clog);
+
+  uint32_t expected = 0;
+#ifdef NS3_LOG_ENABLE
+  expected += (NS3_LOG_LEVELS & LOG_WARN) != 0;
+  expected += (NS3_LOG_LEVELS & LOG_ERROR) != 0;
+#endif /* NS3_LOG_ENABLE */
+  NS_TEST_ASSERT_MSG_EQ (m_evaluated, expected, "Unexpected number of evaluated log messages");
+  NS_TEST_ASSERT_MSG_EQ ((oss.str ().find ("LogTestSuite") == std::string::npos), true,
+                         "The function of a component without LOG_FUNCTION was logged");
+}
+
+// Decode a log recorder file.
+static std::string
+DecodeRecorderFile (std::string fileName)
+{
+  std::ifstream is (fileName.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream os;
+  if (!LogRecorder::Decode (is, os))
+    {
+      os << "<decode error>";
+    }
+  return os.str ();
+}
+
+class LogRecorderTestCase : public TestCase
+{
+public:
+  LogRecorderTestCase ();
+  virtual void DoRun (void);
+};
+
+LogRecorderTestCase::LogRecorderTestCase ()
+  : TestCase ("Check that the log recorder keeps the values of the log messages")
+{
+}
+
+void
+LogRecorderTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("log-recorder.bin");
+  LogRecorder::Enable (fileName);
+  LogComponentEnable ("LogTestSuite", LOG_LEVEL_ALL);
+  NS_LOG_WARN ("x=" << 42 << " y=" << 1.5 << " s=" << std::string ("abc") << " c=" << 'z'
+                    << " u=" << static_cast<uint64_t> (7) << " b=" << true);
+  NS_LOG_ERROR ("negative " << -3);
+  uint32_t site = LogRecorder::RegisterSite ("LogTestSuite", "Function", __FILE__, __LINE__, LOG_FUNCTION);
+  {
+    LogRecord record (site);
+    record << 1 << "a";
+  }
+  LogComponentDisable ("LogTestSuite", LOG_LEVEL_ALL);
+  LogRecorder::Disable ();
+
+  std::string text = DecodeRecorderFile (fileName);
+  remove (fileName.c_str ());
+  NS_TEST_ASSERT_MSG_NE (text.find ("LogTestSuite:DoRun(): x=42 y=1.5 s=abc c=z u=7 b=1\n"), std::string::npos,
+                         "Missing message in " << text);
+  NS_TEST_ASSERT_MSG_NE (text.find ("LogTestSuite:DoRun(): negative -3\n"), std::string::npos,
+                         "Missing message in " << text);
+  NS_TEST_ASSERT_MSG_NE (text.find ("LogTestSuite:Function(1, a)\n"), std::string::npos,
+                         "Missing function message in " << text);
+}
+
+class LogFlightRecorderTestCase : public TestCase
+{
+public:
+  LogFlightRecorderTestCase ();
+  virtual void DoRun (void);
+private:
+  void Event (uint32_t i);
+};
+
+LogFlightRecorderTestCase::LogFlightRecorderTestCase ()
+  : TestCase ("Check that the flight recorder dumps the last messages only")
+{
+}
+
+void
+LogFlightRecorderTestCase::Event (uint32_t i)
+{
+  NS_LOG_WARN ("event " << i);
+}
+
+void
+LogFlightRecorderTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("log-flight-recorder.bin");
+  LogRecorder::EnableFlightRecorder (fileName, Seconds (3.0), 4096);
+  LogComponentEnable ("LogTestSuite", LOG_LEVEL_ALL);
+  // more than the ring buffer holds.
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      NS_LOG_WARN ("early " << i);
+    }
+  NS_TEST_ASSERT_MSG_GT (LogRecorder::GetDroppedRecords (), 0, "The ring buffer never wrapped around");
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      Simulator::Schedule (Seconds (i), &LogFlightRecorderTestCase::Event, this, i);
+    }
+  Simulator::Schedule (Seconds (10.5), &LogRecorder::Dump);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  LogComponentDisable ("LogTestSuite", LOG_LEVEL_ALL);
+  LogRecorder::Disable ();
+
+  std::string text = DecodeRecorderFile (fileName);
+  remove (fileName.c_str ());
+  NS_TEST_ASSERT_MSG_NE (text.find ("# dump at 10.5s\n"), std::string::npos, "Missing dump in " << text);
+  NS_TEST_ASSERT_MSG_EQ (text.find ("early"), std::string::npos, "Message older than the window in " << text);
+  NS_TEST_ASSERT_MSG_EQ (text.find ("event 7\n"), std::string::npos, "Message older than the window in " << text);
+  for (uint32_t i = 8; i <= 10; i++)
+    {
+      std::ostringstream oss;
+      oss << i << "s -1 LogTestSuite:Event(): event " << i << "\n";
+      NS_TEST_ASSERT_MSG_NE (text.find (oss.str ()), std::string::npos, "Missing " << oss.str () << " in " << text);
+    }
+}
+
+class LogCrashRecorderTestCase : public TestCase
+{
+public:
+  LogCrashRecorderTestCase ();
+  virtual void DoRun (void);
+private:
+  static void Event (uint32_t i);
+  static void Crash (void);
+};
+
+LogCrashRecorderTestCase::LogCrashRecorderTestCase ()
+  : TestCase ("Check that the flight recorder dumps the last messages on a crash")
+{
+}
+
+void
+LogCrashRecorderTestCase::Event (uint32_t i)
+{
+  NS_LOG_WARN ("event " << i);
+}
+
+void
+LogCrashRecorderTestCase::Crash (void)
+{
+  raise (SIGSEGV);
+}
+
+void
+LogCrashRecorderTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("log-crash-recorder.bin");
+  // the simulation crashes in a child process.
+  pid_t pid = fork ();
+  NS_TEST_ASSERT_MSG_NE (pid, -1, "fork failed");
+  if (pid == 0)
+    {
+      LogRecorder::EnableFlightRecorder (fileName, Seconds (3.0), 4096);
+      LogComponentEnable ("LogTestSuite", LOG_LEVEL_ALL);
+      for (uint32_t i = 1; i <= 10; i++)
+        {
+          Simulator::Schedule (Seconds (i), &LogCrashRecorderTestCase::Event, i);
+        }
+      Simulator::Schedule (Seconds (10.5), &LogCrashRecorderTestCase::Crash);
+      Simulator::Run ();
+      _exit (0);
+    }
+  int status;
+  waitpid (pid, &status, 0);
+  NS_TEST_ASSERT_MSG_EQ ((WIFSIGNALED (status) && WTERMSIG (status) == SIGSEGV), true,
+                         "The simulation did not crash");
+
+  std::string text = DecodeRecorderFile (fileName);
+  remove (fileName.c_str ());
+  // the window ends at the latest message.
+  NS_TEST_ASSERT_MSG_NE (text.find ("# dump at 10s\n"), std::string::npos, "Missing dump in " << text);
+  NS_TEST_ASSERT_MSG_EQ (text.find ("event 6\n"), std::string::npos, "Message older than the window in " << text);
+  for (uint32_t i = 7; i <= 10; i++)
+    {
+      std::ostringstream oss;
+      oss << i << "s -1 LogTestSuite:Event(): event " << i << "\n";
+      NS_TEST_ASSERT_MSG_NE (text.find (oss.str ()), std::string::npos, "Missing " << oss.str () << " in " << text);
+    }
+}
+
+class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ();
+};
+
+LogTestSuite::LogTestSuite ()
+  : TestSuite ("log", UNIT)
+{
+  AddTestCase (new LogCompiledLevelsTestCase ());
+#ifdef NS3_LOG_ENABLE
+  if ((NS3_LOG_LEVELS & LOG_LEVEL_WARN) == LOG_LEVEL_WARN)
+    {
+      AddTestCase (new LogRecorderTestCase ());
+      AddTestCase (new LogFlightRecorderTestCase ());
+      AddTestCase (new LogCrashRecorderTestCase ());
+    }
+#endif /* NS3_LOG_ENABLE */
+}
+
+static LogTestSuite g_logTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/replication-runner.h"
+#include "ns3/random-variable.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+#include <cstdlib>
+
+namespace ns3 {
+
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  ReplicationRunnerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Setup (void);
+  void Scenario (Replication &replication);
+  void Event (void);
+
+  // set in the parent, seen by the workers.
+  bool m_setup;
+  uint32_t m_events;
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Check the points, run numbers and metrics of a sweep"),
+    m_setup (false),
+    m_events (0)
+{
+}
+
+void
+ReplicationRunnerTestCase::Setup (void)
+{
+  m_setup = true;
+}
+
+void
+ReplicationRunnerTestCase::Event (void)
+{
+  m_events++;
+}
+
+void
+ReplicationRunnerTestCase::Scenario (Replication &replication)
+{
+  if (replication.GetParameter ("crash") == "yes")
+    {
+      std::abort ();
+    }
+  uint32_t n = replication.GetParameterAsDouble ("events");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (Seconds (i), &ReplicationRunnerTestCase::Event, this);
+    }
+  Simulator::Run ();
+  UniformVariable uniform;
+  replication.Record ("setup", m_setup);
+  replication.Record ("events", m_events);
+  replication.Record ("run", replication.GetRun ());
+  replication.Record ("uniform", uniform.GetValue ());
+}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  ReplicationRunner runner;
+  runner.AddParameter ("crash", "no,yes");
+  runner.AddParameter ("events", "1,2,3");
+  runner.SetReplications (4);
+  runner.SetFirstRun (5);
+  runner.SetWorkers (3);
+  runner.SetSetup (MakeCallback (&ReplicationRunnerTestCase::Setup, this));
+  runner.SetScenario (MakeCallback (&ReplicationRunnerTestCase::Scenario, this));
+
+  NS_TEST_ASSERT_MSG_EQ (runner.GetNPoints (), 6, "Wrong number of points");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetPoint (1)["crash"], "no", "Wrong order of the points");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetPoint (1)["events"], "2", "Wrong order of the points");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetPoint (3)["crash"], "yes", "Wrong order of the points");
+
+  uint32_t failed = runner.Run ();
+  NS_TEST_ASSERT_MSG_EQ (failed, 12, "The crashing replications did not fail");
+  NS_TEST_ASSERT_MSG_EQ (m_events, 0, "A replication ran in the parent process");
+
+  std::vector<double> first = runner.GetValues (0, "uniform");
+  NS_TEST_ASSERT_MSG_EQ (first.size (), 4, "Missing replications");
+  for (uint32_t point = 0; point < 3; point++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (runner.GetSummary (point, "setup").mean, 1, "The setup did not run before the fork");
+      NS_TEST_ASSERT_MSG_EQ (runner.GetSummary (point, "events").mean, point + 1, "The state leaked between replications");
+      std::vector<double> runs = runner.GetValues (point, "run");
+      std::vector<double> uniform = runner.GetValues (point, "uniform");
+      NS_TEST_ASSERT_MSG_EQ (runs.size (), 4, "Missing replications");
+      for (uint32_t i = 0; i < runs.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (runs[i], 5 + i, "Wrong run number");
+          // common random numbers across the points
+          NS_TEST_ASSERT_MSG_EQ (uniform[i], first[i], "Different streams for the same run");
+          for (uint32_t j = 0; j < i; j++)
+            {
+              NS_TEST_ASSERT_MSG_NE (uniform[i], uniform[j], "Same stream for different runs");
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (runner.GetSummary (3, "uniform").count, 0, "Metrics of a failed replication");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetSummary (0, "run").mean, 6.5, "Wrong mean");
+}
+
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  ReplicationRunnerTestSuite ();
+};
+
+ReplicationRunnerTestSuite::ReplicationRunnerTestSuite ()
+  : TestSuite ("replication-runner", UNIT)
+{
+  AddTestCase (new ReplicationRunnerTestCase);
+}
+
+static ReplicationRunnerTestSuite replicationRunnerTestSuite;
+
+} // namespace ns3
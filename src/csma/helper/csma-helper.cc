@@ -211,6 +211,28 @@ CsmaHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void
+CsmaHelper::EnableBinaryInternal (Ptr<BinaryTraceSink> sink, Ptr<NetDevice> nd)
+{
+  Ptr<CsmaNetDevice> device = nd->GetObject<CsmaNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("CsmaHelper::EnableBinaryInternal(): Device " << device << " not of type ns3::CsmaNetDevice");
+      return;
+    }
+
+  //
+  // Same events as the ascii traces: "r" from MacRx, and "+", "-" and "d"
+  // from the transmit queue.
+  //
+  device->TraceConnectWithoutContext ("MacRx", MakeCallback (&BinaryTraceSink::Receive, sink));
+
+  Ptr<Queue> queue = device->GetQueue ();
+  queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&BinaryTraceSink::Enqueue, sink));
+  queue->TraceConnectWithoutContext ("Drop", MakeCallback (&BinaryTraceSink::Drop, sink));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&BinaryTraceSink::Dequeue, sink));
+}
+
 NetDeviceContainer
 CsmaHelper::Install (Ptr<Node> node) const
 {
@@ -50,8 +50,9 @@ BasicEnergySource::GetTypeId (void)
                                        &BasicEnergySource::GetSupplyVoltage),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("PeriodicEnergyUpdateInterval",
-                   "Time between two consecutive periodic energy updates.",
-                   TimeValue (Seconds (1.0)),
+                   "Time between two consecutive periodic updates of the RemainingEnergy trace, "
+                   "or zero for updates only when the current draw changes.",
+                   TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&BasicEnergySource::SetEnergyUpdateInterval,
                                      &BasicEnergySource::GetEnergyUpdateInterval),
                    MakeTimeChecker ())
@@ -65,6 +66,7 @@ BasicEnergySource::GetTypeId (void)
 BasicEnergySource::BasicEnergySource ()
 {
   m_lastUpdateTime = Seconds (0.0);
+  m_depleted = false;
 }
 
 BasicEnergySource::~BasicEnergySource ()
@@ -78,6 +80,7 @@ BasicEnergySource::SetInitialEnergy (double initialEnergyJ)
   NS_ASSERT (initialEnergyJ >= 0);
   m_initialEnergyJ = initialEnergyJ;
   m_remainingEnergyJ = m_initialEnergyJ;
+  m_depleted = false;
 }
 
 void
@@ -136,27 +139,46 @@ BasicEnergySource::UpdateEnergySource (void)
   NS_LOG_FUNCTION (this);
   NS_LOG_DEBUG ("BasicEnergySource:Updating remaining energy.");
 
-  // do not update if simulation has finished
-  if (Simulator::IsFinished ())
+  /*
+   * Do not update once the simulation has been destroyed. The simulation is
+   * not checked for being finished: the depletion event may be the only
+   * event left after the current draw changed in the last one.
+   */
+  if (Simulator::Now () < m_lastUpdateTime)
     {
       return;
     }
 
-  m_energyUpdateEvent.Cancel ();
-
   CalculateRemainingEnergy ();
+  m_lastUpdateTime = Simulator::Now ();
 
+  /*
+   * The depletion is predicted by ScheduleDepletion when the current draw
+   * changes, so that it is not rescheduled here; the remaining energy only
+   * reaches zero here through the rounding of the predicted time.
+   */
   if (m_remainingEnergyJ <= 0)
     {
+      m_energyUpdateEvent.Cancel ();  // stop periodic update
+      Simulator::Remove (m_depletionEvent);
       HandleEnergyDrainedEvent ();
-      return; // stop periodic update
     }
+}
 
-  m_lastUpdateTime = Simulator::Now ();
+void
+BasicEnergySource::NotifyCurrentChanged (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // do not update if the simulation was destroyed or the source is depleted
+  if (Simulator::Now () < m_lastUpdateTime || m_remainingEnergyJ <= 0)
+    {
+      return;
+    }
 
-  m_energyUpdateEvent = Simulator::Schedule (m_energyUpdateInterval,
-                                             &BasicEnergySource::UpdateEnergySource,
-                                             this);
+  // the device model called UpdateEnergySource before its change.
+  NS_ASSERT (m_lastUpdateTime == Simulator::Now ());
+  ScheduleDepletion ();
 }
 
 /*
@@ -167,13 +189,26 @@ void
 BasicEnergySource::DoStart (void)
 {
   NS_LOG_FUNCTION (this);
-  UpdateEnergySource ();  // start periodic update
+  UpdateEnergySource ();
+  if (m_remainingEnergyJ <= 0)
+    {
+      return;
+    }
+  ScheduleDepletion ();
+  if (!m_energyUpdateInterval.IsZero ())
+    {
+      m_energyUpdateEvent = Simulator::Schedule (m_energyUpdateInterval,
+                                                 &BasicEnergySource::HandleEnergyUpdateEvent,
+                                                 this);
+    }
 }
 
 void
 BasicEnergySource::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_energyUpdateEvent.Cancel ();
+  Simulator::Remove (m_depletionEvent);
   BreakDeviceEnergyModelRefCycle ();  // break reference cycle
 }
 
@@ -181,9 +216,57 @@ void
 BasicEnergySource::HandleEnergyDrainedEvent (void)
 {
   NS_LOG_FUNCTION (this);
+  m_remainingEnergyJ = 0; // energy never goes below 0
+  if (m_depleted)
+    {
+      return; // notify the depletion once
+    }
   NS_LOG_DEBUG ("BasicEnergySource:Energy depleted!");
+  m_depleted = true;
   NotifyEnergyDrained (); // notify DeviceEnergyModel objects
-  m_remainingEnergyJ = 0; // energy never goes below 0
+}
+
+void
+BasicEnergySource::ScheduleDepletion (void)
+{
+  NS_LOG_FUNCTION (this);
+  /*
+   * The predicted event is removed rather than cancelled: it may lie far
+   * ahead and would otherwise stay in the event list after every change of
+   * the current draw.
+   */
+  Simulator::Remove (m_depletionEvent);
+  double powerW = CalculateTotalCurrent () * m_supplyVoltageV;
+  if (powerW > 0)
+    {
+      Time delay = Seconds (m_remainingEnergyJ / powerW);
+      NS_LOG_DEBUG ("BasicEnergySource:Energy depleted in " << delay.GetSeconds () << "s");
+      m_depletionEvent = Simulator::Schedule (delay, &BasicEnergySource::HandleDepletionEvent, this);
+    }
+}
+
+void
+BasicEnergySource::HandleEnergyUpdateEvent (void)
+{
+  NS_LOG_FUNCTION (this);
+  UpdateEnergySource ();
+  if (m_remainingEnergyJ > 0)
+    {
+      m_energyUpdateEvent = Simulator::Schedule (m_energyUpdateInterval,
+                                                 &BasicEnergySource::HandleEnergyUpdateEvent,
+                                                 this);
+    }
+}
+
+void
+BasicEnergySource::HandleDepletionEvent (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_energyUpdateEvent.Cancel ();
+  // ignore the rounding of the predicted time.
+  CalculateRemainingEnergy ();
+  m_lastUpdateTime = Simulator::Now ();
+  HandleEnergyDrainedEvent ();
 }
 
 void
@@ -74,6 +74,13 @@ public:
    */
   virtual void UpdateEnergySource (void);
 
+  /**
+   * Implements NotifyCurrentChanged.
+   *
+   * Reschedules the depletion of the source for the new total current.
+   */
+  virtual void NotifyCurrentChanged (void);
+
   /**
    * \param initialEnergyJ Initial energy, in Joules
    *
@@ -93,7 +100,11 @@ public:
   /**
    * \param interval Energy update interval.
    *
-   * This function sets the interval between each energy update.
+   * This function sets the interval between each periodic energy update. The
+   * remaining energy is computed at every change of the current draw and
+   * whenever it is read, and the depletion of the source is scheduled at the
+   * time predicted from the current draw: the periodic updates only refresh
+   * the RemainingEnergy trace. A zero interval disables them.
    */
   void SetEnergyUpdateInterval (Time interval);
 
@@ -114,9 +125,29 @@ private:
    * Handles the remaining energy going to zero event. This function notifies
    * all the energy models aggregated to the node about the energy being
    * depleted. Each energy model is then responsible for its own handler.
+   * The models are notified once, until the initial energy is set again.
    */
   void HandleEnergyDrainedEvent (void);
 
+  /**
+   * Schedules the depletion of the remaining energy at the total current of
+   * the device models, replacing the former prediction. The source is not
+   * depleted while the total current is zero.
+   */
+  void ScheduleDepletion (void);
+
+  /**
+   * Updates the remaining energy every energy update interval, until the
+   * source is depleted.
+   */
+  void HandleEnergyUpdateEvent (void);
+
+  /**
+   * Handles the predicted depletion: the current draw did not change since
+   * the prediction, hence the remaining energy is drained.
+   */
+  void HandleDepletionEvent (void);
+
   /**
    * Calculates remaining energy. This function uses the total current from all
    * device models to calculate the amount of energy to decrease. The energy to
@@ -132,6 +163,8 @@ private:
   double m_supplyVoltageV;                // supply voltage, in Volts
   TracedValue<double> m_remainingEnergyJ; // remaining energy, in Joules
   EventId m_energyUpdateEvent;            // energy update event
+  EventId m_depletionEvent;               // predicted depletion event
+  bool m_depleted;                        // depletion notified
   Time m_lastUpdateTime;                  // last update time
   Time m_energyUpdateInterval;            // energy update interval
 
@@ -57,6 +57,12 @@ EnergySource::GetNode (void) const
   return m_node;
 }
 
+void
+EnergySource::NotifyCurrentChanged (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 void
 EnergySource::AppendDeviceEnergyModel (Ptr<DeviceEnergyModel> deviceEnergyModelPtr)
 {
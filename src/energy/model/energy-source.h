@@ -110,6 +110,15 @@ public:
    */
   virtual void UpdateEnergySource (void) = 0;
 
+  /**
+   * Called by DeviceEnergyModels after their current draw changed, the energy
+   * drawn at the former current having been accounted for by a call to
+   * UpdateEnergySource just before the change. Sources which predict the time
+   * of their depletion recompute it here. The default implementation does
+   * nothing.
+   */
+  virtual void NotifyCurrentChanged (void);
+
   /**
    * \brief Sets pointer to node containing this EnergySource.
    *
@@ -75,6 +75,7 @@ SimpleDeviceEnergyModel::SetCurrentA (double current)
   m_source->UpdateEnergySource ();
   // update the current drain
   m_actualCurrentA = current;
+  m_source->NotifyCurrentChanged ();
 }
 
 void
@@ -20,6 +20,7 @@
 
 #include "ns3/basic-energy-source.h"
 #include "ns3/wifi-radio-energy-model.h"
+#include "ns3/simple-device-energy-model.h"
 #include "ns3/basic-energy-source-helper.h"
 #include "ns3/wifi-radio-energy-model-helper.h"
 #include "ns3/energy-source-container.h"
@@ -33,7 +34,6 @@
 #include "ns3/string.h"
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/nqos-wifi-mac-helper.h"
-#include <math.h>
 
 using namespace ns3;
 
@@ -150,15 +150,6 @@ BasicEnergyUpdateTest::StateSwitchTest (WifiPhy::State state)
   double voltage = source->GetSupplyVoltage ();
   estRemainingEnergy -= devModel->GetIdleCurrentA () * voltage * m_timeS;
 
-  /*
-   * Manually calculate the number of periodic updates performed by the source.
-   * This is to check if the periodic updates are performed correctly.
-   */
-  double actualTime = m_timeS;
-  actualTime /= source->GetEnergyUpdateInterval ().GetSeconds ();
-  actualTime = floor (actualTime); // rounding for update interval
-  actualTime *= source->GetEnergyUpdateInterval ().GetSeconds ();
-
   // calculate new state power consumption
   double current = 0.0;
   switch (state)
@@ -182,7 +173,8 @@ BasicEnergyUpdateTest::StateSwitchTest (WifiPhy::State state)
       NS_FATAL_ERROR ("Undefined radio state: " << state);
       break;
     }
-  estRemainingEnergy -= current * voltage * m_timeS;
+  // the source accounts for the energy drawn until the end of the simulation
+  estRemainingEnergy -= current * voltage * (m_timeS + timeDelta);
 
   // obtain remaining energy from source
   double remainingEnergy = source->GetRemainingEnergy ();
@@ -366,6 +358,82 @@ BasicEnergyDepletionTest::DepletionTestCase (double simTimeS,
 
 // -------------------------------------------------------------------------- //
 
+/**
+ * Test case of the depletion time predicted by BasicEnergySource when the
+ * current draw of a SimpleDeviceEnergyModel changes.
+ */
+class BasicEnergyDepletionTimeTest : public TestCase
+{
+public:
+  BasicEnergyDepletionTimeTest ();
+  virtual ~BasicEnergyDepletionTimeTest ();
+
+private:
+  void DoRun (void);
+
+  /**
+   * Records the time at which the remaining energy reaches zero.
+   */
+  void RemainingEnergyChanged (double oldValue, double newValue);
+
+private:
+  Time m_depletionTime;   // time at which the energy was depleted
+  int m_depletionCount;   // number of times the energy was depleted
+};
+
+BasicEnergyDepletionTimeTest::BasicEnergyDepletionTimeTest ()
+  : TestCase ("Basic energy source depletion time test case")
+{
+}
+
+BasicEnergyDepletionTimeTest::~BasicEnergyDepletionTimeTest ()
+{
+}
+
+void
+BasicEnergyDepletionTimeTest::RemainingEnergyChanged (double oldValue, double newValue)
+{
+  if (oldValue > 0 && newValue <= 0)
+    {
+      m_depletionTime = Simulator::Now ();
+      m_depletionCount++;
+    }
+}
+
+void
+BasicEnergyDepletionTimeTest::DoRun (void)
+{
+  m_depletionCount = 0;
+  Ptr<BasicEnergySource> source = CreateObject<BasicEnergySource> ();
+  source->SetInitialEnergy (10.0);
+  source->SetSupplyVoltage (2.0);
+  source->TraceConnectWithoutContext ("RemainingEnergy",
+                                      MakeCallback (&BasicEnergyDepletionTimeTest::RemainingEnergyChanged, this));
+  Ptr<SimpleDeviceEnergyModel> model = CreateObject<SimpleDeviceEnergyModel> ();
+  model->SetEnergySource (source);
+  source->AppendDeviceEnergyModel (model);
+
+  /*
+   * 2 J drawn in the first second, 2 J in the next two seconds, none in the
+   * fourth and the remaining 6 J at 4 W: the energy is depleted at 5.5 s.
+   * Each change of the current draw reschedules the depletion, which is
+   * the last event of the simulation.
+   */
+  Simulator::Schedule (Seconds (0), &SimpleDeviceEnergyModel::SetCurrentA, model, 1.0);
+  Simulator::Schedule (Seconds (1), &SimpleDeviceEnergyModel::SetCurrentA, model, 0.5);
+  Simulator::Schedule (Seconds (3), &SimpleDeviceEnergyModel::SetCurrentA, model, 0.0);
+  Simulator::Schedule (Seconds (4), &SimpleDeviceEnergyModel::SetCurrentA, model, 2.0);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_depletionCount, 1, "Energy not depleted once");
+  NS_TEST_EXPECT_MSG_EQ (m_depletionTime, Seconds (5.5), "Energy depleted at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (5.5), "Events left after the depletion");
+  NS_TEST_EXPECT_MSG_EQ (source->GetRemainingEnergy (), 0.0, "Energy left after the depletion");
+  Simulator::Destroy ();
+}
+
+// -------------------------------------------------------------------------- //
+
 /**
  * Unit test suite for energy model. Although the test suite involves 2 modules
  * it is still considered a unit test. Because a DeviceEnergyModel cannot live
@@ -382,6 +450,7 @@ BasicEnergyModelTestSuite::BasicEnergyModelTestSuite ()
 {
   AddTestCase (new BasicEnergyUpdateTest);
   AddTestCase (new BasicEnergyDepletionTest);
+  AddTestCase (new BasicEnergyDepletionTimeTest);
 }
 
 // create an instance of the test suite
@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include <fstream>
 #include <sstream>
 
@@ -29,6 +30,9 @@
 
 #define PERIODIC_CHECK_INTERVAL (Seconds (1))
 
+// flows with a smaller id have their statistics indexed by a vector
+#define MAX_INDEXED_FLOW_ID 65536
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("FlowMonitor");
@@ -71,6 +75,21 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (0.5)),
                    MakeTimeAccessor (&FlowMonitor::m_flowInterruptionsMinTime),
                    MakeTimeChecker ())
+    .AddAttribute ("HistogramBinsPerOctave", ("When non zero, the histograms use this number of log-scale bins "
+                                              "per power of two above their bin width, instead of linear bins."),
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlowMonitor::m_binsPerOctave),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HistogramOctaves", ("The number of powers of two above the bin width covered by "
+                                        "log-scale histograms; larger values go to an overflow bin."),
+                   UintegerValue (24),
+                   MakeUintegerAccessor (&FlowMonitor::m_histogramOctaves),
+                   MakeUintegerChecker<uint32_t> (1, 64))
+    .AddAttribute ("PacketSampling", ("Monitor only one in every N packets of each flow, selected by packet id.  "
+                                      "All the statistics then refer to the sampled packets only."),
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&FlowMonitor::m_packetSampling),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -81,8 +100,132 @@ FlowMonitor::GetInstanceTypeId (void) const
   return GetTypeId ();
 }
 
+FlowMonitor::TrackedPacketTable::TrackedPacketTable ()
+  : m_entries (64),
+    m_mask (63),
+    m_size (0)
+{
+}
+
+inline uint32_t
+FlowMonitor::TrackedPacketTable::Home (FlowId flowId, FlowPacketId packetId) const
+{
+  uint64_t key = ((uint64_t)flowId << 32) | packetId;
+  return (uint32_t)((key * 0x9e3779b97f4a7c15ULL) >> 32) & m_mask;
+}
+
+inline uint32_t
+FlowMonitor::TrackedPacketTable::Find (FlowId flowId, FlowPacketId packetId) const
+{
+  for (uint32_t i = Home (flowId, packetId); m_entries[i].used; i = (i + 1) & m_mask)
+    {
+      if (m_entries[i].flowId == flowId && m_entries[i].packetId == packetId)
+        {
+          return i;
+        }
+    }
+  return NOT_FOUND;
+}
+
+uint32_t
+FlowMonitor::TrackedPacketTable::Insert (FlowId flowId, FlowPacketId packetId)
+{
+  if (2 * (m_size + 1) > m_entries.size ())
+    {
+      Grow ();
+    }
+  uint32_t i = Home (flowId, packetId);
+  while (m_entries[i].used)
+    {
+      if (m_entries[i].flowId == flowId && m_entries[i].packetId == packetId)
+        {
+          return i;
+        }
+      i = (i + 1) & m_mask;
+    }
+  m_entries[i].flowId = flowId;
+  m_entries[i].packetId = packetId;
+  m_entries[i].used = true;
+  m_size++;
+  return i;
+}
+
+void
+FlowMonitor::TrackedPacketTable::Erase (uint32_t index)
+{
+  NS_ASSERT (m_entries[index].used);
+  // move back the entries of the same probe sequence which would not be
+  // found anymore once this slot is empty
+  uint32_t hole = index;
+  for (uint32_t i = (hole + 1) & m_mask; m_entries[i].used; i = (i + 1) & m_mask)
+    {
+      uint32_t home = Home (m_entries[i].flowId, m_entries[i].packetId);
+      bool reachable = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+      if (!reachable)
+        {
+          m_entries[hole] = m_entries[i];
+          hole = i;
+        }
+    }
+  m_entries[hole].used = false;
+  m_size--;
+}
+
+void
+FlowMonitor::TrackedPacketTable::Grow (void)
+{
+  std::vector<Entry> old (m_entries.size () * 2);
+  old.swap (m_entries);
+  m_mask = m_entries.size () - 1;
+  for (std::vector<Entry>::const_iterator i = old.begin (); i != old.end (); ++i)
+    {
+      if (i->used)
+        {
+          uint32_t j = Home (i->flowId, i->packetId);
+          while (m_entries[j].used)
+            {
+              j = (j + 1) & m_mask;
+            }
+          m_entries[j] = *i;
+        }
+    }
+}
+
+inline FlowMonitor::TrackedPacket &
+FlowMonitor::TrackedPacketTable::Get (uint32_t index)
+{
+  return m_entries[index].packet;
+}
+
+inline FlowId
+FlowMonitor::TrackedPacketTable::GetFlowId (uint32_t index) const
+{
+  return m_entries[index].flowId;
+}
+
+uint32_t
+FlowMonitor::TrackedPacketTable::GetSize (void) const
+{
+  return m_size;
+}
+
+uint32_t
+FlowMonitor::TrackedPacketTable::GetCapacity (void) const
+{
+  return m_entries.size ();
+}
+
+bool
+FlowMonitor::TrackedPacketTable::IsUsed (uint32_t index) const
+{
+  return m_entries[index].used;
+}
+
+
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_wheel (16),
+    m_wheelNext (0),
+    m_enabled (false)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
 }
@@ -91,6 +234,10 @@ FlowMonitor::FlowMonitor ()
 inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow (FlowId flowId)
 {
+  if (flowId < m_flowStatsIndex.size () && m_flowStatsIndex[flowId] != 0)
+    {
+      return *m_flowStatsIndex[flowId];
+    }
   std::map<FlowId, FlowStats>::iterator iter;
   iter = m_flowStats.find (flowId);
   if (iter == m_flowStats.end ())
@@ -109,6 +256,21 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
       ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
       ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
       ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
+      if (m_binsPerOctave != 0)
+        {
+          ref.delayHistogram.SetLogScale (m_binsPerOctave, m_histogramOctaves);
+          ref.jitterHistogram.SetLogScale (m_binsPerOctave, m_histogramOctaves);
+          ref.packetSizeHistogram.SetLogScale (m_binsPerOctave, m_histogramOctaves);
+          ref.flowInterruptionsHistogram.SetLogScale (m_binsPerOctave, m_histogramOctaves);
+        }
+      if (flowId < MAX_INDEXED_FLOW_ID)
+        {
+          if (flowId >= m_flowStatsIndex.size ())
+            {
+              m_flowStatsIndex.resize (flowId + 1, 0);
+            }
+          m_flowStatsIndex[flowId] = &ref;
+        }
       return ref;
     }
   else
@@ -117,6 +279,37 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
     }
 }
 
+inline int64_t
+FlowMonitor::GetWheelInterval (const Time &time) const
+{
+  return time.GetTimeStep () / PERIODIC_CHECK_INTERVAL.GetTimeStep ();
+}
+
+void
+FlowMonitor::WheelInsert (int64_t interval, FlowId flowId, FlowPacketId packetId)
+{
+  if (interval < m_wheelNext)
+    {
+      interval = m_wheelNext;
+    }
+  if (interval - m_wheelNext >= (int64_t)m_wheel.size ())
+    {
+      // the wheel must hold every interval from m_wheelNext on
+      uint64_t size = m_wheel.size ();
+      while (interval - m_wheelNext >= (int64_t)size)
+        {
+          size *= 2;
+        }
+      std::vector<WheelBucket> wheel (size);
+      for (int64_t i = m_wheelNext; i < m_wheelNext + (int64_t)m_wheel.size (); i++)
+        {
+          wheel[i & (size - 1)].swap (m_wheel[i & (m_wheel.size () - 1)]);
+        }
+      m_wheel.swap (wheel);
+    }
+  m_wheel[interval & (m_wheel.size () - 1)].push_back (std::make_pair (flowId, packetId));
+}
+
 
 void
 FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetId, uint32_t packetSize)
@@ -125,13 +318,19 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
     {
       return;
     }
+  if (packetId % m_packetSampling != 0)
+    {
+      return;
+    }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  uint32_t index = m_trackedPackets.Insert (flowId, packetId);
+  TrackedPacket &tracked = m_trackedPackets.Get (index);
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
   NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
                                                                 << ").");
+  WheelInsert (GetWheelInterval (now), flowId, packetId);
 
   probe->AddPacketStats (flowId, packetSize, Seconds (0));
 
@@ -153,19 +352,25 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
-  if (tracked == m_trackedPackets.end ())
+  if (packetId % m_packetSampling != 0)
+    {
+      return;
+    }
+  uint32_t index = m_trackedPackets.Find (flowId, packetId);
+  if (index == TrackedPacketTable::NOT_FOUND)
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
       return;
     }
 
-  tracked->second.timesForwarded++;
-  tracked->second.lastSeenTime = Simulator::Now ();
+  // the loss detection wheel notices the new time when it gets to the
+  // interval the packet was filed under
+  TrackedPacket &tracked = m_trackedPackets.Get (index);
+  tracked.timesForwarded++;
+  tracked.lastSeenTime = Simulator::Now ();
 
-  Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
+  Time delay = (Simulator::Now () - tracked.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 }
 
@@ -177,16 +382,21 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     {
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked == m_trackedPackets.end ())
+  if (packetId % m_packetSampling != 0)
+    {
+      return;
+    }
+  uint32_t index = m_trackedPackets.Find (flowId, packetId);
+  if (index == TrackedPacketTable::NOT_FOUND)
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
       return;
     }
+  TrackedPacket &tracked = m_trackedPackets.Get (index);
 
   Time now = Simulator::Now ();
-  Time delay = (now - tracked->second.firstSeenTime);
+  Time delay = (now - tracked.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 
   FlowStats &stats = GetStatsForFlow (flowId);
@@ -225,19 +435,19 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
         }
     }
   stats.timeLastRxPacket = now;
-  stats.timesForwarded += tracked->second.timesForwarded;
+  stats.timesForwarded += tracked.timesForwarded;
 
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
 
-  m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
+  m_trackedPackets.Erase (index); // we don't need to track this packet anymore
 }
 
 void
 FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetId, uint32_t packetSize,
                          uint32_t reasonCode)
 {
-  if (!m_enabled)
+  if (!m_enabled || packetId % m_packetSampling != 0)
     {
       return;
     }
@@ -255,14 +465,14 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked != m_trackedPackets.end ())
+  uint32_t index = m_trackedPackets.Find (flowId, packetId);
+  if (index != TrackedPacketTable::NOT_FOUND)
     {
       // we don't need to track this packet anymore
       // FIXME: this will not necessarily be true with broadcast/multicast
       NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
-      m_trackedPackets.erase (tracked);
+      m_trackedPackets.Erase (index);
     }
 }
 
@@ -273,29 +483,71 @@ FlowMonitor::GetFlowStats () const
 }
 
 
+void
+FlowMonitor::PacketLost (uint32_t index)
+{
+  // packet is considered lost, add it to the loss statistics
+  FlowStats &stats = GetStatsForFlow (m_trackedPackets.GetFlowId (index));
+  stats.lostPackets++;
+
+  // we won't track it anymore
+  m_trackedPackets.Erase (index);
+}
+
 void
 FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
   Time now = Simulator::Now ();
 
-  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
-       iter != m_trackedPackets.end (); )
+  if (maxDelay != m_maxPerHopDelay)
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
+      // not what the wheel is arranged for, look at every tracked packet
+      uint32_t i = 0;
+      while (i < m_trackedPackets.GetCapacity ())
         {
-          // packet is considered lost, add it to the loss statistics
-          std::map<FlowId, FlowStats>::iterator
-            flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
-
-          // we won't track it anymore
-          m_trackedPackets.erase (iter++);
+          if (m_trackedPackets.IsUsed (i)
+              && now - m_trackedPackets.Get (i).lastSeenTime >= maxDelay)
+            {
+              // Erase moves a following entry into slot i, look at it again
+              PacketLost (i);
+            }
+          else
+            {
+              i++;
+            }
         }
-      else
+      return;
+    }
+
+  if (now < maxDelay)
+    {
+      return;
+    }
+  // every packet of an interval up to 'last' may have expired by now
+  int64_t last = GetWheelInterval (now - maxDelay);
+  while (m_wheelNext <= last)
+    {
+      m_wheelScratch.swap (m_wheel[m_wheelNext & (m_wheel.size () - 1)]);
+      m_wheelNext++;
+      for (WheelBucket::const_iterator i = m_wheelScratch.begin (); i != m_wheelScratch.end (); ++i)
         {
-          iter++;
+          uint32_t index = m_trackedPackets.Find (i->first, i->second);
+          if (index == TrackedPacketTable::NOT_FOUND)
+            {
+              // received or dropped in the meantime
+              continue;
+            }
+          Time lastSeen = m_trackedPackets.Get (index).lastSeenTime;
+          if (now - lastSeen >= maxDelay)
+            {
+              PacketLost (index);
+            }
+          else
+            {
+              WheelInsert (GetWheelInterval (lastSeen), i->first, i->second);
+            }
         }
+      m_wheelScratch.clear ();
     }
 }
 
@@ -316,9 +568,21 @@ void
 FlowMonitor::NotifyConstructionCompleted ()
 {
   Object::NotifyConstructionCompleted ();
+  m_wheelNext = GetWheelInterval (Simulator::Now ());
   Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
+void
+FlowMonitor::DoDispose ()
+{
+  // the simulation may be destroyed already: the partial interval is
+  // written by the destroy event.
+  m_snapshotStream = 0;
+  m_snapshotDestroyEvent = EventId ();
+  m_snapshotCounters.clear ();
+  Object::DoDispose ();
+}
+
 void
 FlowMonitor::AddProbe (Ptr<FlowProbe> probe)
 {
@@ -377,6 +641,120 @@ FlowMonitor::StopRightNow ()
   CheckForLostPackets ();
 }
 
+void
+FlowMonitor::EnableSnapshots (Ptr<OutputStreamWrapper> stream, Time interval)
+{
+  NS_ASSERT (interval > Seconds (0));
+  DisableSnapshots ();
+  m_snapshotStream = stream;
+  m_snapshotInterval = interval;
+  m_snapshotStart = Simulator::Now ();
+  m_snapshotCounters.clear ();
+
+  std::ostream *os = m_snapshotStream->GetStream ();
+  os->precision (9);
+  *os << "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,rxBitrate,meanDelay,meanJitter" << std::endl;
+  m_snapshotEvent = Simulator::Schedule (m_snapshotInterval, &FlowMonitor::PeriodicSnapshot, this);
+  m_snapshotDestroyEvent = Simulator::ScheduleDestroy (&FlowMonitor::DisableSnapshots, Ptr<FlowMonitor> (this));
+}
+
+void
+FlowMonitor::EnableSnapshots (std::string fileName, Time interval)
+{
+  EnableSnapshots (Create<OutputStreamWrapper> (fileName, std::ios::out), interval);
+}
+
+void
+FlowMonitor::DisableSnapshots ()
+{
+  if (m_snapshotStream == 0)
+    {
+      return;
+    }
+  Simulator::Cancel (m_snapshotEvent);
+  // the destroy event holds a reference to this monitor.
+  Simulator::Remove (m_snapshotDestroyEvent);
+  m_snapshotDestroyEvent = EventId ();
+  if (Simulator::Now () > m_snapshotStart)
+    {
+      WriteSnapshot ();
+    }
+  m_snapshotStream = 0;
+  m_snapshotCounters.clear ();
+}
+
+void
+FlowMonitor::PeriodicSnapshot ()
+{
+  WriteSnapshot ();
+  m_snapshotEvent = Simulator::Schedule (m_snapshotInterval, &FlowMonitor::PeriodicSnapshot, this);
+}
+
+void
+FlowMonitor::WriteSnapshot ()
+{
+  CheckForLostPackets ();
+
+  Time now = Simulator::Now ();
+  double seconds = (now - m_snapshotStart).GetSeconds ();
+  std::ostream *os = m_snapshotStream->GetStream ();
+  for (std::map<FlowId, FlowStats>::const_iterator flowI = m_flowStats.begin ();
+       flowI != m_flowStats.end (); flowI++)
+    {
+      const FlowStats &stats = flowI->second;
+      std::map<FlowId, SnapshotCounters>::iterator last = m_snapshotCounters.find (flowI->first);
+      if (last == m_snapshotCounters.end ())
+        {
+          SnapshotCounters zero;
+          zero.txBytes = 0;
+          zero.rxBytes = 0;
+          zero.txPackets = 0;
+          zero.rxPackets = 0;
+          zero.lostPackets = 0;
+          zero.delaySum = Seconds (0);
+          zero.jitterSum = Seconds (0);
+          last = m_snapshotCounters.insert (std::make_pair (flowI->first, zero)).first;
+        }
+      SnapshotCounters &c = last->second;
+      uint32_t txPackets = stats.txPackets - c.txPackets;
+      uint32_t rxPackets = stats.rxPackets - c.rxPackets;
+      uint32_t lostPackets = stats.lostPackets - c.lostPackets;
+      if (txPackets == 0 && rxPackets == 0 && lostPackets == 0)
+        {
+          continue;
+        }
+      uint64_t rxBytes = stats.rxBytes - c.rxBytes;
+      double meanDelay = 0;
+      double meanJitter = 0;
+      if (rxPackets > 0)
+        {
+          meanDelay = (stats.delaySum - c.delaySum).GetSeconds () / rxPackets;
+          meanJitter = (stats.jitterSum - c.jitterSum).GetSeconds () / rxPackets;
+        }
+      *os << now.GetSeconds () << ','
+          << flowI->first << ','
+          << txPackets << ','
+          << stats.txBytes - c.txBytes << ','
+          << rxPackets << ','
+          << rxBytes << ','
+          << lostPackets << ','
+          << (seconds > 0 ? rxBytes * 8 / seconds : 0) << ','
+          << meanDelay << ','
+          << meanJitter << '\n';
+
+      c.txBytes = stats.txBytes;
+      c.rxBytes = stats.rxBytes;
+      c.txPackets = stats.txPackets;
+      c.rxPackets = stats.rxPackets;
+      c.lostPackets = stats.lostPackets;
+      c.delaySum = stats.delaySum;
+      c.jitterSum = stats.jitterSum;
+    }
+  // make the completed interval survive a crash or a killed run
+  os->flush ();
+  m_snapshotStart = now;
+}
+
 void
 FlowMonitor::SetFlowClassifier (Ptr<FlowClassifier> classifier)
 {
@@ -31,6 +31,7 @@
 #include "ns3/histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
 
@@ -201,10 +202,36 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  // --- methods to get results while the simulation runs ---
+  /// Write the statistics of every flow over each interval to a stream
+  /// while the simulation runs, one comma separated line per flow active
+  /// in the interval:
+  ///
+  /// time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,rxBitrate,meanDelay,meanJitter
+  ///
+  /// where time is the end of the interval in seconds, rxBitrate is in bit/s
+  /// and meanDelay and meanJitter are in seconds over the packets received
+  /// in the interval.  The stream is flushed after every interval, so a run
+  /// which is killed keeps the snapshots of its completed intervals.  Only
+  /// the counters of the previous interval are kept for each flow.  The
+  /// partial interval is written by DisableSnapshots or, at the latest,
+  /// by Simulator::Destroy.
+  /// \param stream the stream to write to
+  /// \param interval the length of each interval
+  void EnableSnapshots (Ptr<OutputStreamWrapper> stream, Time interval);
+  /// Same as EnableSnapshots, but writes to a new file
+  /// \param fileName name or path of the output file that will be created
+  /// \param interval the length of each interval
+  void EnableSnapshots (std::string fileName, Time interval);
+  /// Write the snapshot of the current, partial interval and stop
+  /// writing snapshots.
+  void DisableSnapshots ();
+
 
 protected:
 
   virtual void NotifyConstructionCompleted ();
+  virtual void DoDispose ();
 
 private:
 
@@ -215,15 +242,62 @@ private:
     uint32_t timesForwarded; // number of times the packet was reportedly forwarded
   };
 
+  // (FlowId,PacketId) --> TrackedPacket, open addressed with linear
+  // probing.  Erase shifts the following entries back instead of leaving
+  // tombstones, so the table never needs to be cleaned up and only
+  // allocates memory when it grows.
+  class TrackedPacketTable
+  {
+  public:
+    static const uint32_t NOT_FOUND = 0xffffffff;
+
+    TrackedPacketTable ();
+    uint32_t Find (FlowId flowId, FlowPacketId packetId) const;
+    uint32_t Insert (FlowId flowId, FlowPacketId packetId);
+    void Erase (uint32_t index);
+    TrackedPacket &Get (uint32_t index);
+    FlowId GetFlowId (uint32_t index) const;
+    uint32_t GetSize (void) const;
+    // slots can be walked from 0 to GetCapacity ()-1, skipping unused ones
+    uint32_t GetCapacity (void) const;
+    bool IsUsed (uint32_t index) const;
+
+  private:
+    struct Entry
+    {
+      FlowId flowId;
+      FlowPacketId packetId;
+      bool used;
+      TrackedPacket packet;
+    };
+    uint32_t Home (FlowId flowId, FlowPacketId packetId) const;
+    void Grow (void);
+
+    std::vector<Entry> m_entries;
+    uint32_t m_mask;
+    uint32_t m_size;
+  };
+
   // FlowId --> FlowStats
   std::map<FlowId, FlowStats> m_flowStats;
+  // FlowId --> &m_flowStats[FlowId] for small flow ids, avoids a map
+  // lookup on every packet
+  std::vector<FlowStats *> m_flowStatsIndex;
 
-  // (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
-  TrackedPacketMap m_trackedPackets;
+  TrackedPacketTable m_trackedPackets;
   Time m_maxPerHopDelay;
   std::vector< Ptr<FlowProbe> > m_flowProbes;
 
+  // Loss detection timing wheel.  A tracked packet is put in the bucket of
+  // the check interval in which it was first seen; when a bucket becomes
+  // old enough its packets are either declared lost or moved to the
+  // bucket of the time they were last seen.  Each periodic check thus
+  // only visits the packets which may have expired.
+  typedef std::vector<std::pair<FlowId, FlowPacketId> > WheelBucket;
+  std::vector<WheelBucket> m_wheel;
+  WheelBucket m_wheelScratch;
+  int64_t m_wheelNext; // first interval not checked yet
+
   // note: this is needed only for serialization
   Ptr<FlowClassifier> m_classifier;
 
@@ -235,9 +309,35 @@ private:
   double m_packetSizeBinWidth;
   double m_flowInterruptionsBinWidth;
   Time m_flowInterruptionsMinTime;
+  uint32_t m_binsPerOctave;
+  uint32_t m_histogramOctaves;
+  uint32_t m_packetSampling;
+
+  // flow counters at the end of the last snapshot interval
+  struct SnapshotCounters
+  {
+    uint64_t txBytes;
+    uint64_t rxBytes;
+    uint32_t txPackets;
+    uint32_t rxPackets;
+    uint32_t lostPackets;
+    Time delaySum;
+    Time jitterSum;
+  };
+  std::map<FlowId, SnapshotCounters> m_snapshotCounters;
+  Ptr<OutputStreamWrapper> m_snapshotStream;
+  Time m_snapshotInterval;
+  Time m_snapshotStart;
+  EventId m_snapshotEvent;
+  EventId m_snapshotDestroyEvent;
 
   FlowStats& GetStatsForFlow (FlowId flowId);
   void PeriodicCheckForLostPackets ();
+  void PeriodicSnapshot ();
+  void WriteSnapshot ();
+  int64_t GetWheelInterval (const Time &time) const;
+  void WheelInsert (int64_t interval, FlowId flowId, FlowPacketId packetId);
+  void PacketLost (uint32_t index);
 };
 
 
@@ -19,6 +19,7 @@
 //
 
 #include <math.h>
+#include <algorithm>
 #include "histogram.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
@@ -44,21 +45,39 @@ Histogram::GetNBins () const
 }
 
 double 
-Histogram::GetBinStart (uint32_t index)
+Histogram::GetBinStart (uint32_t index) const
 {
-  return index*m_binWidth;
+  if (m_binsPerOctave == 0)
+    {
+      return index*m_binWidth;
+    }
+  if (index == 0)
+    {
+      return 0;
+    }
+  uint32_t octave = (index - 1) / m_binsPerOctave;
+  uint32_t bin = (index - 1) % m_binsPerOctave;
+  return ldexp (m_binWidth, octave) * (1.0 + (double)bin / m_binsPerOctave);
 }
 
 double 
-Histogram::GetBinEnd (uint32_t index)
+Histogram::GetBinEnd (uint32_t index) const
 {
-  return (index + 1) * m_binWidth;
+  if (m_binsPerOctave != 0 && index == m_histogram.size () - 1)
+    {
+      return std::max (m_maxValue, GetBinStart (index));
+    }
+  return GetBinStart (index + 1);
 }
 
 double 
 Histogram::GetBinWidth (uint32_t index) const
 {
-  return m_binWidth;
+  if (m_binsPerOctave == 0)
+    {
+      return m_binWidth;
+    }
+  return GetBinEnd (index) - GetBinStart (index);
 }
 
 void 
@@ -68,6 +87,14 @@ Histogram::SetDefaultBinWidth (double binWidth)
   m_binWidth = binWidth;
 }
 
+void
+Histogram::SetLogScale (uint32_t binsPerOctave, uint32_t nOctaves)
+{
+  NS_ASSERT (binsPerOctave > 0 && nOctaves > 0);
+  m_binsPerOctave = binsPerOctave;
+  m_histogram.assign (2 + binsPerOctave * nOctaves, 0);
+}
+
 uint32_t 
 Histogram::GetBinCount (uint32_t index) 
 {
@@ -78,6 +105,26 @@ Histogram::GetBinCount (uint32_t index)
 void 
 Histogram::AddValue (double value)
 {
+  if (m_binsPerOctave != 0)
+    {
+      uint32_t index = 0;
+      m_maxValue = std::max (m_maxValue, value);
+      if (value >= m_binWidth)
+        {
+          // value/m_binWidth = mantissa * 2^exponent, mantissa in [0.5, 1)
+          int exponent;
+          double mantissa = frexp (value / m_binWidth, &exponent);
+          index = 1 + (exponent - 1) * m_binsPerOctave
+            + (uint32_t)((2 * mantissa - 1) * m_binsPerOctave);
+          if (index >= m_histogram.size ())
+            {
+              index = m_histogram.size () - 1;
+            }
+        }
+      m_histogram[index]++;
+      return;
+    }
+
   uint32_t index = (uint32_t)floor (value/m_binWidth);
 
   //check if we need to resize the vector
@@ -91,13 +138,17 @@ Histogram::AddValue (double value)
 }
 
 Histogram::Histogram (double binWidth)
+  : m_binWidth (binWidth),
+    m_binsPerOctave (0),
+    m_maxValue (0)
 {
-  m_binWidth = binWidth;
 }
 
 Histogram::Histogram ()
+  : m_binWidth (DEFAULT_BIN_WIDTH),
+    m_binsPerOctave (0),
+    m_maxValue (0)
 {
-  Histogram (DEFAULT_BIN_WIDTH);
 }
 
 
@@ -119,8 +170,8 @@ Histogram::SerializeToXmlStream (std::ostream &os, int indent, std::string eleme
           INDENT (indent);
           os << "<bin"
              << " index=\"" << (index) << "\""
-             << " start=\"" << (index*m_binWidth) << "\""
-             << " width=\"" << m_binWidth << "\""
+             << " start=\"" << GetBinStart (index) << "\""
+             << " width=\"" << GetBinWidth (index) << "\""
              << " count=\"" << m_histogram[index] << "\""
              << " />\n";
         }
@@ -37,12 +37,20 @@ public:
 
   // Methods for Getting the Histogram Results
   uint32_t GetNBins () const;
-  double GetBinStart (uint32_t index);
-  double GetBinEnd (uint32_t index);
+  double GetBinStart (uint32_t index) const;
+  double GetBinEnd (uint32_t index) const;
   double GetBinWidth (uint32_t index) const;
   void SetDefaultBinWidth (double binWidth);
   uint32_t GetBinCount (uint32_t index);
 
+  /// Switch to a fixed number of log-scale bins.  Bin 0 holds the values
+  /// below the bin width, then every octave above the bin width
+  /// ([w, 2w), [2w, 4w), ...) is split in binsPerOctave bins of equal
+  /// width.  Values beyond the last octave are counted in a last,
+  /// overflow bin, which ends at the largest value added.  All bins are
+  /// allocated here, so AddValue never allocates memory.
+  void SetLogScale (uint32_t binsPerOctave, uint32_t nOctaves);
+
   // Method for adding values
   void AddValue (double value);
 
@@ -55,6 +63,8 @@ public:
 private:
   std::vector<uint32_t> m_histogram;
   double m_binWidth;
+  uint32_t m_binsPerOctave; // 0 for linear bins
+  double m_maxValue; // the largest value added, which ends the overflow bin
 };
 
 
@@ -64,6 +64,7 @@ public:
     DROP_INTERFACE_DOWN,   /**< Interface is down so can not send packet */
     DROP_ROUTE_ERROR,   /**< Route error */
     DROP_FRAGMENT_TIMEOUT, /**< Fragment timeout exceeded */
+    DROP_FRAGMENT_MEMORY, /**< Fragment reassembly memory exceeded */
 
     DROP_INVALID_REASON,
   };
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+
+// A probe which only forwards the events the test case schedules.
+class TestFlowProbe : public FlowProbe
+{
+public:
+  TestFlowProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+  void FirstTx (FlowId flowId, FlowPacketId packetId)
+  {
+    m_flowMonitor->ReportFirstTx (this, flowId, packetId, 100);
+  }
+  void Forward (FlowId flowId, FlowPacketId packetId)
+  {
+    m_flowMonitor->ReportForwarding (this, flowId, packetId, 100);
+  }
+  void LastRx (FlowId flowId, FlowPacketId packetId)
+  {
+    m_flowMonitor->ReportLastRx (this, flowId, packetId, 100);
+  }
+  void Drop (FlowId flowId, FlowPacketId packetId)
+  {
+    m_flowMonitor->ReportDrop (this, flowId, packetId, 100, 0);
+  }
+};
+
+// Per flow sums of the snapshot lines.
+struct SnapshotSum
+{
+  SnapshotSum () : txPackets (0), rxPackets (0), lostPackets (0), txBytes (0), rxBytes (0) {}
+  uint32_t txPackets, rxPackets, lostPackets;
+  uint64_t txBytes, rxBytes;
+};
+
+// ===========================================================================
+// Send many packets over a few flows, receive, drop, or forward and then
+// lose some of them, and check that the in-flight table and the periodic
+// loss detection account for every packet exactly once.  Optionally also
+// check that the interval snapshots add up to the final statistics.
+// ===========================================================================
+class FlowMonitorLossTestCase : public TestCase
+{
+public:
+  FlowMonitorLossTestCase (uint32_t sampling, bool snapshots);
+  virtual void DoRun (void);
+private:
+  void CheckSnapshots (std::string fileName, const std::map<FlowId, FlowMonitor::FlowStats> &stats);
+  uint32_t m_sampling;
+  bool m_snapshots;
+};
+
+FlowMonitorLossTestCase::FlowMonitorLossTestCase (uint32_t sampling, bool snapshots)
+  : TestCase (snapshots ? "Check FlowMonitor interval snapshots" :
+              sampling == 1 ? "Check FlowMonitor packet tracking and loss detection" :
+              "Check FlowMonitor packet sampling"),
+    m_sampling (sampling),
+    m_snapshots (snapshots)
+{
+}
+
+void
+FlowMonitorLossTestCase::CheckSnapshots (std::string fileName, const std::map<FlowId, FlowMonitor::FlowStats> &stats)
+{
+  std::ifstream in (fileName.c_str ());
+  std::string line;
+  std::getline (in, line);
+  NS_TEST_ASSERT_MSG_EQ (line.substr (0, 12), "time,flowId,", "Missing snapshot header");
+
+  std::map<FlowId, SnapshotSum> sums;
+  double lastTime = 0;
+  uint32_t lines = 0;
+  while (std::getline (in, line))
+    {
+      double time;
+      FlowId flowId;
+      uint32_t txPackets, rxPackets, lostPackets;
+      uint64_t txBytes, rxBytes;
+      char c;
+      std::istringstream is (line);
+      is >> time >> c >> flowId >> c >> txPackets >> c >> txBytes >> c >> rxPackets >> c >> rxBytes >> c >> lostPackets;
+      NS_TEST_ASSERT_MSG_EQ (is.fail (), false, "Malformed snapshot line " << line);
+      NS_TEST_ASSERT_MSG_EQ ((time >= lastTime), true, "Snapshots out of order");
+      lastTime = time;
+      SnapshotSum &sum = sums[flowId];
+      sum.txPackets += txPackets;
+      sum.txBytes += txBytes;
+      sum.rxPackets += rxPackets;
+      sum.rxBytes += rxBytes;
+      sum.lostPackets += lostPackets;
+      lines++;
+    }
+  NS_TEST_ASSERT_MSG_GT (lines, 3 * 10, "Expected several snapshot intervals per flow");
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      SnapshotSum &sum = sums[i->first];
+      NS_TEST_EXPECT_MSG_EQ (sum.txPackets, i->second.txPackets, "Snapshot tx packets of flow " << i->first);
+      NS_TEST_EXPECT_MSG_EQ (sum.txBytes, i->second.txBytes, "Snapshot tx bytes of flow " << i->first);
+      NS_TEST_EXPECT_MSG_EQ (sum.rxPackets, i->second.rxPackets, "Snapshot rx packets of flow " << i->first);
+      NS_TEST_EXPECT_MSG_EQ (sum.rxBytes, i->second.rxBytes, "Snapshot rx bytes of flow " << i->first);
+      NS_TEST_EXPECT_MSG_EQ (sum.lostPackets, i->second.lostPackets, "Snapshot lost packets of flow " << i->first);
+    }
+}
+
+void
+FlowMonitorLossTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  monitor->SetAttribute ("PacketSampling", UintegerValue (m_sampling));
+  monitor->SetAttribute ("MaxPerHopDelay", TimeValue (Seconds (2.5)));
+  Ptr<TestFlowProbe> probe = Create<TestFlowProbe> (monitor);
+  monitor->AddProbe (probe);
+  monitor->StartRightNow ();
+  std::ostringstream fileName;
+  fileName << rand () << ".csv";
+  std::string snapshotFile = CreateTempDirFilename (fileName.str ());
+  if (m_snapshots)
+    {
+      monitor->EnableSnapshots (snapshotFile, MilliSeconds (700));
+    }
+
+  const uint32_t nFlows = 3;
+  const uint32_t nPackets = 3000;
+  uint32_t expectedRx[nFlows + 1] = { 0 };
+  uint32_t expectedLost[nFlows + 1] = { 0 };
+  uint32_t expectedTx[nFlows + 1] = { 0 };
+  for (uint32_t p = 0; p < nPackets; p++)
+    {
+      FlowId flowId = 1 + p % nFlows;
+      FlowPacketId packetId = p / nFlows;
+      Time t = MilliSeconds (3 * p);
+      Simulator::Schedule (t, &TestFlowProbe::FirstTx, probe, flowId, packetId);
+      bool sampled = (packetId % m_sampling == 0);
+      expectedTx[flowId] += sampled;
+      switch (p % 5)
+        {
+        case 0:
+          // lost right away
+          expectedLost[flowId] += sampled;
+          break;
+        case 1:
+          // forwarded for a while, then lost
+          Simulator::Schedule (t + Seconds (2), &TestFlowProbe::Forward, probe, flowId, packetId);
+          Simulator::Schedule (t + Seconds (4), &TestFlowProbe::Forward, probe, flowId, packetId);
+          expectedLost[flowId] += sampled;
+          break;
+        case 2:
+          // received after several forwarding steps which are each shorter
+          // than the per hop delay, although the total is longer
+          Simulator::Schedule (t + Seconds (2), &TestFlowProbe::Forward, probe, flowId, packetId);
+          Simulator::Schedule (t + Seconds (4), &TestFlowProbe::Forward, probe, flowId, packetId);
+          Simulator::Schedule (t + Seconds (6), &TestFlowProbe::LastRx, probe, flowId, packetId);
+          expectedRx[flowId] += sampled;
+          break;
+        case 3:
+          Simulator::Schedule (t + MilliSeconds (10), &TestFlowProbe::Drop, probe, flowId, packetId);
+          expectedLost[flowId] += sampled;
+          break;
+        default:
+          Simulator::Schedule (t + MilliSeconds (10), &TestFlowProbe::LastRx, probe, flowId, packetId);
+          expectedRx[flowId] += sampled;
+          break;
+        }
+    }
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+
+  std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.size (), nFlows, "Unexpected number of flows");
+  for (FlowId flowId = 1; flowId <= nFlows; flowId++)
+    {
+      const FlowMonitor::FlowStats &s = stats[flowId];
+      NS_TEST_EXPECT_MSG_EQ (s.txPackets, expectedTx[flowId], "Wrong tx count of flow " << flowId);
+      NS_TEST_EXPECT_MSG_EQ (s.rxPackets, expectedRx[flowId], "Wrong rx count of flow " << flowId);
+      NS_TEST_EXPECT_MSG_EQ (s.lostPackets, expectedLost[flowId], "Wrong lost count of flow " << flowId);
+    }
+
+  // the partial interval is written when the simulation is destroyed,
+  // and disposing of the monitor afterwards must not use the simulator.
+  Simulator::Destroy ();
+  monitor->Dispose ();
+  if (m_snapshots)
+    {
+      CheckSnapshots (snapshotFile, stats);
+      remove (snapshotFile.c_str ());
+    }
+}
+
+class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite ()
+  : TestSuite ("flow-monitor", UNIT)
+{
+  AddTestCase (new FlowMonitorLossTestCase (1, false));
+  AddTestCase (new FlowMonitorLossTestCase (4, false));
+  AddTestCase (new FlowMonitorLossTestCase (1, true));
+}
+
+static FlowMonitorTestSuite g_flowMonitorTestSuite;
+
+} // namespace ns3
@@ -69,6 +69,49 @@ HistogramTestCase::DoRun (void)
   }
 }
 
+class LogHistogramTestCase : public ns3::TestCase {
+public:
+  LogHistogramTestCase ();
+  virtual void DoRun (void);
+};
+
+LogHistogramTestCase::LogHistogramTestCase ()
+  : ns3::TestCase ("Log-scale Histogram")
+{
+}
+
+void
+LogHistogramTestCase::DoRun (void)
+{
+  Histogram h (0.001);
+  h.SetLogScale (4, 10);
+  NS_TEST_EXPECT_MSG_EQ (h.GetNBins (), 42, "");
+
+  // bin 0 is below the bin width, then 4 bins per octave
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinStart (0), 0.0, 1e-12, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinStart (1), 0.001, 1e-12, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinStart (2), 0.00125, 1e-12, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinStart (5), 0.002, 1e-12, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinWidth (5), 0.0005, 1e-12, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinEnd (40), 1.024, 1e-12, "");
+
+  h.AddValue (0.0005);
+  h.AddValue (0.001);
+  h.AddValue (0.00124);
+  h.AddValue (0.0013);
+  h.AddValue (0.0039);
+  h.AddValue (100.0);
+  NS_TEST_EXPECT_MSG_EQ (h.GetNBins (), 42, "Log-scale histograms must not grow");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (0), 1, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (1), 2, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (2), 1, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (8), 1, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (40), 0, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (41), 1, "Out of range values go to the overflow bin");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinStart (41), 1.024, 1e-12, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinEnd (41), 100.0, 1e-12, "The overflow bin must end at the largest value");
+}
+
 static class HistogramTestSuite : public TestSuite
 {
 public:
@@ -76,6 +119,7 @@ public:
     : TestSuite ("histogram", UNIT) 
   {
     AddTestCase (new HistogramTestCase ());
+    AddTestCase (new LogHistogramTestCase ());
   }
 } g_HistogramTestSuite;
 
@@ -1005,15 +1005,14 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header,
   Ptr<Ipv4Route> route = Create<Ipv4Route> ();
   Ipv4Address dst = header.GetDestination ();
 
-  NS_LOG_UNCOND("RouteOutput from " << m_ipv4->GetAddress(1,0).GetLocal() << " destination " << dst) ;
+  NS_LOG_DEBUG ("RouteOutput from " << m_ipv4->GetAddress (1, 0).GetLocal () << " destination " << dst);
 
   Vector dstPos = Vector (1, 0, 0);
 
   if (!(dst == m_ipv4->GetAddress (1, 0).GetBroadcast ()))
     {
-	  NS_LOG_UNCOND("GetPosition: from " << m_ipv4->GetAddress (1, 0));
       dstPos = m_locationService->GetPosition (dst);
-      NS_LOG_UNCOND("GetPosition retornou para GPSR pos " << dstPos << " do " << dst);
+      NS_LOG_LOGIC ("position of " << dst << " " << dstPos);
     }
 
   if (CalculateDistance (dstPos, m_locationService->GetInvalidPosition ()) == 0 && m_locationService->IsInSearch (dst))
@@ -1026,7 +1025,7 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header,
       return LoopbackRoute (header, oif);
     }
 
-  NS_LOG_UNCOND("UID do pacote " << p->GetUid() << " I'm " << m_ipv4->GetAddress(1,0).GetLocal());
+  NS_LOG_LOGIC ("packet " << p->GetUid () << " at " << m_ipv4->GetAddress (1, 0).GetLocal ());
 
   Vector myPos;
   Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
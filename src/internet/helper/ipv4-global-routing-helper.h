@@ -81,6 +81,10 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the routes of the nodes whose part of the topology changed since
+   * the previous computation are recomputed; the routes of the other nodes
+   * are kept.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -74,7 +74,8 @@ ArpCache::GetTypeId (void)
 
 ArpCache::ArpCache ()
   : m_device (0), 
-    m_interface (0)
+    m_interface (0),
+    m_pendingBytes (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -180,11 +181,22 @@ ArpCache::HandleWaitReplyTimeout (void)
   NS_LOG_FUNCTION (this);
   ArpCache::Entry* entry;
   bool restartWaitReplyTimer = false;
+  Time nextTimeout = m_waitReplyTimeout;
   for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++) 
     {
       entry = (*i).second;
       if (entry != 0 && entry->IsWaitReply ())
         {
+          Time elapsed = Simulator::Now () - entry->GetLastSeen ();
+          if (elapsed < m_waitReplyTimeout)
+            {
+              // the timer is shared by all the entries: this one sent its
+              // request after the timer was started, and its reply may
+              // still come.
+              restartWaitReplyTimer = true;
+              nextTimeout = Min (nextTimeout, m_waitReplyTimeout - elapsed);
+              continue;
+            }
           if (entry->GetRetries () < m_maxRetries)
             {
               NS_LOG_LOGIC ("node="<< m_device->GetNode ()->GetId () <<
@@ -216,7 +228,7 @@ ArpCache::HandleWaitReplyTimeout (void)
   if (restartWaitReplyTimer)
     {
       NS_LOG_LOGIC ("Restarting WaitReplyTimer at " << Simulator::Now ().GetSeconds ());
-      m_waitReplyTimer = Simulator::Schedule (m_waitReplyTimeout, 
+      m_waitReplyTimer = Simulator::Schedule (nextTimeout, 
                                               &ArpCache::HandleWaitReplyTimeout, this);
     }
 }
@@ -230,6 +242,7 @@ ArpCache::Flush (void)
       delete (*i).second;
     }
   m_arpCache.erase (m_arpCache.begin (), m_arpCache.end ());
+  m_pendingBytes = 0;
   if (m_waitReplyTimer.IsRunning ())
     {
       NS_LOG_LOGIC ("Stopping WaitReplyTimer at " << Simulator::Now ().GetSeconds () << " due to ArpCache flush");
@@ -237,13 +250,19 @@ ArpCache::Flush (void)
     }
 }
 
+uint32_t
+ArpCache::GetPendingBytes (void) const
+{
+  return m_pendingBytes;
+}
+
 ArpCache::Entry *
 ArpCache::Lookup (Ipv4Address to)
 {
-  if (m_arpCache.find (to) != m_arpCache.end ()) 
+  CacheI i = m_arpCache.find (to);
+  if (i != m_arpCache.end ()) 
     {
-      ArpCache::Entry *entry = m_arpCache[to];
-      return entry;
+      return i->second;
     }
   return 0;
 }
@@ -263,7 +282,8 @@ ArpCache::Add (Ipv4Address to)
 ArpCache::Entry::Entry (ArpCache *arp)
   : m_arp (arp),
     m_state (ALIVE),
-    m_retries (0)
+    m_retries (0),
+    m_permanent (false)
 {
   NS_LOG_FUNCTION (this << arp);
 }
@@ -284,6 +304,11 @@ ArpCache::Entry::IsWaitReply (void)
 {
   return (m_state == WAIT_REPLY) ? true : false;
 }
+bool
+ArpCache::Entry::IsPermanent (void)
+{
+  return m_permanent;
+}
 
 
 void 
@@ -304,6 +329,17 @@ ArpCache::Entry::MarkAlive (Address macAddress)
   ClearRetries ();
   UpdateSeen ();
 }
+void
+ArpCache::Entry::MarkPermanent (Address macAddress)
+{
+  NS_LOG_FUNCTION (this << macAddress);
+  NS_ASSERT (m_pending.empty ());
+  m_macAddress = macAddress;
+  m_state = ALIVE;
+  m_permanent = true;
+  ClearRetries ();
+  UpdateSeen ();
+}
 
 bool
 ArpCache::Entry::UpdateWaitReply (Ptr<Packet> waiting)
@@ -319,6 +355,7 @@ ArpCache::Entry::UpdateWaitReply (Ptr<Packet> waiting)
       return false;
     }
   m_pending.push_back (waiting);
+  m_arp->m_pendingBytes += waiting->GetSize ();
   return true;
 }
 void 
@@ -328,7 +365,11 @@ ArpCache::Entry::MarkWaitReply (Ptr<Packet> waiting)
   NS_ASSERT (m_state == ALIVE || m_state == DEAD);
   NS_ASSERT (m_pending.empty ());
   m_state = WAIT_REPLY;
-  m_pending.push_back (waiting);
+  if (waiting != 0)
+    {
+      m_pending.push_back (waiting);
+      m_arp->m_pendingBytes += waiting->GetSize ();
+    }
   UpdateSeen ();
   m_arp->StartWaitReplyTimer ();
 }
@@ -369,6 +410,10 @@ ArpCache::Entry::GetTimeout (void) const
 bool 
 ArpCache::Entry::IsExpired (void) const
 {
+  if (m_permanent)
+    {
+      return false;
+    }
   Time timeout = GetTimeout ();
   Time delta = Simulator::Now () - m_lastSeen;
   NS_LOG_DEBUG ("delta=" << delta.GetSeconds () << "s");
@@ -390,9 +435,15 @@ ArpCache::Entry::DequeuePending (void)
     {
       Ptr<Packet> p = m_pending.front ();
       m_pending.pop_front ();
+      m_arp->m_pendingBytes -= p->GetSize ();
       return p;
     }
 }
+Time
+ArpCache::Entry::GetLastSeen (void) const
+{
+  return m_lastSeen;
+}
 void 
 ArpCache::Entry::UpdateSeen (void)
 {
@@ -109,6 +109,11 @@ public:
    * \brief Clear the ArpCache of all entries
    */
   void Flush (void);
+  /**
+   * \return the number of bytes of the packets waiting for an ARP reply
+   *         in all the entries of this cache.
+   */
+  uint32_t GetPendingBytes (void) const;
 
   /**
    * \brief A record that that holds information about an ArpCache entry
@@ -130,7 +135,13 @@ public:
      */
     void MarkAlive (Address macAddress);
     /**
-     * \param waiting
+     * \brief Changes the state of this entry to alive, with a MAC address
+     *        which never expires.
+     * \param macAddress
+     */
+    void MarkPermanent (Address macAddress);
+    /**
+     * \param waiting the packet waiting for the reply, or zero
      */
     void MarkWaitReply (Ptr<Packet> waiting);
     /**
@@ -150,6 +161,10 @@ public:
      * \return True if the state of this entry is wait_reply; false otherwise.
      */
     bool IsWaitReply (void);
+    /**
+     * \return True if this entry never expires; false otherwise.
+     */
+    bool IsPermanent (void);
 
     /**
      * \return The MacAddress of this entry
@@ -170,6 +185,10 @@ public:
      * the timeout value (i.e., is not less than or equal to the timeout).
      */
     bool IsExpired (void) const;
+    /**
+     * \return the time of the last change of state or ARP request of this entry.
+     */
+    Time GetLastSeen (void) const;
     /**
      * \returns 0 is no packet is pending, the next packet to send if 
      *            packets are pending.
@@ -205,6 +224,7 @@ private:
     Ipv4Address m_ipv4Address;
     std::list<Ptr<Packet> > m_pending;
     uint32_t m_retries;
+    bool m_permanent;
   };
 
 private:
@@ -228,6 +248,7 @@ private:
    */
   void HandleWaitReplyTimeout (void);
   uint32_t m_pendingQueueSize;
+  uint32_t m_pendingBytes;
   Cache m_arpCache;
   TracedCallback<Ptr<const Packet> > m_dropTrace;
 };
@@ -23,6 +23,9 @@
 #include "ns3/net-device.h"
 #include "ns3/object-vector.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/channel.h"
 
 #include "ipv4-l3-protocol.h"
 #include "arp-l3-protocol.h"
@@ -49,6 +52,17 @@ ArpL3Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&ArpL3Protocol::m_cacheList),
                    MakeObjectVectorChecker<ArpCache> ())
+    .AddAttribute ("PendingBytesLimit",
+                   "The maximum number of bytes of the packets waiting for an ARP reply in all the caches of the node.",
+                   UintegerValue (1048576),
+                   MakeUintegerAccessor (&ArpL3Protocol::m_pendingBytesLimit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ResolveFromChannel",
+                   "Resolve the addresses of the devices on the same channel from the simulation topology "
+                   "into permanent entries, instead of exchanging ARP requests and replies.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArpL3Protocol::m_resolveFromChannel),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Drop",
                      "Packet dropped because not enough room in pending queue for a specific cache entry.",
                      MakeTraceSourceAccessor (&ArpL3Protocol::m_dropTrace))
@@ -247,6 +261,19 @@ ArpL3Protocol::Lookup (Ptr<Packet> packet, Ipv4Address destination,
 {
   NS_LOG_FUNCTION (this << packet << destination << device << cache);
   ArpCache::Entry *entry = cache->Lookup (destination);
+  if (entry == 0 && m_resolveFromChannel)
+    {
+      Address address;
+      if (ResolveFromChannel (device, destination, &address))
+        {
+          NS_LOG_LOGIC ("node="<<m_node->GetId ()<<
+                        ", " << destination << " found in the channel -- send");
+          entry = cache->Add (destination);
+          entry->MarkPermanent (address);
+          *hardwareDestination = address;
+          return true;
+        }
+    }
   if (entry != 0)
     {
       if (entry->IsExpired ()) 
@@ -255,14 +282,16 @@ ArpL3Protocol::Lookup (Ptr<Packet> packet, Ipv4Address destination,
             {
               NS_LOG_LOGIC ("node="<<m_node->GetId ()<<
                             ", dead entry for " << destination << " expired -- send arp request");
-              entry->MarkWaitReply (packet);
+              entry->MarkWaitReply (0);
+              EnqueuePending (entry, packet);
               SendArpRequest (cache, destination);
             } 
           else if (entry->IsAlive ()) 
             {
               NS_LOG_LOGIC ("node="<<m_node->GetId ()<<
                             ", alive entry for " << destination << " expired -- send arp request");
-              entry->MarkWaitReply (packet);
+              entry->MarkWaitReply (0);
+              EnqueuePending (entry, packet);
               SendArpRequest (cache, destination);
             } 
           else if (entry->IsWaitReply ()) 
@@ -288,11 +317,8 @@ ArpL3Protocol::Lookup (Ptr<Packet> packet, Ipv4Address destination,
           else if (entry->IsWaitReply ()) 
             {
               NS_LOG_LOGIC ("node="<<m_node->GetId ()<<
-                            ", wait reply for " << destination << " valid -- drop previous");
-              if (!entry->UpdateWaitReply (packet))
-                {
-                  m_dropTrace (packet);
-                }
+                            ", wait reply for " << destination << " valid -- queue");
+              EnqueuePending (entry, packet);
             }
         }
     }
@@ -302,12 +328,77 @@ ArpL3Protocol::Lookup (Ptr<Packet> packet, Ipv4Address destination,
       NS_LOG_LOGIC ("node="<<m_node->GetId ()<<
                     ", no entry for " << destination << " -- send arp request");
       entry = cache->Add (destination);
-      entry->MarkWaitReply (packet);
+      entry->MarkWaitReply (0);
+      EnqueuePending (entry, packet);
       SendArpRequest (cache, destination);
     }
   return false;
 }
 
+bool
+ArpL3Protocol::EnqueuePending (ArpCache::Entry *entry, Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  uint32_t pendingBytes = 0;
+  for (CacheList::const_iterator i = m_cacheList.begin (); i != m_cacheList.end (); i++)
+    {
+      pendingBytes += (*i)->GetPendingBytes ();
+    }
+  if (pendingBytes + packet->GetSize () > m_pendingBytesLimit)
+    {
+      NS_LOG_LOGIC ("node="<<m_node->GetId ()<<", " << pendingBytes <<
+                    " bytes already wait for a reply -- drop");
+      m_dropTrace (packet);
+      return false;
+    }
+  if (!entry->UpdateWaitReply (packet))
+    {
+      NS_LOG_LOGIC ("node="<<m_node->GetId ()<<", pending queue of " <<
+                    entry->GetIpv4Address () << " full -- drop");
+      m_dropTrace (packet);
+      return false;
+    }
+  return true;
+}
+
+bool
+ArpL3Protocol::ResolveFromChannel (Ptr<NetDevice> device, Ipv4Address destination, Address *hardwareDestination) const
+{
+  NS_LOG_FUNCTION (this << device << destination);
+  Ptr<Channel> channel = device->GetChannel ();
+  if (channel == 0)
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> peer = channel->GetDevice (i);
+      if (peer == device || peer->GetNode () == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4> ipv4 = peer->GetNode ()->GetObject<Ipv4> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      int32_t interface = ipv4->GetInterfaceForDevice (peer);
+      if (interface < 0 || !ipv4->IsUp (interface))
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (interface); j++)
+        {
+          if (ipv4->GetAddress (interface, j).GetLocal () == destination)
+            {
+              *hardwareDestination = peer->GetAddress ();
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
 void
 ArpL3Protocol::SendArpRequest (Ptr<const ArpCache> cache, Ipv4Address to)
 {
@@ -26,10 +26,10 @@
 #include "ns3/address.h"
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
+#include "arp-cache.h"
 
 namespace ns3 {
 
-class ArpCache;
 class NetDevice;
 class Node;
 class Packet;
@@ -90,8 +90,25 @@ private:
   Ptr<ArpCache> FindCache (Ptr<NetDevice> device);
   void SendArpRequest (Ptr<const ArpCache>cache, Ipv4Address to);
   void SendArpReply (Ptr<const ArpCache> cache, Ipv4Address myIp, Ipv4Address toIp, Address toMac);
+  /**
+   * \brief Queue a packet until the reply for its destination comes
+   * \param entry the entry of the destination, in WaitReply state
+   * \param packet the packet
+   * \return false if the packet was dropped
+   */
+  bool EnqueuePending (ArpCache::Entry *entry, Ptr<Packet> packet);
+  /**
+   * \brief Find the MAC address of a destination in the devices of the channel
+   * \param device the device which sends to the destination
+   * \param destination the destination
+   * \param hardwareDestination the MAC address found
+   * \return true if a device of the channel has the address of the destination
+   */
+  bool ResolveFromChannel (Ptr<NetDevice> device, Ipv4Address destination, Address *hardwareDestination) const;
   CacheList m_cacheList;
   Ptr<Node> m_node;
+  uint32_t m_pendingBytesLimit;
+  bool m_resolveFromChannel;
   TracedCallback<Ptr<const Packet> > m_dropTrace;
 };
 
@@ -50,9 +50,9 @@ operator<< (std::ostream& os, const CandidateQueue& q)
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->second->GetVertexId () << ", "
+      << iter->second->GetDistanceFromRoot () << ", "
+      << iter->second->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
@@ -87,11 +87,8 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  // the multimap inserts after the vertices of equal key.
+  m_index[vNew->GetVertexId ()] = m_candidates.insert (std::make_pair (GetKey (vNew), vNew));
 }
 
 SPFVertex *
@@ -103,8 +100,9 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.begin ()->second;
+  m_candidates.erase (m_candidates.begin ());
+  m_index.erase (v->GetVertexId ());
   return v;
 }
 
@@ -117,7 +115,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.begin ()->second;
 }
 
 bool
@@ -138,18 +136,12 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION_NOARGS ();
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  CandidateIndex_t::const_iterator i = m_index.find (addr);
+  if (i == m_index.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return 0;
     }
-
-  return 0;
+  return i->second->second;
 }
 
 void
@@ -157,11 +149,29 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // reinserting the vertices in their current order keeps the relative
+  // order of the vertices of equal key, as a stable sort would.
+  CandidateList_t candidates;
+  candidates.swap (m_candidates);
+  for (CandidateList_t::iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      m_index[i->second->GetVertexId ()] = m_candidates.insert (std::make_pair (GetKey (i->second), i->second));
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  CandidateIndex_t::iterator i = m_index.find (v->GetVertexId ());
+  NS_ASSERT (i != m_index.end () && i->second->second == v);
+  m_candidates.erase (i->second);
+  i->second = m_candidates.insert (std::make_pair (GetKey (v), v));
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -169,25 +179,11 @@ CandidateQueue::Reorder (void)
  *
  * This ordering is necessary for implementing ECMP
  */
-bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+CandidateQueue::CandidateKey_t
+CandidateQueue::GetKey (const SPFVertex* v)
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
-
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
-    {
-      result = true;
-    }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
-    {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          result = true;
-        }
-    }
-  return result;
+  return CandidateKey_t (v->GetDistanceFromRoot (),
+                         v->GetVertexType () == SPFVertex::VertexNetwork ? 0 : 1);
 }
 
 } // namespace ns3
@@ -22,7 +22,7 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -44,7 +44,11 @@ class SPFVertex;
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
- * enhanced priority queue.
+ * enhanced priority queue.  The vertices are kept in a multimap ordered by
+ * distance and type, indexed by vertex id, so that Push, Pop, Find and the
+ * reordering of a single vertex are logarithmic in the size of the queue.
+ * The vertices which compare equal are popped in the order in which they
+ * were pushed or reordered.
  */
 class CandidateQueue
 {
@@ -162,6 +166,17 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Move a vertex of the queue after a change of its distance.
+ * @internal
+ *
+ * This is the equivalent of Reorder () when only the distance of the
+ * vertex v changed since the last Push or Reorder.
+ *
+ * @param v a vertex of the queue.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -179,18 +194,18 @@ private:
  */
   CandidateQueue& operator= (CandidateQueue& sr);
 /**
- * \brief return true if v1 < v2
- *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
+ * \brief The key which orders the vertices in the queue.
  *
- * \return True if v1 should be popped before v2; false otherwise
+ * A vertex is ranked first if its GetDistanceFromRoot () is smaller;
+ * in case of a tie, a network vertex is ranked before a router vertex.
  */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
+  typedef std::pair<uint32_t, uint32_t> CandidateKey_t;
+  static CandidateKey_t GetKey (const SPFVertex* v);
 
-  typedef std::list<SPFVertex*> CandidateList_t;
+  typedef std::multimap<CandidateKey_t, SPFVertex*> CandidateList_t;
+  typedef std::map<Ipv4Address, CandidateList_t::iterator> CandidateIndex_t;
   CandidateList_t m_candidates;
+  CandidateIndex_t m_index;
 
   friend std::ostream& operator<< (std::ostream& os, const CandidateQueue& q);
 };
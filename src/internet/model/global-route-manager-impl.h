@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -37,6 +38,7 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff;
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -669,11 +671,17 @@ public:
 
 
 private:
+  friend class GlobalRouteManagerImpl;
+
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t;
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t;
 
   LSDBMap_t m_database;
   std::vector<GlobalRoutingLSA*> m_extdatabase;
+/**
+ * The LSA of each TransitNetwork link data, for GetLSAByLinkData.
+ */
+  LSDBMap_t m_linkDataIndex;
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -729,6 +737,17 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and recompute the routes of the
+ * routers which the changes of the database can affect.
+ * @internal
+ *
+ * This is equivalent to DeleteGlobalRoutes, BuildGlobalRoutingDatabase and
+ * InitializeRoutes, except that the routes of a router are kept when no
+ * LSA of its part of the topology, before or after the rebuild, changed.
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @internal
@@ -756,10 +775,31 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+/**
+ * @brief A router whose routes are computed, with the objects of its node
+ * resolved before the computation.
+ */
+  struct SPFRoot
+  {
+    Ipv4Address routerId;
+    Ptr<Ipv4> ipv4;
+    Ptr<Ipv4GlobalRouting> routing;
+  };
+  struct SPFJobs;
+
   SPFVertex* m_spfroot;
+  Ptr<Ipv4> m_spfrootIpv4;
+  Ptr<Ipv4GlobalRouting> m_spfrootRouting;
   GlobalRouteManagerLSDB* m_lsdb;
+  SPFJobs* m_jobs;
+  void RunSPF (std::vector<SPFRoot> const &roots);
+  void RunSPFJobs (void);
+  GlobalRouteManagerLSDB* CopyLsdb (void) const;
+  bool FindAffectedRouters (GlobalRouteManagerLSDB* old, std::set<Ipv4Address> &affected) const;
+  void DeleteRouterRoutes (Ptr<GlobalRouter> router);
   bool CheckForStubNode (Ipv4Address root);
   void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (SPFRoot const &root);
   void SPFProcessStubs (SPFVertex* v);
   void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
   void SPFNext (SPFVertex*, CandidateQueue&);
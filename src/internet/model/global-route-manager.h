@@ -67,6 +67,17 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and recompute the routes of the
+ * nodes which the changes of the topology can affect
+ * @internal
+ *
+ * This has the effect of DeleteGlobalRoutes, BuildGlobalRoutingDatabase and
+ * InitializeRoutes, without recomputing the routes of the nodes whose part
+ * of the topology did not change.
+ */
+  static void UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -21,13 +21,14 @@
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152), m_order (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -38,33 +39,108 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::AllocatedBefore (Ipv4EndPoint *a, Ipv4EndPoint *b)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return a->m_order < b->m_order;
+}
+
+Ipv4EndPointDemux::Table *
+Ipv4EndPointDemux::GetTable (Ipv4EndPoint *endPoint, uint64_t *key)
+{
+  uint64_t localPort = endPoint->GetLocalPort ();
+  Ipv4Address localAddress = endPoint->GetLocalAddress ();
+  Ipv4Address peerAddress = endPoint->GetPeerAddress ();
+  uint64_t peerPort = endPoint->GetPeerPort ();
+  if (peerPort != 0 && peerAddress != Ipv4Address::GetAny ())
+    {
+      *key = (static_cast<uint64_t> (peerAddress.Get ()) << 32) | (peerPort << 16) | localPort;
+      return &m_connected;
+    }
+  if (peerPort == 0 && peerAddress == Ipv4Address::GetAny ())
     {
-      if ((*i)->GetLocalPort  () == port) 
+      if (localAddress != Ipv4Address::GetAny ())
         {
-          return true;
+          *key = (static_cast<uint64_t> (localAddress.Get ()) << 16) | localPort;
+          return &m_locals;
         }
+      *key = localPort;
+      return &m_ports;
     }
-  return false;
+  // a peer address without a peer port or the other way around never
+  // matches in Lookup.
+  return 0;
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  uint64_t key;
+  Table *table = GetTable (endPoint, &key);
+  if (table == 0)
+    {
+      return;
+    }
+  EndPoints &endPoints = (*table)[key];
+  endPoints.insert (std::upper_bound (endPoints.begin (), endPoints.end (), endPoint, &AllocatedBefore),
+                    endPoint);
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  uint64_t key;
+  Table *table = GetTable (endPoint, &key);
+  if (table == 0)
+    {
+      return;
+    }
+  Table::iterator i = table->find (key);
+  NS_ASSERT (i != table->end ());
+  i->second.erase (std::find (i->second.begin (), i->second.end (), endPoint));
+  if (i->second.empty ())
+    {
+      table->erase (i);
+    }
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Add (Ipv4EndPoint *endPoint)
+{
+  endPoint->m_demux = this;
+  endPoint->m_order = m_order++;
+  m_endPoints.push_back (endPoint);
+  m_allPorts[endPoint->GetLocalPort ()].push_back (endPoint);
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_allPorts.find (port) != m_allPorts.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Table::const_iterator endPoints = m_allPorts.find (port);
+  if (endPoints == m_allPorts.end ())
+    {
+      return false;
+    }
+  for (EndPointsCI i = endPoints->second.begin (); i != endPoints->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
+      if ((*i)->GetLocalAddress () == addr) 
         {
           return true;
         }
@@ -82,10 +158,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -98,10 +171,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -121,10 +191,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -132,40 +199,45 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Table::const_iterator endPoints = m_allPorts.find (localPort);
+  if (endPoints != m_allPorts.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
+      for (EndPointsCI i = endPoints->second.begin (); i != endPoints->second.end (); i++) 
         {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
+          if ((*i)->GetLocalAddress () == localAddress &&
+              (*i)->GetPeerPort () == peerPort &&
+              (*i)->GetPeerAddress () == peerAddress) 
+            {
+              NS_LOG_WARN ("No way we can allocate this end-point.");
+              /* no way we can allocate this end-point. */
+              return 0;
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Add (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointsI i = std::find (m_endPoints.begin (), m_endPoints.end (), endPoint);
+  if (i == m_endPoints.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  Unindex (endPoint);
+  Table::iterator port = m_allPorts.find (endPoint->GetLocalPort ());
+  port->second.erase (std::find (port->second.begin (), port->second.end (), endPoint));
+  if (port->second.empty ())
+    {
+      m_allPorts.erase (port);
+    }
+  m_endPoints.erase (i);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -175,136 +247,203 @@ Ipv4EndPointDemux::EndPoints
 Ipv4EndPointDemux::GetAllEndPoints (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  EndPoints ret;
+  return m_endPoints;
+}
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+void
+Ipv4EndPointDemux::AddMatches (Table const &table, uint64_t key, Ptr<NetDevice> device)
+{
+  Table::const_iterator i = table.find (key);
+  if (i == table.end ())
     {
-      Ipv4EndPoint* endP = *i;
-      ret.push_back (endP);
+      return;
+    }
+  for (EndPointsCI j = i->second.begin (); j != i->second.end (); j++)
+    {
+      Ptr<NetDevice> bound = (*j)->GetBoundNetDevice ();
+      if (bound != 0 && bound != device)
+        {
+          NS_LOG_LOGIC ("Skipping endpoint " << *j
+                                             << " because endpoint is bound to specific device and"
+                                             << bound
+                                             << " does not match packet device " << device);
+          continue;
+        }
+      m_lookup.push_back (*j);
     }
-  return ret;
 }
 
+/*
+ * The kinds of match of an endpoint with a packet, as bits by increasing
+ * exactness.
+ */
+uint32_t
+Ipv4EndPointDemux::GetMatches (Ipv4EndPoint *endP, Ipv4Address daddr, Ipv4Address incomingInterfaceAddr,
+                               bool isBroadcast, Ipv4Address saddr, uint16_t sport, Ptr<NetDevice> device)
+{
+  if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != device)
+    {
+      return 0;
+    }
+  bool localAddressMatchesWildCard = 
+    endP->GetLocalAddress () == Ipv4Address::GetAny ();
+  bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+  if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
+    {
+      localAddressMatchesExact = (endP->GetLocalAddress () ==
+                                  incomingInterfaceAddr);
+    }
+  // if no match here, keep looking
+  if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+    return 0; 
+  bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
+  bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
+  bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+  bool remoteAddressMatchesWildCard = endP->GetPeerAddress () ==
+    Ipv4Address::GetAny ();
+  // If remote does not match either with exact or wildcard,
+  // skip this one
+  if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
+    return 0;
+  if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+    return 0;
+
+  uint32_t matches = 0;
+  if (localAddressMatchesWildCard &&
+      remotePeerMatchesWildCard &&
+      remoteAddressMatchesWildCard)
+    { // Only local port matches exactly
+      matches |= 1;
+    }
+  if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
+      remotePeerMatchesWildCard &&
+      remoteAddressMatchesWildCard)
+    { // Only local port and local address matches exactly
+      matches |= 2;
+    }
+  if (localAddressMatchesWildCard &&
+      remotePeerMatchesExact &&
+      remoteAddressMatchesExact)
+    { // All but local address
+      matches |= 4;
+    }
+  if (localAddressMatchesExact &&
+      remotePeerMatchesExact &&
+      remoteAddressMatchesExact)
+    { // All 4 match
+      matches |= 8;
+    }
+  return matches;
+}
 
 /*
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
  * Otherwise, we return 0.
  */
-Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::EndPoints const &
 Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
                            Ipv4Address saddr, uint16_t sport,
                            Ptr<Ipv4Interface> incomingInterface)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-  EndPoints retval1; // Matches exact on local port, wildcards on others
-  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-  EndPoints retval3; // Matches all but local address
-  EndPoints retval4; // Exact match on all 4
-
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  m_lookup.clear ();
+  Ptr<NetDevice> device = incomingInterface->GetDevice ();
+
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
     {
-      Ipv4EndPoint* endP = *i;
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport) 
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
         }
-      if (endP->GetBoundNetDevice ())
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+  if (saddr == Ipv4Address::GetAny () || sport == 0)
+    {
+      // a peer address or port of an endpoint may be the same as the source
+      // of the packet and a wildcard, look at all the endpoints of the port.
+      Table::const_iterator endPoints = m_allPorts.find (dport);
+      if (endPoints == m_allPorts.end ())
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
-            {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
-              continue;
-            }
+          return m_lookup;
+        }
+      uint32_t best = 0;
+      for (EndPointsCI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
+        {
+          best |= GetMatches (*i, daddr, incomingInterfaceAddr, isBroadcast, saddr, sport, device);
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+      // keep the most exact kind of match only
+      while (best & (best - 1))
         {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+          best &= best - 1;
+        }
+      for (EndPointsCI i = endPoints->second.begin (); best != 0 && i != endPoints->second.end (); i++)
+        {
+          if (GetMatches (*i, daddr, incomingInterfaceAddr, isBroadcast, saddr, sport, device) & best)
             {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
+              m_lookup.push_back (*i);
             }
         }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
-      bool localAddressMatchesWildCard = 
-        endP->GetLocalAddress () == Ipv4Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+      return m_lookup;
+    }
+
+  // the local address which matches exactly an endpoint bound to an address,
+  // an endpoint bound to any address matches exactly a packet to any address.
+  Ipv4Address local = isBroadcast ? incomingInterfaceAddr : daddr;
+  bool toAny = daddr == Ipv4Address::GetAny ();
 
-      if (isBroadcast)
+  // All 4 match, then all but local address
+  Table::const_iterator connected =
+    m_connected.find ((static_cast<uint64_t> (saddr.Get ()) << 32) | (static_cast<uint64_t> (sport) << 16) | dport);
+  if (connected != m_connected.end ())
+    {
+      for (uint32_t pass = 0; pass < 2 && m_lookup.empty (); pass++)
         {
-          NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
+          for (EndPointsCI i = connected->second.begin (); i != connected->second.end (); i++)
+            {
+              Ipv4Address address = (*i)->GetLocalAddress ();
+              bool wildcard = address == Ipv4Address::GetAny ();
+              bool exact = wildcard ? toAny : address == local;
+              if (!(pass == 0 ? exact : wildcard))
+                {
+                  continue;
+                }
+              Ptr<NetDevice> bound = (*i)->GetBoundNetDevice ();
+              if (bound == 0 || bound == device)
+                {
+                  m_lookup.push_back (*i);
+                }
+            }
         }
-
-      if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
+      if (!m_lookup.empty ())
         {
-          localAddressMatchesExact = (endP->GetLocalAddress () ==
-                                      incomingInterfaceAddr);
+          return m_lookup;
         }
-      // if no match here, keep looking
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        continue; 
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () ==
-        Ipv4Address::GetAny ();
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
+    }
 
-      // Now figure out which return list to add this one to
-      if (localAddressMatchesWildCard &&
-          remotePeerMatchesWildCard &&
-          remoteAddressMatchesWildCard)
-        { // Only local port matches exactly
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
-          remotePeerMatchesWildCard &&
-          remoteAddressMatchesWildCard)
-        { // Only local port and local address matches exactly
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard &&
-          remotePeerMatchesExact &&
-          remoteAddressMatchesExact)
-        { // All but local address
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact &&
-          remotePeerMatchesExact &&
-          remoteAddressMatchesExact)
-        { // All 4 match
-          retval4.push_back (endP);
-        }
+  // Only local port and local address matches exactly
+  AddMatches (m_locals, (static_cast<uint64_t> (local.Get ()) << 16) | dport, device);
+  if (isBroadcast || toAny)
+    {
+      EndPoints::size_type middle = m_lookup.size ();
+      AddMatches (m_ports, dport, device);
+      std::inplace_merge (m_lookup.begin (), m_lookup.begin () + middle, m_lookup.end (), &AllocatedBefore);
+    }
+  if (!m_lookup.empty ())
+    {
+      return m_lookup;
     }
 
-  // Here we find the most exact match
-  if (!retval4.empty ()) return retval4;
-  if (!retval3.empty ()) return retval3;
-  if (!retval2.empty ()) return retval2;
-  return retval1;  // might be empty if no matches
+  // Only local port matches exactly, might be empty if no matches
+  AddMatches (m_ports, dport, device);
+  return m_lookup;
 }
 
 Ipv4EndPoint *
@@ -371,4 +510,3 @@ Ipv4EndPointDemux::AllocateEphemeralPort (void)
 }
 
 } // namespace ns3
-
@@ -22,8 +22,9 @@
 #define IPV4_END_POINT_DEMUX_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv4-interface.h"
 
 namespace ns3 {
@@ -38,12 +39,22 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed in hash tables: the endpoints with a peer by
+ * (peer address, peer port, local port), the endpoints without a peer and
+ * with a local address by (local address, local port), the endpoints
+ * without peer nor local address by local port, and all the endpoints by
+ * local port.  The endpoints update the tables when their addresses
+ * change.  The packets from any address or from port 0, which match the
+ * endpoints with half a peer, are looked up in the endpoints of their
+ * port.
  */
 
 class Ipv4EndPointDemux {
 public:
-  typedef std::list<Ipv4EndPoint *> EndPoints;
-  typedef std::list<Ipv4EndPoint *>::iterator EndPointsI;
+  typedef std::vector<Ipv4EndPoint *> EndPoints;
+  typedef std::vector<Ipv4EndPoint *>::iterator EndPointsI;
+  typedef std::vector<Ipv4EndPoint *>::const_iterator EndPointsCI;
 
   Ipv4EndPointDemux ();
   ~Ipv4EndPointDemux ();
@@ -51,11 +62,15 @@ public:
   EndPoints GetAllEndPoints (void);
   bool LookupPortLocal (uint16_t port);
   bool LookupLocal (Ipv4Address addr, uint16_t port);
-  EndPoints Lookup (Ipv4Address daddr, 
-                    uint16_t dport, 
-                    Ipv4Address saddr, 
-                    uint16_t sport,
-                    Ptr<Ipv4Interface> incomingInterface);
+  /**
+   * \returns the endpoints of the most exact match, in their order of
+   * allocation.  The list is valid until the next call to this demux.
+   */
+  EndPoints const &Lookup (Ipv4Address daddr, 
+                           uint16_t dport, 
+                           Ipv4Address saddr, 
+                           uint16_t sport,
+                           Ptr<Ipv4Interface> incomingInterface);
 
   Ipv4EndPoint *SimpleLookup (Ipv4Address daddr, 
                               uint16_t dport, 
@@ -74,12 +89,38 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+  class KeyHash
+  {
+  public:
+    size_t operator() (uint64_t x) const
+    {
+      return static_cast<size_t> ((x ^ (x >> 32)) * 0x9e3779b1);
+    }
+  };
+  // the endpoints of each key, in their order of allocation.
+  typedef sgi::hash_map<uint64_t, EndPoints, KeyHash> Table;
+
+  static bool AllocatedBefore (Ipv4EndPoint *a, Ipv4EndPoint *b);
   uint16_t AllocateEphemeralPort (void);
+  Ipv4EndPoint *Add (Ipv4EndPoint *endPoint);
+  void Index (Ipv4EndPoint *endPoint);
+  void Unindex (Ipv4EndPoint *endPoint);
+  Table *GetTable (Ipv4EndPoint *endPoint, uint64_t *key);
+  void AddMatches (Table const &table, uint64_t key, Ptr<NetDevice> device);
+  uint32_t GetMatches (Ipv4EndPoint *endPoint, Ipv4Address daddr, Ipv4Address incomingInterfaceAddr,
+                       bool isBroadcast, Ipv4Address saddr, uint16_t sport, Ptr<NetDevice> device);
 
   uint16_t m_ephemeral;
   uint16_t m_portLast;
   uint16_t m_portFirst;
+  uint32_t m_order;
   EndPoints m_endPoints;
+  Table m_connected;
+  Table m_locals;
+  Table m_ports;
+  Table m_allPorts;
+  EndPoints m_lookup;
 };
 
 } // namespace ns3
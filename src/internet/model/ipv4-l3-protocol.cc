@@ -64,6 +64,12 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("FragmentMemoryLimit",
+                   "The maximum number of bytes of fragments buffered for reassembly. "
+                   "Beyond it, the oldest packets being reassembled are dropped.",
+                   UintegerValue (4194304),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_fragmentMemoryLimit),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx", "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace))
     .AddTraceSource ("Rx", "Receive ipv4 packet from incoming interface.",
@@ -81,13 +87,25 @@ Ipv4L3Protocol::GetTypeId (void)
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_unicastForwardTrace))
     .AddTraceSource ("LocalDeliver", "An IPv4 packet was received by/for this node, and it is being forward up the stack",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_localDeliverTrace))
+    .AddTraceSource ("FragmentsSize", "The number of bytes of fragments buffered for reassembly",
+                     MakeTraceSourceAccessor (&Ipv4L3Protocol::m_fragmentsSize))
+    .AddTraceSource ("ReassembledPackets", "The number of packets reassembled from their fragments",
+                     MakeTraceSourceAccessor (&Ipv4L3Protocol::m_reassembledPackets))
+    .AddTraceSource ("FragmentsTimedOut", "The number of packets dropped because their fragments timed out",
+                     MakeTraceSourceAccessor (&Ipv4L3Protocol::m_fragmentsTimedOut))
+    .AddTraceSource ("FragmentsEvicted", "The number of packets dropped to keep the fragments within FragmentMemoryLimit",
+                     MakeTraceSourceAccessor (&Ipv4L3Protocol::m_fragmentsEvicted))
 
   ;
   return tid;
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
-  : m_identification (0)
+  : m_identification (0),
+    m_fragmentsSize (0),
+    m_reassembledPackets (0),
+    m_fragmentsTimedOut (0),
+    m_fragmentsEvicted (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -205,21 +223,10 @@ Ipv4L3Protocol::DoDispose (void)
   m_node = 0;
   m_routingProtocol = 0;
 
-  for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
-    {
-      it->second = 0;
-    }
-
-  for (MapFragmentsTimers_t::iterator it = m_fragmentsTimers.begin (); it != m_fragmentsTimers.end (); it++)
-    {
-      if (it->second.IsRunning ())
-        {
-          it->second.Cancel ();
-        }
-    }
-
+  m_fragmentsTimer.Cancel ();
   m_fragments.clear ();
-  m_fragmentsTimers.clear ();
+  m_fragmentsTimeouts.clear ();
+  m_fragmentsSize = 0;
 
   Object::DoDispose ();
 }
@@ -1198,54 +1205,100 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 {
   NS_LOG_FUNCTION (this << packet << " " << ipHeader << " " << iif);
 
-  uint64_t addressCombination = uint64_t (ipHeader.GetSource ().Get ()) << 32 & uint64_t (ipHeader.GetDestination ().Get ());
-  uint32_t idProto = uint32_t (ipHeader.GetIdentification ()) << 16 & uint32_t (ipHeader.GetProtocol ());
-  std::pair<uint64_t, uint32_t> key;
+  uint64_t addressCombination = uint64_t (ipHeader.GetSource ().Get ()) << 32 | uint64_t (ipHeader.GetDestination ().Get ());
+  uint32_t idProto = uint32_t (ipHeader.GetIdentification ()) << 16 | uint32_t (ipHeader.GetProtocol ());
+  FragmentsKey_t key;
   bool ret = false;
   Ptr<Packet> p = packet->Copy ();
 
   key.first = addressCombination;
   key.second = idProto;
 
-  Ptr<Fragments> fragments;
-
   MapFragments_t::iterator it = m_fragments.find (key);
   if (it == m_fragments.end ())
     {
-      fragments = Create<Fragments> ();
-      m_fragments.insert (std::make_pair (key, fragments));
-      m_fragmentsTimers[key] = Simulator::Schedule (m_fragmentExpirationTimeout,
-                                                    &Ipv4L3Protocol::HandleFragmentsTimeout, this,
-                                                    key, ipHeader, iif);
-    }
-  else
-    {
-      fragments = it->second;
+      FragmentsEntry entry;
+      entry.fragments = Create<Fragments> ();
+      entry.header = ipHeader;
+      entry.iif = iif;
+      // keep the list sorted even if the timeout was changed in the meantime.
+      Time expiration = Simulator::Now () + m_fragmentExpirationTimeout;
+      FragmentsTimeoutList_t::iterator position = m_fragmentsTimeouts.end ();
+      while (position != m_fragmentsTimeouts.begin ())
+        {
+          FragmentsTimeoutList_t::iterator previous = position;
+          previous--;
+          if (previous->first <= expiration)
+            {
+              break;
+            }
+          position = previous;
+        }
+      entry.timeout = m_fragmentsTimeouts.insert (position, std::make_pair (expiration, key));
+      it = m_fragments.insert (std::make_pair (key, entry)).first;
+      if (entry.timeout == m_fragmentsTimeouts.begin ())
+        {
+          m_fragmentsTimer.Cancel ();
+          m_fragmentsTimer = Simulator::Schedule (m_fragmentExpirationTimeout,
+                                                  &Ipv4L3Protocol::HandleFragmentsTimeout, this);
+        }
     }
 
   NS_LOG_LOGIC ("Adding fragment - Size: " << packet->GetSize ( ) << " - Offset: " << (ipHeader.GetFragmentOffset ()) );
 
+  Ptr<Fragments> fragments = it->second.fragments;
+  uint32_t oldSize = fragments->GetSize ();
   fragments->AddFragment (p, ipHeader.GetFragmentOffset (), !ipHeader.IsLastFragment () );
+  m_fragmentsSize += fragments->GetSize () - oldSize;
 
   if ( fragments->IsEntire () )
     {
       packet = fragments->GetPacket ();
-      fragments = 0;
-      m_fragments.erase (key);
-      if (m_fragmentsTimers[key].IsRunning ())
-        {
-          NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
-          m_fragmentsTimers[key].Cancel ();
-        }
-      m_fragmentsTimers.erase (key);
+      RemoveFragments (it);
+      m_reassembledPackets++;
       ret = true;
     }
+  else if (m_fragmentsSize > m_fragmentMemoryLimit)
+    {
+      EvictFragments ();
+    }
 
   return ret;
 }
 
+void
+Ipv4L3Protocol::RemoveFragments (MapFragments_t::iterator it)
+{
+  NS_LOG_FUNCTION (this);
+  m_fragmentsSize -= it->second.fragments->GetSize ();
+  m_fragmentsTimeouts.erase (it->second.timeout);
+  m_fragments.erase (it);
+  if (m_fragmentsTimeouts.empty ())
+    {
+      m_fragmentsTimer.Cancel ();
+    }
+}
+
+void
+Ipv4L3Protocol::EvictFragments (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the packets which expire first are the ones which waited the longest.
+  while (m_fragmentsSize > m_fragmentMemoryLimit)
+    {
+      MapFragments_t::iterator it = m_fragments.find (m_fragmentsTimeouts.front ().second);
+      NS_LOG_LOGIC ("Evicting " << it->second.fragments->GetSize () << " bytes of fragments");
+      m_dropTrace (it->second.header, it->second.fragments->GetPartialPacket (), DROP_FRAGMENT_MEMORY,
+                   m_node->GetObject<Ipv4> (), it->second.iif);
+      RemoveFragments (it);
+      m_fragmentsEvicted++;
+    }
+}
+
 Ipv4L3Protocol::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_lastFragment (false),
+    m_length (0),
+    m_size (0)
 {
 }
 
@@ -1258,22 +1311,49 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
 {
   NS_LOG_FUNCTION (this << fragment << " " << fragmentOffset << " " << moreFragment);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  uint32_t start = fragmentOffset;
+  uint32_t end = start + fragment->GetSize ();
+  if (!moreFragment)
+    {
+      m_lastFragment = true;
+      m_length = end;
+    }
 
-  for (it = m_fragments.begin (); it != m_fragments.end (); it++)
+  // We do not overwrite the "old" with the "new" because we do not know when each arrived.
+  // This is different from what Linux does.
+  // It is not possible to emulate a fragmentation attack.
+  // Only the parts of the fragment between the stored intervals are kept.
+  std::map<uint32_t, Ptr<Packet> >::iterator it = m_fragments.upper_bound (start);
+  if (it != m_fragments.begin ())
     {
-      if (it->second > fragmentOffset)
+      std::map<uint32_t, Ptr<Packet> >::iterator previous = it;
+      previous--;
+      start = std::max (start, previous->first + previous->second->GetSize ());
+    }
+  while (start < end)
+    {
+      uint32_t gapEnd = end;
+      if (it != m_fragments.end ())
+        {
+          gapEnd = std::min (end, it->first);
+        }
+      if (start < gapEnd)
+        {
+          Ptr<Packet> piece = fragment;
+          if (start != fragmentOffset || gapEnd - start != fragment->GetSize ())
+            {
+              piece = fragment->CreateFragment (start - fragmentOffset, gapEnd - start);
+            }
+          m_fragments.insert (it, std::make_pair (start, piece));
+          m_size += gapEnd - start;
+        }
+      if (it == m_fragments.end ())
         {
           break;
         }
+      start = std::max (start, it->first + it->second->GetSize ());
+      it++;
     }
-
-  if (it == m_fragments.end ())
-    {
-      m_moreFragment = moreFragment;
-    }
-
-  m_fragments.insert (it, std::make_pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
 }
 
 bool
@@ -1281,29 +1361,11 @@ Ipv4L3Protocol::Fragments::IsEntire () const
 {
   NS_LOG_FUNCTION (this);
 
-  bool ret = !m_moreFragment && m_fragments.size () > 0;
-
-  if (ret)
-    {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
-        {
-          // overlapping fragments do exist
-          NS_LOG_LOGIC ("Checking overlaps " << lastEndOffset << " - " << it->second );
-
-          if (lastEndOffset < it->second)
-            {
-              ret = false;
-              break;
-            }
-          // fragments might overlap in strange ways
-          uint16_t fragmentEnd = it->first->GetSize () + it->second;
-          lastEndOffset = std::max ( lastEndOffset, fragmentEnd );
-        }
-    }
-
-  return ret;
+  // the intervals are disjoint: they cover the packet when their size is
+  // its length and none of them lies beyond its end.
+  return m_lastFragment && m_size == m_length
+         && (m_fragments.empty ()
+             || m_fragments.rbegin ()->first + m_fragments.rbegin ()->second->GetSize () == m_length);
 }
 
 Ptr<Packet>
@@ -1311,33 +1373,11 @@ Ipv4L3Protocol::Fragments::GetPacket () const
 {
   NS_LOG_FUNCTION (this);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
-
   Ptr<Packet> p = Create<Packet> ();
-  uint16_t lastEndOffset = 0;
-
-  for ( it = m_fragments.begin (); it != m_fragments.end (); it++)
+  for (std::map<uint32_t, Ptr<Packet> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
-      if ( lastEndOffset > it->second )
-        {
-          // The fragments are overlapping.
-          // We do not overwrite the "old" with the "new" because we do not know when each arrived.
-          // This is different from what Linux does.
-          // It is not possible to emulate a fragmentation attack.
-          uint32_t newStart = lastEndOffset - it->second;
-          if ( it->first->GetSize () > newStart )
-            {
-              uint32_t newSize = it->first->GetSize () - newStart;
-              Ptr<Packet> tempFragment = it->first->CreateFragment (newStart, newSize);
-              p->AddAtEnd (tempFragment);
-            }
-        }
-      else
-        {
-          NS_LOG_LOGIC ("Adding: " << *(it->first) );
-          p->AddAtEnd (it->first);
-        }
-      lastEndOffset = p->GetSize ();
+      NS_LOG_LOGIC ("Adding: " << *(it->second) );
+      p->AddAtEnd (it->second);
     }
 
   return p;
@@ -1346,57 +1386,52 @@ Ipv4L3Protocol::Fragments::GetPacket () const
 Ptr<Packet>
 Ipv4L3Protocol::Fragments::GetPartialPacket () const
 {
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
-
   Ptr<Packet> p = Create<Packet> ();
-  uint16_t lastEndOffset = 0;
-
-  if ( m_fragments.begin ()->second > 0 )
-    {
-      return p;
-    }
 
-  for ( it = m_fragments.begin (); it != m_fragments.end (); it++)
+  for (std::map<uint32_t, Ptr<Packet> >::const_iterator it = m_fragments.begin ();
+       it != m_fragments.end () && it->first == p->GetSize (); it++)
     {
-      if ( lastEndOffset > it->second )
-        {
-          uint32_t newStart = lastEndOffset - it->second;
-          uint32_t newSize = it->first->GetSize () - newStart;
-          Ptr<Packet> tempFragment = it->first->CreateFragment (newStart, newSize);
-          p->AddAtEnd (tempFragment);
-        }
-      else if ( lastEndOffset == it->second )
-        {
-          NS_LOG_LOGIC ("Adding: " << *(it->first) );
-          p->AddAtEnd (it->first);
-        }
-      lastEndOffset = p->GetSize ();
+      NS_LOG_LOGIC ("Adding: " << *(it->second) );
+      p->AddAtEnd (it->second);
     }
 
   return p;
 }
 
+uint32_t
+Ipv4L3Protocol::Fragments::GetSize () const
+{
+  return m_size;
+}
+
 void
-Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif)
+Ipv4L3Protocol::HandleFragmentsTimeout (void)
 {
   NS_LOG_FUNCTION (this);
 
-  MapFragments_t::iterator it = m_fragments.find (key);
-  Ptr<Packet> packet = it->second->GetPartialPacket ();
-
-  // if we have at least 8 bytes, we can send an ICMP.
-  if ( packet->GetSize () > 8 )
+  while (!m_fragmentsTimeouts.empty () && m_fragmentsTimeouts.front ().first <= Simulator::Now ())
     {
-      Ptr<Icmpv4L4Protocol> icmp = GetIcmp ();
-      icmp->SendTimeExceededTtl (ipHeader, packet);
+      MapFragments_t::iterator it = m_fragments.find (m_fragmentsTimeouts.front ().second);
+      Ptr<Packet> packet = it->second.fragments->GetPartialPacket ();
+      Ipv4Header ipHeader = it->second.header;
+      uint32_t iif = it->second.iif;
+      RemoveFragments (it);
+      m_fragmentsTimedOut++;
+
+      // if we have at least 8 bytes, we can send an ICMP.
+      if ( packet->GetSize () > 8 )
+        {
+          Ptr<Icmpv4L4Protocol> icmp = GetIcmp ();
+          icmp->SendTimeExceededTtl (ipHeader, packet);
+        }
+      m_dropTrace (ipHeader, packet, DROP_FRAGMENT_TIMEOUT, m_node->GetObject<Ipv4> (), iif);
     }
-  m_dropTrace (ipHeader, packet, DROP_FRAGMENT_TIMEOUT, m_node->GetObject<Ipv4> (), iif);
-
-  // clear the buffers
-  it->second = 0;
 
-  m_fragments.erase (key);
-  m_fragmentsTimers.erase (key);
+  if (!m_fragmentsTimeouts.empty ())
+    {
+      m_fragmentsTimer = Simulator::Schedule (m_fragmentsTimeouts.front ().first - Simulator::Now (),
+                                              &Ipv4L3Protocol::HandleFragmentsTimeout, this);
+    }
 }
 
 } // namespace ns3
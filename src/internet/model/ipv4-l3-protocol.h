@@ -30,6 +30,7 @@
 #include "ns3/net-device.h"
 #include "ns3/ipv4.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/nstime.h"
@@ -94,7 +95,8 @@ public:
     DROP_BAD_CHECKSUM,   /**< Bad checksum */
     DROP_INTERFACE_DOWN,   /**< Interface is down so can not send packet */
     DROP_ROUTE_ERROR,   /**< Route error */
-    DROP_FRAGMENT_TIMEOUT /**< Fragment timeout exceeded */
+    DROP_FRAGMENT_TIMEOUT, /**< Fragment timeout exceeded */
+    DROP_FRAGMENT_MEMORY /**< Fragment reassembly memory exceeded */
   };
 
   void SetNode (Ptr<Node> node);
@@ -283,12 +285,9 @@ private:
   bool ProcessFragment (Ptr<Packet>& packet, Ipv4Header & ipHeader, uint32_t iif);
 
   /**
-   * \brief Process the timeout for packet fragments
-   * \param key representing the packet fragments
-   * \param ipHeader the IP header of the original packet
-   * \param iif Input Interface
+   * \brief Expire the packets whose fragments timed out.
    */
-  void HandleFragmentsTimeout ( std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif);
+  void HandleFragmentsTimeout (void);
 
   typedef std::vector<Ptr<Ipv4Interface> > Ipv4InterfaceList;
   typedef std::list<Ptr<Ipv4RawSocketImpl> > SocketList;
@@ -319,6 +318,12 @@ private:
   /**
    * \class Fragments
    * \brief A Set of Fragment belonging to the same packet (src, dst, identification and proto)
+   *
+   * The fragments are kept as disjoint intervals of the original payload
+   * indexed by their offset: the bytes of a new fragment which were already
+   * received are trimmed away, so that the stored size is the number of
+   * distinct bytes received and the packet is entire when it reaches the
+   * length given by the last fragment.
    */
   class Fragments : public SimpleRefCount<Fragments>
   {
@@ -359,32 +364,82 @@ public:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Get the number of distinct bytes received.
+     * \return the size of the stored fragments
+     */
+    uint32_t GetSize () const;
+
 private:
     /**
-     * \brief True if other fragments will be sent.
+     * \brief True if the last fragment has been received.
      */
-    bool m_moreFragment;
+    bool m_lastFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief The length of the packet, valid once the last fragment has been received.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
+    uint32_t m_length;
 
     /**
-     * \brief Number of references.
+     * \brief The number of distinct bytes received.
      */
-    mutable uint32_t m_refCount;
+    uint32_t m_size;
+
+    /**
+     * \brief The current fragments, disjoint and indexed by their offset.
+     */
+    std::map<uint32_t, Ptr<Packet> > m_fragments;
   };
 
-  typedef std::map< std::pair<uint64_t, uint32_t>, Ptr<Fragments> > MapFragments_t;
-  typedef std::map< std::pair<uint64_t, uint32_t>, EventId > MapFragmentsTimers_t;
+  typedef std::pair<uint64_t, uint32_t> FragmentsKey_t;
+  typedef std::list<std::pair<Time, FragmentsKey_t> > FragmentsTimeoutList_t;
+
+  /**
+   * \brief A packet being reassembled.
+   */
+  struct FragmentsEntry
+  {
+    Ptr<Fragments> fragments; //!< the fragments received
+    Ipv4Header header;        //!< the header of the first fragment received
+    uint32_t iif;             //!< the interface of the first fragment received
+    FragmentsTimeoutList_t::iterator timeout; //!< the position in the timeout list
+  };
+
+  typedef std::map<FragmentsKey_t, FragmentsEntry> MapFragments_t;
+
+  /**
+   * \brief Forget a packet being reassembled.
+   * \param it the packet
+   */
+  void RemoveFragments (MapFragments_t::iterator it);
+
+  /**
+   * \brief Drop the oldest packets being reassembled until the fragments fit the memory limit.
+   */
+  void EvictFragments (void);
 
   /**
    * \brief The hash of fragmented packets.
    */
   MapFragments_t       m_fragments;
   Time                 m_fragmentExpirationTimeout;
-  MapFragmentsTimers_t m_fragmentsTimers;
+  uint32_t             m_fragmentMemoryLimit;
+
+  /**
+   * \brief The packets being reassembled, in the order of their expiration.
+   *
+   * All the packets wait for the same timeout, so that they expire in the
+   * order of their first fragment and a single event, scheduled for the
+   * oldest one, replaces a timer per packet.
+   */
+  FragmentsTimeoutList_t m_fragmentsTimeouts;
+  EventId              m_fragmentsTimer;
+
+  TracedValue<uint32_t> m_fragmentsSize;
+  TracedValue<uint32_t> m_reassembledPackets;
+  TracedValue<uint32_t> m_fragmentsTimedOut;
+  TracedValue<uint32_t> m_fragmentsEvicted;
 
 };
 
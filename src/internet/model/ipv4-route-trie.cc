@@ -0,0 +1,284 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+namespace ns3 {
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (0),
+    m_order (0)
+{
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  Clear ();
+}
+
+uint32_t
+Ipv4RouteTrie::GetMask (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+uint32_t
+Ipv4RouteTrie::GetBit (uint32_t address, uint32_t index)
+{
+  return (address >> (31 - index)) & 1;
+}
+
+bool
+Ipv4RouteTrie::IsBetter (struct Route const &a, struct Route const *b)
+{
+  if (b == 0 || a.prefixLength != b->prefixLength)
+    {
+      return b == 0 || a.prefixLength > b->prefixLength;
+    }
+  if (a.metric != b->metric)
+    {
+      return a.metric < b->metric;
+    }
+  return a.order > b->order;
+}
+
+Ipv4RouteTrie::Node *
+Ipv4RouteTrie::CreateNode (uint32_t prefix, uint32_t length)
+{
+  Node *node = new Node ();
+  node->prefix = prefix;
+  node->length = length;
+  node->children[0] = 0;
+  node->children[1] = 0;
+  return node;
+}
+
+void
+Ipv4RouteTrie::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->children[0]);
+      DeleteNode (node->children[1]);
+      delete node;
+    }
+}
+
+void
+Ipv4RouteTrie::Insert (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  struct Route item;
+  item.route = route;
+  item.metric = metric;
+  item.prefixLength = mask.GetPrefixLength ();
+  item.order = m_order++;
+  if (mask.Get () != GetMask (item.prefixLength))
+    {
+      NS_LOG_LOGIC ("Non-contiguous mask " << mask << ", not indexed");
+      m_irregular.push_back (item);
+      return;
+    }
+
+  uint32_t prefix = route->GetDestNetwork ().Get () & mask.Get ();
+  uint32_t length = item.prefixLength;
+  Node **link = &m_root;
+  while (true)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = CreateNode (prefix, length);
+          node->routes.push_back (item);
+          *link = node;
+          return;
+        }
+      uint32_t limit = std::min (node->length, length);
+      uint32_t common = 0;
+      while (common < limit && GetBit (prefix, common) == GetBit (node->prefix, common))
+        {
+          common++;
+        }
+      if (common < node->length)
+        {
+          // the new prefix diverges from the node, or is shorter than it:
+          // insert a node for the common part above it.
+          Node *split = CreateNode (prefix & GetMask (common), common);
+          split->children[GetBit (node->prefix, common)] = node;
+          *link = split;
+          if (common == length)
+            {
+              split->routes.push_back (item);
+            }
+          else
+            {
+              Node *leaf = CreateNode (prefix, length);
+              leaf->routes.push_back (item);
+              split->children[GetBit (prefix, common)] = leaf;
+            }
+          return;
+        }
+      if (node->length == length)
+        {
+          node->routes.push_back (item);
+          return;
+        }
+      link = &node->children[GetBit (prefix, node->length)];
+    }
+}
+
+void
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint32_t length = mask.GetPrefixLength ();
+  if (mask.Get () != GetMask (length))
+    {
+      for (std::vector<struct Route>::iterator i = m_irregular.begin (); i != m_irregular.end (); i++)
+        {
+          if (i->route == route)
+            {
+              m_irregular.erase (i);
+              return;
+            }
+        }
+      NS_ASSERT_MSG (false, "Route not in the trie");
+      return;
+    }
+
+  uint32_t prefix = route->GetDestNetwork ().Get () & mask.Get ();
+  Node **parentLink = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length)
+    {
+      parentLink = link;
+      link = &(*link)->children[GetBit (prefix, (*link)->length)];
+    }
+  Node *node = *link;
+  NS_ASSERT_MSG (node != 0 && node->length == length && node->prefix == prefix, "Route not in the trie");
+  for (std::vector<struct Route>::iterator i = node->routes.begin (); i != node->routes.end (); i++)
+    {
+      if (i->route == route)
+        {
+          node->routes.erase (i);
+          break;
+        }
+    }
+  if (!node->routes.empty ())
+    {
+      return;
+    }
+  // keep the trie path-compressed: a node without routes must have two
+  // children.  Removing the node can only leave its parent with one.
+  Collapse (link);
+  if (parentLink != 0)
+    {
+      Collapse (parentLink);
+    }
+}
+
+void
+Ipv4RouteTrie::Collapse (Node **link)
+{
+  Node *node = *link;
+  if (!node->routes.empty () || (node->children[0] != 0 && node->children[1] != 0))
+    {
+      return;
+    }
+  *link = node->children[0] != 0 ? node->children[0] : node->children[1];
+  delete node;
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  DeleteNode (m_root);
+  m_root = 0;
+  m_irregular.clear ();
+}
+
+struct Ipv4RouteTrie::Route const *
+Ipv4RouteTrie::Select (std::vector<struct Route> const &routes, bool any, uint32_t interface)
+{
+  struct Route const *best = 0;
+  for (std::vector<struct Route>::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      if ((any || i->route->GetInterface () == interface) && IsBetter (*i, best))
+        {
+          best = &(*i);
+        }
+    }
+  return best;
+}
+
+Ipv4RoutingTableEntry *
+Ipv4RouteTrie::DoLookup (uint32_t dest, bool any, uint32_t interface) const
+{
+  // the prefix lengths strictly increase along a path of the trie.
+  Node const *path[33];
+  uint32_t n = 0;
+  Node const *node = m_root;
+  while (node != 0 && (dest & GetMask (node->length)) == node->prefix)
+    {
+      if (!node->routes.empty ())
+        {
+          path[n++] = node;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->children[GetBit (dest, node->length)];
+    }
+  struct Route const *best = 0;
+  while (n > 0 && best == 0)
+    {
+      best = Select (path[--n]->routes, any, interface);
+    }
+  for (std::vector<struct Route>::const_iterator i = m_irregular.begin (); i != m_irregular.end (); i++)
+    {
+      Ipv4Mask mask = i->route->GetDestNetworkMask ();
+      if (mask.IsMatch (Ipv4Address (dest), i->route->GetDestNetwork ())
+          && (any || i->route->GetInterface () == interface)
+          && IsBetter (*i, best))
+        {
+          best = &(*i);
+        }
+    }
+  return best != 0 ? best->route : 0;
+}
+
+Ipv4RoutingTableEntry *
+Ipv4RouteTrie::Lookup (Ipv4Address dest) const
+{
+  return DoLookup (dest.Get (), true, 0);
+}
+
+Ipv4RoutingTableEntry *
+Ipv4RouteTrie::Lookup (Ipv4Address dest, uint32_t interface) const
+{
+  return DoLookup (dest.Get (), false, interface);
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <vector>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4StaticRouting
+ *
+ * \brief Longest prefix match index of the network routes of a routing table.
+ *
+ * The routes are stored in a path-compressed binary trie keyed by their
+ * destination prefix: a lookup walks at most one node per distinct prefix
+ * length on the path of the destination address instead of comparing the
+ * destination with every route of the table, and a route is inserted or
+ * removed without rebuilding the trie.
+ *
+ * The routes which share a prefix are kept in a single node.  Among the
+ * routes of the longest matching prefix, the lookup returns the one with
+ * the lowest metric and, between equal metrics, the route which was
+ * inserted last, which is the order in which Ipv4StaticRouting has always
+ * broken the ties.  The rare routes with a non-contiguous mask cannot be
+ * stored in the trie and are compared linearly with the result of the trie.
+ *
+ * The trie does not own the routing table entries.
+ */
+class Ipv4RouteTrie
+{
+public:
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \param route the route to insert, whose destination and mask must not
+   *        change while it is in the trie.
+   * \param metric the metric of the route.
+   */
+  void Insert (Ipv4RoutingTableEntry *route, uint32_t metric);
+  /**
+   * \param route a route previously inserted.
+   */
+  void Remove (Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+  /**
+   * \param dest the destination address.
+   * \returns the best route to the destination, or zero.
+   */
+  Ipv4RoutingTableEntry * Lookup (Ipv4Address dest) const;
+  /**
+   * \param dest the destination address.
+   * \param interface only the routes through this interface are considered.
+   * \returns the best route to the destination through the interface, or zero.
+   */
+  Ipv4RoutingTableEntry * Lookup (Ipv4Address dest, uint32_t interface) const;
+
+private:
+  Ipv4RouteTrie (Ipv4RouteTrie const &);
+  Ipv4RouteTrie &operator = (Ipv4RouteTrie const &);
+
+  struct Route
+  {
+    Ipv4RoutingTableEntry *route;
+    uint32_t metric;
+    uint32_t prefixLength;
+    uint64_t order;
+  };
+  struct Node
+  {
+    uint32_t prefix;
+    uint32_t length;
+    Node *children[2];
+    std::vector<struct Route> routes;
+  };
+
+  static uint32_t GetMask (uint32_t length);
+  static uint32_t GetBit (uint32_t address, uint32_t index);
+  static bool IsBetter (struct Route const &a, struct Route const *b);
+  static Node * CreateNode (uint32_t prefix, uint32_t length);
+  static void DeleteNode (Node *node);
+  static void Collapse (Node **link);
+  static struct Route const * Select (std::vector<struct Route> const &routes, bool any, uint32_t interface);
+  Ipv4RoutingTableEntry * DoLookup (uint32_t dest, bool any, uint32_t interface) const;
+
+  Node *m_root;
+  std::vector<struct Route> m_irregular;
+  uint64_t m_order;
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
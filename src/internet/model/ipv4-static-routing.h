@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -390,6 +391,8 @@ private:
   Ipv4Address SourceAddressSelection (uint32_t interface, Ipv4Address dest);
 
   NetworkRoutes m_networkRoutes;
+  /// longest prefix match index of m_networkRoutes
+  Ipv4RouteTrie m_routeTrie;
   MulticastRoutes m_multicastRoutes;
 
   Ptr<Ipv4> m_ipv4;
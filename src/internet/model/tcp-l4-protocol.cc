@@ -250,7 +250,7 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
     }
 
   NS_LOG_LOGIC ("TcpL4Protocol "<<this<<" received a packet");
-  Ipv4EndPointDemux::EndPoints endPoints =
+  Ipv4EndPointDemux::EndPoints const &endPoints =
     m_endPoints->Lookup (ipHeader.GetDestination (), tcpHeader.GetDestinationPort (),
                          ipHeader.GetSource (), tcpHeader.GetSourcePort (),incomingInterface);
   if (endPoints.empty ())
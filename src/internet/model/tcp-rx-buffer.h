@@ -36,6 +36,11 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The data is kept as disjoint intervals of sequence numbers ordered by
+ * their first byte, so that the intervals which an incoming packet
+ * overlaps, and the ones which follow the next expected byte, are found
+ * by a lookup rather than by a walk of the whole buffer.
  */
 class TcpRxBuffer : public Object
 {
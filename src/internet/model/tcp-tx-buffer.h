@@ -21,7 +21,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +36,13 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets written by the application are kept unchanged, each with the
+ * offset of its first byte in the stream, so that the packet holding the
+ * first byte of a segment is found by a binary search and a segment which
+ * falls in a single packet is a fragment of it, without copying the data.
+ * The acknowledged bytes of the first packet are skipped rather than cut
+ * off it.
  */
 class TcpTxBuffer : public Object
 {
@@ -108,12 +115,20 @@ public:
   void DiscardUpTo (const SequenceNumber32& seq);
 
 private:
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  struct Item
+  {
+    uint64_t offset;                            //< Offset in the stream of the first byte of the packet
+    Ptr<Packet> packet;
+  };
+  typedef std::deque<Item>::const_iterator BufIterator;
+
+  static bool IsBefore (uint64_t offset, const Item &item);
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //< Number of data bytes
   uint32_t m_maxBuffer;                         //< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //< Corresponding data (may be null)
+  uint64_t m_headOffset;                        //< Offset in the stream of the first byte in data
+  std::deque<Item> m_data;                      //< Corresponding data, by offset
 };
 
 } // namepsace ns3
@@ -236,7 +236,7 @@ UdpL4Protocol::Receive (Ptr<Packet> packet,
     }
 
   NS_LOG_DEBUG ("Looking up dst " << header.GetDestination () << " port " << udpHeader.GetDestinationPort ()); 
-  Ipv4EndPointDemux::EndPoints endPoints =
+  Ipv4EndPointDemux::EndPoints const &endPoints =
     m_endPoints->Lookup (header.GetDestination (), udpHeader.GetDestinationPort (),
                          header.GetSource (), udpHeader.GetSourcePort (), interface);
   if (endPoints.empty ())
@@ -244,7 +244,7 @@ UdpL4Protocol::Receive (Ptr<Packet> packet,
       NS_LOG_LOGIC ("RX_ENDPOINT_UNREACH");
       return Ipv4L4Protocol::RX_ENDPOINT_UNREACH;
     }
-  for (Ipv4EndPointDemux::EndPointsI endPoint = endPoints.begin ();
+  for (Ipv4EndPointDemux::EndPointsCI endPoint = endPoints.begin ();
        endPoint != endPoints.end (); endPoint++)
     {
       (*endPoint)->ForwardUp (packet->Copy (), header, udpHeader.GetSourcePort (), 
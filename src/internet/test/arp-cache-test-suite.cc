@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/**
+ * This is the test code for arp-cache.cc and arp-l3-protocol.cc
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/arp-header.h"
+#include "ns3/arp-cache.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+
+namespace ns3 {
+
+class ArpCacheTestCase : public TestCase
+{
+public:
+  ArpCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckRequests (void);
+  void CheckPendingBytes (void);
+  void CheckResolveFromChannel (void);
+
+  // a node with an IPv4 interface on the channel, and an ARP cache for it.
+  Ptr<ArpCache> AddNode (Ptr<SimpleChannel> channel, Ipv4Address address);
+  // a node which records the ARP requests sent on the channel.
+  void AddSniffer (Ptr<SimpleChannel> channel);
+  void ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                   const Address &to, NetDevice::PacketType packetType);
+  void DropPacket (Ptr<const Packet> p);
+  bool Lookup (Ptr<ArpCache> cache, Ipv4Address destination, uint32_t size);
+
+  std::vector<std::pair<Time, Ipv4Address> > m_requests;
+  uint32_t m_drops;
+};
+
+ArpCacheTestCase::ArpCacheTestCase ()
+  : TestCase ("Check the pending queues, requests and permanent entries of the ARP cache")
+{
+}
+
+Ptr<ArpCache>
+ArpCacheTestCase::AddNode (Ptr<SimpleChannel> channel, Ipv4Address address)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<ArpL3Protocol> arp = CreateObject<ArpL3Protocol> ();
+  node->AggregateObject (arp);
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  node->AggregateObject (ipv4);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetChannel (channel);
+  node->AddDevice (device);
+  uint32_t interface = ipv4->AddInterface (device);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (address, Ipv4Mask ("255.255.255.0")));
+  ipv4->SetUp (interface);
+  arp->TraceConnectWithoutContext ("Drop", MakeCallback (&ArpCacheTestCase::DropPacket, this));
+  // the simple devices do not need ARP: create the cache which a device
+  // needing it would get from its interface.
+  return arp->CreateCache (device, ipv4->GetInterface (interface));
+}
+
+void
+ArpCacheTestCase::AddSniffer (Ptr<SimpleChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetChannel (channel);
+  node->AddDevice (device);
+  node->RegisterProtocolHandler (MakeCallback (&ArpCacheTestCase::ReceiveArp, this),
+                                 ArpL3Protocol::PROT_NUMBER, device);
+}
+
+void
+ArpCacheTestCase::ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                              const Address &to, NetDevice::PacketType packetType)
+{
+  ArpHeader arp;
+  p->Copy ()->RemoveHeader (arp);
+  if (arp.IsRequest ())
+    {
+      m_requests.push_back (std::make_pair (Simulator::Now (), arp.GetDestinationIpv4Address ()));
+    }
+}
+
+void
+ArpCacheTestCase::DropPacket (Ptr<const Packet> p)
+{
+  m_drops++;
+}
+
+bool
+ArpCacheTestCase::Lookup (Ptr<ArpCache> cache, Ipv4Address destination, uint32_t size)
+{
+  Ptr<ArpL3Protocol> arp = cache->GetDevice ()->GetNode ()->GetObject<ArpL3Protocol> ();
+  Address hardwareDestination;
+  return arp->Lookup (Create<Packet> (size), destination, cache->GetDevice (), cache, &hardwareDestination);
+}
+
+void
+ArpCacheTestCase::CheckRequests (void)
+{
+  // The cache has a single timer for all its entries: a request sent just
+  // before it expires waits a full WaitReplyTimeout for its reply.
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<ArpCache> cache = AddNode (channel, Ipv4Address ("10.0.0.1"));
+  AddSniffer (channel);
+  m_requests.clear ();
+  Simulator::Schedule (Seconds (0), &ArpCacheTestCase::Lookup, this, cache, Ipv4Address ("10.0.0.2"), 100);
+  Simulator::Schedule (Seconds (0.9), &ArpCacheTestCase::Lookup, this, cache, Ipv4Address ("10.0.0.3"), 100);
+  Simulator::Schedule (Seconds (0.95), &ArpCacheTestCase::Lookup, this, cache, Ipv4Address ("10.0.0.3"), 100);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // one request and MaxRetries retransmissions per address
+  NS_TEST_ASSERT_MSG_EQ (m_requests.size (), 8, "Wrong number of requests");
+  for (uint32_t i = 0; i < m_requests.size (); i++)
+    {
+      Time expected = Seconds (m_requests[i].second == Ipv4Address ("10.0.0.2") ? 0 : 0.9);
+      uint32_t retries = 0;
+      for (uint32_t j = 0; j < i; j++)
+        {
+          if (m_requests[j].second == m_requests[i].second)
+            {
+              retries++;
+            }
+        }
+      expected += Seconds (retries);
+      NS_TEST_EXPECT_MSG_EQ (m_requests[i].first, expected,
+                             "Request " << retries << " for " << m_requests[i].second << " sent at the wrong time");
+    }
+}
+
+void
+ArpCacheTestCase::CheckPendingBytes (void)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<ArpCache> cache = AddNode (channel, Ipv4Address ("10.0.0.1"));
+  Ptr<ArpL3Protocol> arp = cache->GetDevice ()->GetNode ()->GetObject<ArpL3Protocol> ();
+  arp->SetAttribute ("PendingBytesLimit", UintegerValue (2500));
+  m_drops = 0;
+
+  NS_TEST_EXPECT_MSG_EQ (Lookup (cache, Ipv4Address ("10.0.0.2"), 1000), false, "No reply yet");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (cache, Ipv4Address ("10.0.0.3"), 1000), false, "No reply yet");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetPendingBytes (), 2000, "Packets not queued");
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 0, "Packet dropped within the limit");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (cache, Ipv4Address ("10.0.0.4"), 1000), false, "No reply yet");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetPendingBytes (), 2000, "Packet queued beyond the limit");
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "Packet beyond the limit not dropped");
+  NS_TEST_EXPECT_MSG_EQ (cache->Lookup (Ipv4Address ("10.0.0.4"))->IsWaitReply (), true,
+                         "Address not resolved when its packet is dropped");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (cache, Ipv4Address ("10.0.0.2"), 400), false, "No reply yet");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetPendingBytes (), 2400, "Packet not queued within the limit");
+
+  // the pending packets are dropped when the requests time out.
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (cache->GetPendingBytes (), 0, "Pending bytes left after the timeouts");
+  Simulator::Destroy ();
+}
+
+void
+ArpCacheTestCase::CheckResolveFromChannel (void)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<ArpCache> cache = AddNode (channel, Ipv4Address ("10.0.0.1"));
+  Ptr<ArpCache> peer = AddNode (channel, Ipv4Address ("10.0.0.2"));
+  AddSniffer (channel);
+  Ptr<ArpL3Protocol> arp = cache->GetDevice ()->GetNode ()->GetObject<ArpL3Protocol> ();
+  arp->SetAttribute ("ResolveFromChannel", BooleanValue (true));
+  m_requests.clear ();
+
+  Address hardwareDestination;
+  bool found = arp->Lookup (Create<Packet> (100), Ipv4Address ("10.0.0.2"), cache->GetDevice (), cache,
+                            &hardwareDestination);
+  NS_TEST_EXPECT_MSG_EQ (found, true, "Address of the channel not resolved");
+  NS_TEST_EXPECT_MSG_EQ (hardwareDestination, peer->GetDevice ()->GetAddress (), "Wrong MAC address");
+  ArpCache::Entry *entry = cache->Lookup (Ipv4Address ("10.0.0.2"));
+  NS_TEST_ASSERT_MSG_NE (entry, 0, "No entry for the resolved address");
+  NS_TEST_EXPECT_MSG_EQ (entry->IsPermanent (), true, "Resolved entry not permanent");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (cache, Ipv4Address ("10.0.0.9"), 100), false, "Unknown address resolved");
+
+  Simulator::Stop (Seconds (1000));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_requests.size (), 4, "Requests only for the unknown address");
+  NS_TEST_EXPECT_MSG_EQ (entry->IsExpired (), false, "Permanent entry expired");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (cache, Ipv4Address ("10.0.0.2"), 100), true, "Permanent entry not used");
+  Simulator::Destroy ();
+}
+
+void
+ArpCacheTestCase::DoRun (void)
+{
+  CheckRequests ();
+  CheckPendingBytes ();
+  CheckResolveFromChannel ();
+}
+
+static class ArpCacheTestSuite : public TestSuite
+{
+public:
+  ArpCacheTestSuite ()
+    : TestSuite ("arp-cache", UNIT)
+  {
+    AddTestCase (new ArpCacheTestCase ());
+  }
+} g_arpCacheTestSuite;
+
+} // namespace ns3
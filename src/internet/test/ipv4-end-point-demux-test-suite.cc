@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/**
+ * This is the test code for ipv4-end-point-demux.cc
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/random-variable.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/loopback-net-device.h"
+
+namespace ns3 {
+
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  typedef std::vector<Ipv4EndPoint *> EndPoints;
+
+  virtual void DoRun (void);
+  void CheckPriorities (void);
+  void CheckRandom (void);
+  Ptr<Ipv4Interface> CreateInterface (Ipv4InterfaceAddress address);
+  // the lookup of the endpoints in a list, by decreasing exactness.
+  EndPoints LinearLookup (EndPoints const &endPoints,
+                          Ipv4Address daddr, uint16_t dport,
+                          Ipv4Address saddr, uint16_t sport,
+                          Ptr<Ipv4Interface> incomingInterface);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the lookups of the IPv4 endpoint demux")
+{
+}
+
+Ptr<Ipv4Interface>
+Ipv4EndPointDemuxTestCase::CreateInterface (Ipv4InterfaceAddress address)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<LoopbackNetDevice> device = CreateObject<LoopbackNetDevice> ();
+  node->AddDevice (device);
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->SetNode (node);
+  interface->SetDevice (device);
+  interface->AddAddress (address);
+  return interface;
+}
+
+Ipv4EndPointDemuxTestCase::EndPoints
+Ipv4EndPointDemuxTestCase::LinearLookup (EndPoints const &endPoints,
+                                         Ipv4Address daddr, uint16_t dport,
+                                         Ipv4Address saddr, uint16_t sport,
+                                         Ptr<Ipv4Interface> incomingInterface)
+{
+  EndPoints retval1, retval2, retval3, retval4;
+  for (EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      Ipv4EndPoint *endP = *i;
+      if (endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          continue;
+        }
+      bool subnetDirected = false;
+      Ipv4Address incomingInterfaceAddr = daddr;
+      for (uint32_t j = 0; j < incomingInterface->GetNAddresses (); j++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (j);
+          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+            {
+              subnetDirected = true;
+              incomingInterfaceAddr = addr.GetLocal ();
+            }
+        }
+      bool isBroadcast = daddr.IsBroadcast () || subnetDirected;
+      bool localWildcard = endP->GetLocalAddress () == Ipv4Address::GetAny ();
+      bool localExact = endP->GetLocalAddress () == daddr;
+      if (isBroadcast && !localWildcard)
+        {
+          localExact = endP->GetLocalAddress () == incomingInterfaceAddr;
+        }
+      if (!(localExact || localWildcard))
+        {
+          continue;
+        }
+      bool portExact = endP->GetPeerPort () == sport;
+      bool portWildcard = endP->GetPeerPort () == 0;
+      bool addressExact = endP->GetPeerAddress () == saddr;
+      bool addressWildcard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+      if (!(portExact || portWildcard) || !(addressExact || addressWildcard))
+        {
+          continue;
+        }
+      if (localWildcard && portWildcard && addressWildcard)
+        {
+          retval1.push_back (endP);
+        }
+      if ((localExact || (isBroadcast && localWildcard)) && portWildcard && addressWildcard)
+        {
+          retval2.push_back (endP);
+        }
+      if (localWildcard && portExact && addressExact)
+        {
+          retval3.push_back (endP);
+        }
+      if (localExact && portExact && addressExact)
+        {
+          retval4.push_back (endP);
+        }
+    }
+  if (!retval4.empty ()) return retval4;
+  if (!retval3.empty ()) return retval3;
+  if (!retval2.empty ()) return retval2;
+  return retval1;
+}
+
+void
+Ipv4EndPointDemuxTestCase::CheckPriorities (void)
+{
+  Ptr<Ipv4Interface> interface = CreateInterface (Ipv4InterfaceAddress ("10.1.1.1", "255.255.255.0"));
+  Ipv4Address local ("10.1.1.1");
+  Ipv4Address peer ("10.1.1.2");
+  Ipv4EndPointDemux demux;
+
+  Ipv4EndPoint *any = demux.Allocate (80);
+  Ipv4EndPoint *bound = demux.Allocate (local, 80);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80), 0, "Duplicate address and port");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "Port 80 is in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (81), false, "Port 81 is free");
+
+  Ipv4EndPointDemux::EndPoints result = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (result.size (), 1, "Only the endpoint bound to the address");
+  NS_TEST_ASSERT_MSG_EQ (result[0], bound, "Only the endpoint bound to the address");
+  result = demux.Lookup (Ipv4Address ("10.1.1.255"), 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (result.size (), 2, "A broadcast goes to both endpoints");
+  NS_TEST_ASSERT_MSG_EQ (result[0], any, "In the order of allocation");
+  result = demux.Lookup (Ipv4Address ("10.1.1.3"), 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (result.size (), 1, "Only the wildcard endpoint");
+  NS_TEST_ASSERT_MSG_EQ (result[0], any, "Only the wildcard endpoint");
+
+  // connecting an endpoint moves it to the exact table
+  Ipv4EndPoint *connected = demux.Allocate ();
+  uint16_t port = connected->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, port, peer, 1000, interface)[0], connected, "Wildcard match");
+  connected->SetPeer (peer, 1000);
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, port, peer, 1000, interface)[0], connected, "Match all but local");
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, port, peer, 1001, interface).size (), 0, "Wrong peer port");
+  connected->SetLocalAddress (Ipv4Address ("10.1.1.9"));
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, port, peer, 1000, interface).size (), 0, "Wrong local address");
+  Ipv4EndPoint *exact = demux.Allocate (local, port, peer, 1000);
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, port, peer, 1000, interface)[0], exact, "Exact match");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, port, peer, 1000), 0, "Duplicate 4-tuple");
+
+  demux.DeAllocate (bound);
+  result = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (result.size (), 1, "The wildcard endpoint after the deallocation");
+  NS_TEST_ASSERT_MSG_EQ (result[0], any, "The wildcard endpoint after the deallocation");
+  demux.DeAllocate (any);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 is free");
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, 80, peer, 1000, interface).size (), 0, "No endpoint left");
+}
+
+void
+Ipv4EndPointDemuxTestCase::CheckRandom (void)
+{
+  std::vector<Ptr<Ipv4Interface> > interfaces;
+  interfaces.push_back (CreateInterface (Ipv4InterfaceAddress ("10.1.1.1", "255.255.255.0")));
+  interfaces.push_back (CreateInterface (Ipv4InterfaceAddress ("10.2.2.1", "255.255.255.255")));
+  std::vector<Ipv4Address> addresses;
+  addresses.push_back (Ipv4Address::GetAny ());
+  addresses.push_back (Ipv4Address ("10.1.1.1"));
+  addresses.push_back (Ipv4Address ("10.1.1.2"));
+  addresses.push_back (Ipv4Address ("10.1.1.255"));
+  addresses.push_back (Ipv4Address ("10.2.2.1"));
+  addresses.push_back (Ipv4Address ("255.255.255.255"));
+  UniformVariable random;
+
+  Ipv4EndPointDemux demux;
+  EndPoints endPoints;
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      uint32_t action = random.GetInteger (0, 9);
+      Ipv4Address address = addresses[random.GetInteger (0, addresses.size () - 1)];
+      uint16_t port = random.GetInteger (1, 4);
+      if (action == 0 || endPoints.size () < 4)
+        {
+          Ipv4EndPoint *endPoint = random.GetInteger (0, 1) ? demux.Allocate (address, port)
+            : demux.Allocate (address, port, addresses[random.GetInteger (0, 2)], random.GetInteger (0, 2));
+          if (endPoint != 0)
+            {
+              if (random.GetInteger (0, 4) == 0)
+                {
+                  endPoint->BindToNetDevice (interfaces[random.GetInteger (0, 1)]->GetDevice ());
+                }
+              endPoints.push_back (endPoint);
+            }
+        }
+      else if (action == 1)
+        {
+          uint32_t i = random.GetInteger (0, endPoints.size () - 1);
+          demux.DeAllocate (endPoints[i]);
+          endPoints.erase (endPoints.begin () + i);
+        }
+      else if (action == 2)
+        {
+          endPoints[random.GetInteger (0, endPoints.size () - 1)]->SetPeer (address, random.GetInteger (0, 2));
+        }
+      else if (action == 3)
+        {
+          endPoints[random.GetInteger (0, endPoints.size () - 1)]->SetLocalAddress (address);
+        }
+      else
+        {
+          Ipv4Address saddr = addresses[random.GetInteger (0, 2)];
+          uint16_t sport = random.GetInteger (0, 2);
+          Ptr<Ipv4Interface> interface = interfaces[random.GetInteger (0, 1)];
+          EndPoints expected = LinearLookup (endPoints, address, port, saddr, sport, interface);
+          EndPoints result = demux.Lookup (address, port, saddr, sport, interface);
+          NS_TEST_ASSERT_MSG_EQ ((result == expected), true, "Lookup of " << address << ":" << port
+                                 << " from " << saddr << ":" << sport << " at step " << step);
+        }
+    }
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  CheckPriorities ();
+  CheckRandom ();
+}
+
+static class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv4EndPointDemuxTestSuite ()
+    : TestSuite ("ipv4-end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase);
+  }
+} g_ipv4EndPointDemuxTestSuite;
+
+} // namespace ns3
@@ -39,6 +39,9 @@
 #include "ns3/node.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/boolean.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/udp-header.h"
 
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/ipv4-l3-protocol.h"
@@ -49,6 +52,7 @@
 
 #include <string>
 #include <limits>
+#include <vector>
 #include <netinet/in.h>
 
 namespace ns3 {
@@ -400,6 +404,204 @@ Ipv4FragmentationTest::DoRun (void)
     }
 
 
+  Simulator::Destroy ();
+}
+//-----------------------------------------------------------------------------
+class Ipv4ReassemblyTest : public TestCase
+{
+  Ptr<Node> m_node;
+  Ptr<SimpleNetDevice> m_device;
+  std::vector<Ptr<Packet> > m_received;
+  uint32_t m_fragmentsSize;
+  uint32_t m_reassembled;
+  uint32_t m_timedOut;
+  uint32_t m_evicted;
+  uint32_t m_memoryDrops;
+
+public:
+  virtual void DoRun (void);
+  Ipv4ReassemblyTest ();
+
+  void HandleReadServer (Ptr<Socket> socket);
+  void DropTrace (const Ipv4Header &header, Ptr<const Packet> packet,
+                  Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface);
+  static void UpdateCounter (uint32_t *counter, uint32_t oldValue, uint32_t newValue);
+
+  // the bytes of a UDP datagram to port 9 whose payload is filled with the given value.
+  std::vector<uint8_t> CreateDatagram (uint32_t payloadSize, uint8_t fill);
+  void ReceiveFragment (Ipv4Address source, uint16_t id, std::vector<uint8_t> const &datagram,
+                        uint32_t offset, uint32_t size);
+  void CheckReceived (uint32_t index, uint32_t payloadSize, uint8_t fill);
+};
+
+Ipv4ReassemblyTest::Ipv4ReassemblyTest ()
+  : TestCase ("Verify the memory limit and the timeouts of the IPv4 reassembly")
+{
+}
+
+void
+Ipv4ReassemblyTest::HandleReadServer (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while (packet = socket->Recv ())
+    {
+      m_received.push_back (packet);
+    }
+}
+
+void
+Ipv4ReassemblyTest::DropTrace (const Ipv4Header &header, Ptr<const Packet> packet,
+                               Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (reason == Ipv4L3Protocol::DROP_FRAGMENT_MEMORY)
+    {
+      m_memoryDrops++;
+    }
+}
+
+void
+Ipv4ReassemblyTest::UpdateCounter (uint32_t *counter, uint32_t oldValue, uint32_t newValue)
+{
+  *counter = newValue;
+}
+
+std::vector<uint8_t>
+Ipv4ReassemblyTest::CreateDatagram (uint32_t payloadSize, uint8_t fill)
+{
+  std::vector<uint8_t> payload (payloadSize, fill);
+  Ptr<Packet> p = Create<Packet> (&payload[0], payloadSize);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (1234);
+  udpHeader.SetDestinationPort (9);
+  p->AddHeader (udpHeader);
+  std::vector<uint8_t> datagram (p->GetSize ());
+  p->CopyData (&datagram[0], datagram.size ());
+  return datagram;
+}
+
+void
+Ipv4ReassemblyTest::ReceiveFragment (Ipv4Address source, uint16_t id, std::vector<uint8_t> const &datagram,
+                                     uint32_t offset, uint32_t size)
+{
+  Ptr<Packet> fragment = Create<Packet> (&datagram[offset], size);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (source);
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  ipHeader.SetIdentification (id);
+  ipHeader.SetTtl (64);
+  ipHeader.SetPayloadSize (size);
+  ipHeader.SetFragmentOffset (offset);
+  if (offset + size < datagram.size ())
+    {
+      ipHeader.SetMoreFragments ();
+    }
+  else
+    {
+      ipHeader.SetLastFragment ();
+    }
+  fragment->AddHeader (ipHeader);
+  m_node->GetObject<Ipv4L3Protocol> ()->Receive (m_device, fragment, Ipv4L3Protocol::PROT_NUMBER,
+                                                  m_device->GetBroadcast (), m_device->GetAddress (),
+                                                  NetDevice::PACKET_HOST);
+}
+
+void
+Ipv4ReassemblyTest::CheckReceived (uint32_t index, uint32_t payloadSize, uint8_t fill)
+{
+  NS_TEST_ASSERT_MSG_LT (index, m_received.size (), "Packet not reassembled");
+  Ptr<Packet> packet = m_received[index];
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), payloadSize, "Packet size not correct");
+  std::vector<uint8_t> data (payloadSize);
+  packet->CopyData (&data[0], payloadSize);
+  NS_TEST_EXPECT_MSG_EQ ((data == std::vector<uint8_t> (payloadSize, fill)), true, "Packet content differs");
+}
+
+void
+Ipv4ReassemblyTest::DoRun (void)
+{
+  m_node = CreateObject<Node> ();
+  AddInternetStack (m_node);
+  m_device = CreateObject<SimpleNetDevice> ();
+  m_device->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  m_device->SetChannel (CreateObject<SimpleChannel> ());
+  m_node->AddDevice (m_device);
+  Ptr<Ipv4L3Protocol> ipv4 = m_node->GetObject<Ipv4L3Protocol> ();
+  uint32_t interface = ipv4->AddInterface (m_device);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask (0xffff0000U)));
+  ipv4->SetUp (interface);
+  ipv4->SetAttribute ("FragmentMemoryLimit", UintegerValue (3000));
+
+  m_fragmentsSize = 0;
+  m_reassembled = 0;
+  m_timedOut = 0;
+  m_evicted = 0;
+  m_memoryDrops = 0;
+  ipv4->TraceConnectWithoutContext ("FragmentsSize", MakeBoundCallback (&Ipv4ReassemblyTest::UpdateCounter, &m_fragmentsSize));
+  ipv4->TraceConnectWithoutContext ("ReassembledPackets", MakeBoundCallback (&Ipv4ReassemblyTest::UpdateCounter, &m_reassembled));
+  ipv4->TraceConnectWithoutContext ("FragmentsTimedOut", MakeBoundCallback (&Ipv4ReassemblyTest::UpdateCounter, &m_timedOut));
+  ipv4->TraceConnectWithoutContext ("FragmentsEvicted", MakeBoundCallback (&Ipv4ReassemblyTest::UpdateCounter, &m_evicted));
+  ipv4->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv4ReassemblyTest::DropTrace, this));
+
+  Ptr<Socket> socket = Socket::CreateSocket (m_node, TypeId::LookupByName ("ns3::UdpSocketFactory"));
+  socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  socket->SetRecvCallback (MakeCallback (&Ipv4ReassemblyTest::HandleReadServer, this));
+
+  Ipv4Address a ("10.0.0.2");
+  Ipv4Address b ("10.0.0.3");
+  Ipv4Address c ("10.0.0.4");
+  std::vector<uint8_t> da = CreateDatagram (2000, 'a');
+  std::vector<uint8_t> db = CreateDatagram (2000, 'b');
+  std::vector<uint8_t> dc = CreateDatagram (2000, 'c');
+
+  // The fragments of two packets with the same identification from two
+  // sources, interleaved, overlapping and duplicated.
+  ReceiveFragment (a, 7, da, 800, 800);
+  ReceiveFragment (b, 7, db, 0, 1000);
+  ReceiveFragment (a, 7, da, 0, 1000);
+  ReceiveFragment (a, 7, da, 0, 1000);
+  NS_TEST_EXPECT_MSG_EQ (m_fragmentsSize, 2600, "Overlapping bytes buffered twice");
+  ReceiveFragment (b, 7, db, 1000, 1008);
+  ReceiveFragment (a, 7, da, 1600, 408);
+  // the endpoints forward the packets up in scheduled events.
+  Simulator::Stop (Seconds (0));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), 2, "Packets not reassembled");
+  CheckReceived (0, 2000, 'b');
+  CheckReceived (1, 2000, 'a');
+  NS_TEST_EXPECT_MSG_EQ (m_reassembled, 2, "Wrong count of reassembled packets");
+  NS_TEST_EXPECT_MSG_EQ (m_fragmentsSize, 0, "Fragments left after the reassembly");
+
+  // Beyond the memory limit, the oldest packet is dropped.
+  ReceiveFragment (a, 8, da, 0, 1000);
+  ReceiveFragment (b, 8, db, 0, 1000);
+  ReceiveFragment (c, 8, dc, 0, 1000);
+  NS_TEST_EXPECT_MSG_EQ (m_evicted, 0, "Packet dropped within the memory limit");
+  ReceiveFragment (c, 8, dc, 1000, 800);
+  NS_TEST_EXPECT_MSG_EQ (m_evicted, 1, "Memory limit not enforced");
+  NS_TEST_EXPECT_MSG_EQ (m_memoryDrops, 1, "Eviction not traced as a drop");
+  NS_TEST_EXPECT_MSG_EQ (m_fragmentsSize, 2800, "Wrong size after the eviction");
+  ReceiveFragment (b, 8, db, 1000, 1008);
+  ReceiveFragment (c, 8, dc, 1800, 208);
+  ReceiveFragment (a, 8, da, 1000, 1008);
+  Simulator::Stop (Seconds (0));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), 4, "Packets kept within the limit not reassembled");
+  CheckReceived (2, 2000, 'b');
+  CheckReceived (3, 2000, 'c');
+  NS_TEST_EXPECT_MSG_EQ (m_fragmentsSize, 1008, "The end of the evicted packet should wait alone");
+
+  // The fragments left time out in the order they were received.
+  Simulator::Schedule (Seconds (10), &Ipv4ReassemblyTest::ReceiveFragment, this, b, 9, db, 0, 1000);
+  Simulator::Stop (Seconds (35));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_timedOut, 1, "The first packet did not time out");
+  NS_TEST_EXPECT_MSG_EQ (m_fragmentsSize, 1000, "Wrong size after the first timeout");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_timedOut, 2, "The second packet did not time out");
+  NS_TEST_EXPECT_MSG_EQ (m_fragmentsSize, 0, "Fragments left after the timeouts");
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), 4, "Incomplete packet delivered");
+
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
@@ -409,6 +611,7 @@ public:
   Ipv4FragmentationTestSuite () : TestSuite ("ipv4-fragmentation", UNIT)
   {
     AddTestCase (new Ipv4FragmentationTest);
+    AddTestCase (new Ipv4ReassemblyTest);
   }
 } g_ipv4fragmentationTestSuite;
 
@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/**
+ * This is the test code for ipv4-route-trie.cc
+ */
+
+#include <list>
+#include "ns3/test.h"
+#include "ns3/random-variable.h"
+#include "ns3/ipv4-route-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+
+namespace ns3 {
+
+class Ipv4RouteTrieTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieTestCase ();
+
+private:
+  typedef std::list<std::pair<Ipv4RoutingTableEntry *, uint32_t> > Routes;
+
+  virtual void DoRun (void);
+  void CheckTies (void);
+  void CheckRandom (void);
+  Ipv4RoutingTableEntry * AddRoute (Routes &routes, Ipv4RouteTrie &trie, Ipv4Address network,
+                                    Ipv4Mask mask, uint32_t interface, uint32_t metric);
+  // the lookup of Ipv4StaticRouting before the trie.
+  Ipv4RoutingTableEntry * LinearLookup (Routes const &routes, Ipv4Address dest,
+                                        bool any, uint32_t interface);
+};
+
+Ipv4RouteTrieTestCase::Ipv4RouteTrieTestCase ()
+  : TestCase ("Check the longest prefix match of the IPv4 route trie")
+{
+}
+
+Ipv4RoutingTableEntry *
+Ipv4RouteTrieTestCase::AddRoute (Routes &routes, Ipv4RouteTrie &trie, Ipv4Address network,
+                                 Ipv4Mask mask, uint32_t interface, uint32_t metric)
+{
+  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+  *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network, mask, interface);
+  routes.push_back (std::make_pair (route, metric));
+  trie.Insert (route, metric);
+  return route;
+}
+
+Ipv4RoutingTableEntry *
+Ipv4RouteTrieTestCase::LinearLookup (Routes const &routes, Ipv4Address dest,
+                                     bool any, uint32_t interface)
+{
+  Ipv4RoutingTableEntry *result = 0;
+  uint16_t longest_mask = 0;
+  uint32_t shortest_metric = 0xffffffff;
+  for (Routes::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      Ipv4RoutingTableEntry *j = i->first;
+      uint32_t metric = i->second;
+      Ipv4Mask mask = j->GetDestNetworkMask ();
+      uint16_t masklen = mask.GetPrefixLength ();
+      if (!mask.IsMatch (dest, j->GetDestNetwork ()))
+        {
+          continue;
+        }
+      if (!any && j->GetInterface () != interface)
+        {
+          continue;
+        }
+      if (masklen < longest_mask)
+        {
+          continue;
+        }
+      if (masklen > longest_mask)
+        {
+          shortest_metric = 0xffffffff;
+        }
+      longest_mask = masklen;
+      if (metric > shortest_metric)
+        {
+          continue;
+        }
+      shortest_metric = metric;
+      result = j;
+    }
+  return result;
+}
+
+void
+Ipv4RouteTrieTestCase::CheckTies (void)
+{
+  Routes routes;
+  Ipv4RouteTrie trie;
+  Ipv4RoutingTableEntry *def = AddRoute (routes, trie, Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), 1, 0);
+  Ipv4RoutingTableEntry *wide = AddRoute (routes, trie, Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 1, 5);
+  Ipv4RoutingTableEntry *first = AddRoute (routes, trie, Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 1, 3);
+  Ipv4RoutingTableEntry *cheap = AddRoute (routes, trie, Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 2, 1);
+  Ipv4RoutingTableEntry *last = AddRoute (routes, trie, Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 3, 1);
+
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.7")), last, "Lowest metric, last added");
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.7"), 2), cheap, "Only the routes of interface 2");
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.7"), 1), first, "Longest prefix of interface 1");
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.3.7")), wide, "Shorter prefix");
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.2.3.7")), def, "Default route");
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.2.3.7"), 2), 0, "No route on interface 2");
+
+  trie.Remove (last);
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.7")), cheap, "After the removal of the last route");
+  trie.Remove (cheap);
+  trie.Remove (first);
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.7")), wide, "After the removal of the prefix");
+  trie.Remove (def);
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.2.3.7")), 0, "After the removal of the default route");
+  for (Routes::iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      delete i->first;
+    }
+}
+
+void
+Ipv4RouteTrieTestCase::CheckRandom (void)
+{
+  // few prefixes and metrics in a small part of the address space, so that
+  // the routes nest, share their prefixes and tie on their metrics.
+  UniformVariable random;
+  Routes routes;
+  Ipv4RouteTrie trie;
+  for (uint32_t step = 0; step < 4000; step++)
+    {
+      if (routes.size () < 100 || random.GetInteger (0, 2) != 0)
+        {
+          uint32_t length = random.GetInteger (0, 32);
+          uint32_t mask = length == 0 ? 0 : 0xffffffff << (32 - length);
+          if (random.GetInteger (0, 20) == 0)
+            {
+              // a non-contiguous mask
+              mask = 0xff00ff00;
+            }
+          uint32_t network = (0x0a000000 | random.GetInteger (0, 0xffff)) << random.GetInteger (0, 8);
+          AddRoute (routes, trie, Ipv4Address (network), Ipv4Mask (mask),
+                    random.GetInteger (0, 3), random.GetInteger (0, 2));
+        }
+      else
+        {
+          Routes::iterator i = routes.begin ();
+          std::advance (i, random.GetInteger (0, routes.size () - 1));
+          trie.Remove (i->first);
+          delete i->first;
+          routes.erase (i);
+        }
+      for (uint32_t k = 0; k < 4; k++)
+        {
+          Ipv4Address dest ((0x0a000000 | random.GetInteger (0, 0xffff)) << random.GetInteger (0, 8));
+          if (random.GetInteger (0, 1) == 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (trie.Lookup (dest), LinearLookup (routes, dest, true, 0),
+                                     "Lookup of " << dest << " after " << step << " changes");
+            }
+          else
+            {
+              uint32_t interface = random.GetInteger (0, 3);
+              NS_TEST_ASSERT_MSG_EQ (trie.Lookup (dest, interface), LinearLookup (routes, dest, false, interface),
+                                     "Lookup of " << dest << " on interface " << interface
+                                     << " after " << step << " changes");
+            }
+        }
+    }
+  for (Routes::iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      trie.Remove (i->first);
+      delete i->first;
+    }
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.0.0.1")), 0, "Routes left in the trie");
+}
+
+void
+Ipv4RouteTrieTestCase::DoRun (void)
+{
+  CheckTies ();
+  CheckRandom ();
+}
+
+static class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite ()
+    : TestSuite ("ipv4-route-trie", UNIT)
+  {
+    AddTestCase (new Ipv4RouteTrieTestCase ());
+  }
+} g_ipv4RouteTrieTestSuite;
+
+} // namespace ns3
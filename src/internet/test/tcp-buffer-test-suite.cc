@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+/**
+ * This is the test code for tcp-tx-buffer.cc and tcp-rx-buffer.cc
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+
+namespace ns3 {
+
+// the byte of the stream at a sequence number.
+static uint8_t
+GetStreamByte (uint32_t seq)
+{
+  return (seq * 7 + (seq >> 8)) & 0xff;
+}
+
+static Ptr<Packet>
+CreateStreamPacket (uint32_t seq, uint32_t size)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = GetStreamByte (seq + i);
+    }
+  return Create<Packet> (size > 0 ? &data[0] : 0, size);
+}
+
+// the offset of the first wrong byte of the packet, or its size.
+static uint32_t
+CheckStreamPacket (Ptr<Packet> p, uint32_t seq)
+{
+  std::vector<uint8_t> data (p->GetSize () + 1);
+  p->CopyData (&data[0], p->GetSize ());
+  uint32_t i = 0;
+  while (i < p->GetSize () && data[i] == GetStreamByte (seq + i))
+    {
+      i++;
+    }
+  return i;
+}
+
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase ()
+  : TestCase ("Check the segments of the TCP send buffer")
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun (void)
+{
+  UniformVariable random;
+  uint32_t isn = 0xfffff000; // the sequence numbers wrap during the test
+  Ptr<TcpTxBuffer> buffer = CreateObject<TcpTxBuffer> (0);
+  buffer->SetMaxBufferSize (20000);
+  // data written before the connection is established.
+  uint32_t written = 0;
+  Ptr<Packet> p = CreateStreamPacket (isn + written, 300);
+  NS_TEST_ASSERT_MSG_EQ (buffer->Add (p), true, "Could not add the first packet");
+  written += 300;
+  buffer->SetHeadSequence (SequenceNumber32 (isn));
+
+  uint32_t acked = 0;
+  for (uint32_t step = 0; step < 2000; step++)
+    {
+      uint32_t size = random.GetInteger (1, 1500);
+      if (buffer->Available () >= size)
+        {
+          NS_TEST_ASSERT_MSG_EQ (buffer->Add (CreateStreamPacket (isn + written, size)), true,
+                                 "Could not add a packet");
+          written += size;
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer->Size (), written - acked, "Wrong size");
+      NS_TEST_ASSERT_MSG_EQ (buffer->TailSequence (), SequenceNumber32 (isn + written), "Wrong tail");
+
+      uint32_t offset = random.GetInteger (0, written - acked);
+      uint32_t length = random.GetInteger (0, 3000);
+      Ptr<Packet> segment = buffer->CopyFromSequence (length, SequenceNumber32 (isn + acked + offset));
+      uint32_t expected = std::min (length, written - acked - offset);
+      NS_TEST_ASSERT_MSG_EQ (segment->GetSize (), expected, "Wrong segment size at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (CheckStreamPacket (segment, isn + acked + offset), expected,
+                             "Wrong segment data at step " << step);
+
+      if (random.GetInteger (0, 2) == 0)
+        {
+          acked += random.GetInteger (0, written - acked);
+          buffer->DiscardUpTo (SequenceNumber32 (isn + acked));
+          NS_TEST_ASSERT_MSG_EQ (buffer->HeadSequence (), SequenceNumber32 (isn + acked), "Wrong head");
+        }
+    }
+  // the acknowledgement of a FIN, one byte after the data.
+  buffer->DiscardUpTo (SequenceNumber32 (isn + written + 1));
+  NS_TEST_ASSERT_MSG_EQ (buffer->Size (), 0, "Data left after the FIN");
+  NS_TEST_ASSERT_MSG_EQ (buffer->HeadSequence (), SequenceNumber32 (isn + written + 1), "Wrong head after the FIN");
+}
+
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("Check the reordering of the TCP receive buffer")
+{
+}
+
+void
+TcpRxBufferTestCase::DoRun (void)
+{
+  UniformVariable random;
+  uint32_t isn = 0xffffe000;
+  uint32_t window = 16000;
+  Ptr<TcpRxBuffer> buffer = CreateObject<TcpRxBuffer> (0);
+  buffer->SetMaxBufferSize (window);
+  buffer->SetNextRxSequence (SequenceNumber32 (isn));
+
+  // which bytes of the window after the last read byte were received.
+  std::vector<bool> received (window, false);
+  uint32_t read = 0;
+  for (uint32_t step = 0; step < 5000; step++)
+    {
+      // segments which overlap each other and the read data, in the window.
+      uint32_t size = random.GetInteger (1, 1500);
+      uint32_t start = read + random.GetInteger (0, window - size) - random.GetInteger (0, 500);
+      TcpHeader header;
+      header.SetSequenceNumber (SequenceNumber32 (isn + start));
+      buffer->Add (CreateStreamPacket (isn + start, size), header);
+      for (uint32_t i = start; i != start + size; i++)
+        {
+          if (i - read < window)
+            {
+              received[i - read] = true;
+            }
+        }
+      uint32_t available = 0;
+      while (available < window && received[available])
+        {
+          available++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer->NextRxSequence (), SequenceNumber32 (isn + read + available),
+                             "Wrong next sequence at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (buffer->Available (), available, "Wrong available bytes at step " << step);
+
+      if (random.GetInteger (0, 3) == 0)
+        {
+          uint32_t length = random.GetInteger (1, 4000);
+          Ptr<Packet> data = buffer->Extract (length);
+          uint32_t expected = std::min (length, available);
+          uint32_t size = data == 0 ? 0 : data->GetSize ();
+          NS_TEST_ASSERT_MSG_EQ (size, expected, "Wrong extracted size at step " << step);
+          if (data != 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (CheckStreamPacket (data, isn + read), expected,
+                                     "Wrong extracted data at step " << step);
+            }
+          received.erase (received.begin (), received.begin () + expected);
+          received.resize (window, false);
+          read += expected;
+        }
+    }
+}
+
+static class TcpBufferTestSuite : public TestSuite
+{
+public:
+  TcpBufferTestSuite ()
+    : TestSuite ("tcp-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferTestCase ());
+    AddTestCase (new TcpRxBufferTestCase ());
+  }
+} g_tcpBufferTestSuite;
+
+} // namespace ns3
@@ -1,7 +1,3 @@
-
-#define NS_LOG_APPEND_CONTEXT                                   \
-  if (m_ipv4) { std::clog << "[node " << m_ipv4->GetObject<Node> ()->GetId () << "] "; } 
-
 #include "god.h"
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
@@ -46,23 +42,22 @@ GodLocationService::GetPosition(Ipv4Address adr)
   uint32_t i;
   Ptr<Node> node;
   
-  NS_LOG_UNCOND("::GODLS:: Obtaining position of " << adr);
+  NS_LOG_FUNCTION (this << adr);
 
   for(i = 0; i < n; i++)
   {
 	  node = NodeList().GetNode (i);
 	  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
 
-	  //NS_LOG_UNCOND("Have " << ipv4->GetAddress (1, 0).GetLocal ());
 	  if(ipv4->GetAddress (1, 0).GetLocal () == adr)
 	  {
-		  NS_LOG_UNCOND("::GODLS:: Position: <" << (*node->GetObject<MobilityModel>()).GetPosition ().x
-				  << "," << (*node->GetObject<MobilityModel>()).GetPosition ().y << ">");
-		  return (*node->GetObject<MobilityModel>()).GetPosition ();
+		  Vector position = node->GetObject<MobilityModel> ()->GetPosition ();
+		  NS_LOG_LOGIC ("position of " << adr << " <" << position.x << "," << position.y << ">");
+		  return position;
 	  }
   }
   Vector v;
-  NS_LOG_UNCOND("::GODLS:: Position: <" << v.x << "," << v.y << ">");
+  NS_LOG_LOGIC ("no node with address " << adr);
   return v;
 }
   
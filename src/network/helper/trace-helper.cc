@@ -201,6 +201,18 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<BinaryTraceFile>
+AsciiTraceHelper::CreateBinaryFile (std::string filename, bool compress)
+{
+  NS_LOG_FUNCTION (filename << compress);
+
+  //
+  // As with the ascii streams, ownership passes to the callbacks bound to the
+  // file.  The last block is written out when the last of them goes away.
+  //
+  return Create<BinaryTraceFile> (filename, compress);
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -643,5 +655,63 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
     }
 }
 
+//
+// Default implementation for device helpers that do not know how to produce
+// binary traces.
+//
+void
+AsciiTraceHelperForDevice::EnableBinaryInternal (Ptr<BinaryTraceSink> sink, Ptr<NetDevice> nd)
+{
+  NS_LOG_WARN ("AsciiTraceHelperForDevice::EnableBinaryInternal(): Binary tracing not supported for device " << nd);
+}
+
+//
+// Public API
+//
+void
+AsciiTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd)
+{
+  NS_ABORT_MSG_IF (file == 0, "AsciiTraceHelperForDevice::EnableBinary(): Null binary trace file");
+  Ptr<BinaryTraceSink> sink = Create<BinaryTraceSink> (file, nd->GetNode ()->GetId (), nd->GetIfIndex ());
+  EnableBinaryInternal (sink, nd);
+}
+
+//
+// Public API
+//
+void
+AsciiTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, NetDeviceContainer d)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnableBinary (file, *i);
+    }
+}
+
+//
+// Public API
+//
+void
+AsciiTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, NodeContainer n)
+{
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          EnableBinary (file, node->GetDevice (j));
+        }
+    }
+}
+
+//
+// Public API
+//
+void
+AsciiTraceHelperForDevice::EnableBinaryAll (Ptr<BinaryTraceFile> file)
+{
+  EnableBinary (file, NodeContainer::GetGlobal ());
+}
+
 } // namespace ns3
 
@@ -25,6 +25,7 @@
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/binary-trace-file.h"
 
 namespace ns3 {
 
@@ -155,6 +156,21 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create a binary trace file.
+   *
+   * Binary traces record a fixed set of fields per event (time, node, device,
+   * event type, packet uid and size) instead of a printed packet, and are
+   * written in blocks by a background thread.  They are much smaller and
+   * cheaper to produce than ascii traces; the binary-trace-to-ascii program
+   * converts them back to text.  The same file is meant to be shared by all
+   * of the devices being traced.
+   *
+   * @param filename The name of the file to create.
+   * @param compress If true, delta/varint encode each block.
+   */
+  Ptr<BinaryTraceFile> CreateBinaryFile (std::string filename, bool compress = true);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -571,6 +587,54 @@ public:
    */
   void EnableAscii (Ptr<OutputStreamWrapper> stream, uint32_t nodeid, uint32_t deviceid);
 
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   * @internal
+   *
+   * The implementation is expected to connect the methods of the provided
+   * sink, which already carries the node and device identifiers, to the
+   * trace sources it would use for ascii tracing.  The default 
+   * implementation does not know about any device and does nothing.
+   *
+   * @param sink The binary trace sink bound to this device.
+   * @param nd Net device for which you want to enable tracing
+   */
+  virtual void EnableBinaryInternal (Ptr<BinaryTraceSink> sink, Ptr<NetDevice> nd);
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * @param file The binary trace file to write to.
+   * @param nd Net device for which you want to enable tracing.
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd);
+
+  /**
+   * @brief Enable binary trace output on each device in the container which 
+   * is of the appropriate type.
+   *
+   * @param file The binary trace file to write to.
+   * @param d container of devices
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, NetDeviceContainer d);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the 
+   * appropriate type) in the nodes provided in the container.
+   *
+   * @param file The binary trace file to write to.
+   * @param n container of nodes.
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, NodeContainer n);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the set of all nodes created in the simulation.
+   *
+   * @param file The binary trace file to write to.
+   */
+  void EnableBinaryAll (Ptr<BinaryTraceFile> file);
+
 private:
   /**
    * @internal Avoid code duplication.
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Write a known sequence of events and check that the reader returns exactly
+// the same events, across several blocks and a partial last block.
+// ===========================================================================
+class BinaryTraceRoundTripTestCase : public TestCase
+{
+public:
+  BinaryTraceRoundTripTestCase (bool compress);
+  virtual ~BinaryTraceRoundTripTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  bool m_compress;
+  std::string m_testFilename;
+};
+
+BinaryTraceRoundTripTestCase::BinaryTraceRoundTripTestCase (bool compress)
+  : TestCase (compress ? "Check compressed BinaryTraceFile round trip" :
+              "Check raw BinaryTraceFile round trip"),
+    m_compress (compress)
+{
+}
+
+BinaryTraceRoundTripTestCase::~BinaryTraceRoundTripTestCase ()
+{
+}
+
+void
+BinaryTraceRoundTripTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".btr");
+}
+
+void
+BinaryTraceRoundTripTestCase::DoTeardown (void)
+{
+  remove (m_testFilename.c_str ());
+}
+
+void
+BinaryTraceRoundTripTestCase::DoRun (void)
+{
+  const uint32_t blockRecords = 64;
+  const uint32_t total = 1000;
+  std::vector<BinaryTraceFile::Record> expected;
+
+  {
+    Ptr<BinaryTraceFile> file = Create<BinaryTraceFile> (m_testFilename, m_compress, blockRecords);
+    NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Unable to create " << m_testFilename);
+
+    static const uint8_t events[] = { BinaryTraceFile::ENQUEUE, BinaryTraceFile::DEQUEUE,
+                                      BinaryTraceFile::TRANSMIT, BinaryTraceFile::RECEIVE,
+                                      BinaryTraceFile::DROP };
+    for (uint32_t i = 0; i < total; ++i)
+      {
+        BinaryTraceFile::Record r;
+        // Times are not strictly monotonic across devices, make sure
+        // negative deltas survive.
+        r.time = 1000000 * (int64_t)i - ((i % 3) ? 0 : 500000);
+        r.node = i % 300;
+        r.device = i % 2;
+        r.event = events[i % 5];
+        r.uid = (i % 7) ? 10 * i : 3;
+        r.size = 64 + (i * 37) % 1500;
+        expected.push_back (r);
+        file->Write (NanoSeconds (r.time), r.node, r.device, r.event, r.uid, r.size);
+      }
+    NS_TEST_ASSERT_MSG_EQ (file->GetRecordCount (), total, "Unexpected record count");
+    // The file is flushed and closed when the last reference goes away.
+  }
+
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (m_testFilename), true, "Unable to open " << m_testFilename);
+
+  std::vector<BinaryTraceFile::Record> block;
+  uint32_t got = 0;
+  uint32_t blocks = 0;
+  while (reader.ReadBlock (block))
+    {
+      ++blocks;
+      for (uint32_t i = 0; i < block.size (); ++i, ++got)
+        {
+          NS_TEST_ASSERT_MSG_LT (got, total, "Too many records read back");
+          const BinaryTraceFile::Record &e = expected[got];
+          NS_TEST_ASSERT_MSG_EQ (block[i].time, e.time, "Time mismatch at record " << got);
+          NS_TEST_ASSERT_MSG_EQ (block[i].node, e.node, "Node mismatch at record " << got);
+          NS_TEST_ASSERT_MSG_EQ (block[i].device, e.device, "Device mismatch at record " << got);
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t)block[i].event, (uint32_t)e.event, "Event mismatch at record " << got);
+          NS_TEST_ASSERT_MSG_EQ (block[i].uid, e.uid, "Uid mismatch at record " << got);
+          NS_TEST_ASSERT_MSG_EQ (block[i].size, e.size, "Size mismatch at record " << got);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (got, total, "Not all records read back");
+  NS_TEST_ASSERT_MSG_EQ (blocks, (total + blockRecords - 1) / blockRecords, "Unexpected number of blocks");
+}
+
+// ===========================================================================
+// Corrupt the record count of a block and check that the reader rejects the
+// block instead of allocating the records it claims.
+// ===========================================================================
+class BinaryTraceCorruptBlockTestCase : public TestCase
+{
+public:
+  BinaryTraceCorruptBlockTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceCorruptBlockTestCase::BinaryTraceCorruptBlockTestCase ()
+  : TestCase ("Check that BinaryTraceReader rejects a corrupt block header")
+{
+}
+
+void
+BinaryTraceCorruptBlockTestCase::DoRun (void)
+{
+  std::string testFilename = CreateTempDirFilename ("corrupt.btr");
+  {
+    Ptr<BinaryTraceFile> file = Create<BinaryTraceFile> (testFilename, true, 16);
+    for (uint32_t i = 0; i < 10; ++i)
+      {
+        file->Write (NanoSeconds (i), 1, 0, BinaryTraceFile::TRANSMIT, i, 100);
+      }
+  }
+
+  // the record count follows the magic of the first block, after the
+  // 16 bytes of the file header.
+  FILE *f = fopen (testFilename.c_str (), "r+b");
+  NS_TEST_ASSERT_MSG_NE (f, 0, "Unable to open " << testFilename);
+  fseek (f, 16 + 4, SEEK_SET);
+  const uint8_t n[4] = { 0xff, 0xff, 0xff, 0x7f };
+  fwrite (n, 1, sizeof (n), f);
+  fclose (f);
+
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (testFilename), true, "Unable to open " << testFilename);
+  std::vector<BinaryTraceFile::Record> block;
+  NS_TEST_EXPECT_MSG_EQ (reader.ReadBlock (block), false, "Corrupt block accepted");
+  NS_TEST_EXPECT_MSG_EQ (block.size (), 0, "Records returned for a corrupt block");
+  remove (testFilename.c_str ());
+}
+
+class BinaryTraceFileTestSuite : public TestSuite
+{
+public:
+  BinaryTraceFileTestSuite ();
+};
+
+BinaryTraceFileTestSuite::BinaryTraceFileTestSuite ()
+  : TestSuite ("binary-trace-file", UNIT)
+{
+  AddTestCase (new BinaryTraceRoundTripTestCase (false));
+  AddTestCase (new BinaryTraceRoundTripTestCase (true));
+  AddTestCase (new BinaryTraceCorruptBlockTestCase ());
+}
+
+static BinaryTraceFileTestSuite binaryTraceFileTestSuite;
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <sstream>
 #include <cstring>
+#include <vector>
 
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
@@ -1101,6 +1102,99 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that buffered and asynchronous writes produce a file
+// identical to the one written through.
+// ===========================================================================
+class BufferedWriteTestCase : public TestCase
+{
+public:
+  BufferedWriteTestCase (bool async);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_async;
+};
+
+BufferedWriteTestCase::BufferedWriteTestCase (bool async)
+  : TestCase (async ? "Check that asynchronous PcapFile writes match direct writes" :
+              "Check that buffered PcapFile writes match direct writes"),
+    m_async (async)
+{
+}
+
+void
+BufferedWriteTestCase::DoRun (void)
+{
+  std::string known = CreateDataDirFilename ("known.pcap");
+  std::string direct = CreateTempDirFilename ("direct.pcap");
+  std::string buffered = CreateTempDirFilename ("buffered.pcap");
+
+  PcapFile in;
+  in.Open (known, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (" << known << ", \"std::ios::in\") returns error");
+
+  PcapFile out1;
+  out1.Open (direct, std::ios::out);
+  out1.Init (in.GetDataLinkType ());
+  PcapFile out2;
+  out2.SetWriteBuffer (1, m_async);
+  out2.Open (buffered, std::ios::out);
+  out2.Init (in.GetDataLinkType ());
+
+  uint8_t data[8192];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  std::vector<PacketEntry> packets;
+  std::vector<std::vector<uint8_t> > payloads;
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      in.Read (data, sizeof(data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Read() of known good pcap file returns error");
+      PacketEntry e;
+      e.tsSec = tsSec;
+      e.tsUsec = tsUsec;
+      e.inclLen = inclLen;
+      e.origLen = origLen;
+      packets.push_back (e);
+      payloads.push_back (std::vector<uint8_t> (data, data + readLen));
+    }
+  in.Close ();
+
+  //
+  // The batches are one page long, so writing the known packets many times
+  // over hands a good number of batches to the writer.  The large record does
+  // not fit in a batch at all and has to be written through, in order.
+  //
+  memset (data, 0x5a, sizeof(data));
+  for (uint32_t round = 0; round < 50; ++round)
+    {
+      for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+        {
+          uint32_t sec = packets[i].tsSec + round;
+          out1.Write (sec, packets[i].tsUsec, &payloads[i][0], packets[i].inclLen);
+          out2.Write (sec, packets[i].tsUsec, &payloads[i][0], packets[i].inclLen);
+        }
+      if (round == 25)
+        {
+          out1.Write (100, 0, data, sizeof(data));
+          out2.Write (100, 0, data, sizeof(data));
+        }
+    }
+  // the writer thread may still be writing a batch.
+  out2.Flush ();
+  NS_TEST_ASSERT_MSG_EQ (out2.Fail (), false, "Buffered Write must not fail");
+  out1.Close ();
+  out2.Close ();
+
+  uint32_t sec (0), usec (0);
+  bool diff = PcapFile::Diff (direct, buffered, sec, usec);
+  NS_TEST_EXPECT_MSG_EQ (diff, false, "Buffered file differs at " << sec << "." << usec);
+
+  remove (direct.c_str ());
+  remove (buffered.c_str ());
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1118,6 +1212,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase);
   AddTestCase (new ReadFileTestCase);
   AddTestCase (new DiffTestCase);
+  AddTestCase (new BufferedWriteTestCase (false));
+  AddTestCase (new BufferedWriteTestCase (true));
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
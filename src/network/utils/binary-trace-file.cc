@@ -0,0 +1,632 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif
+
+#include "binary-trace-file.h"
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+namespace ns3 {
+
+static const char BTRC_MAGIC[8] = { 'n', 's', '3', 'b', 't', 'r', 'c', 0 };
+static const uint16_t BTRC_VERSION = 1;
+static const uint16_t BTRC_FLAG_COMPRESSED = 0x0001;
+static const uint32_t BTRC_BLOCK_MAGIC = 0x4b4c4254;  /* "TBLK" */
+static const uint32_t BTRC_BLOCK_HEADER_SIZE = 16;
+/* bounds the memory a reader allocates for a block */
+static const uint32_t BTRC_MAX_BLOCK_RECORDS = 1 << 24;
+
+enum BlockEncoding {
+  ENCODING_RAW = 0,
+  ENCODING_DELTA_VARINT = 1
+};
+
+/* How long the writer sleeps between checks of its stop flag, in ns. */
+static const uint64_t WRITER_POLL_NS = 100000000;
+
+//
+// Little-endian fixed width and LEB128 varint encoders.  Signed deltas are
+// zigzag encoded so that small negative values stay small.
+//
+static void
+PutU8 (std::vector<uint8_t> &out, uint8_t v)
+{
+  out.push_back (v);
+}
+
+static void
+PutFixed (std::vector<uint8_t> &out, uint64_t v, uint32_t bytes)
+{
+  for (uint32_t i = 0; i < bytes; ++i)
+    {
+      out.push_back (static_cast<uint8_t> (v >> (8 * i)));
+    }
+}
+
+static void
+PutVarint (std::vector<uint8_t> &out, uint64_t v)
+{
+  while (v >= 0x80)
+    {
+      out.push_back (static_cast<uint8_t> (v | 0x80));
+      v >>= 7;
+    }
+  out.push_back (static_cast<uint8_t> (v));
+}
+
+static uint64_t
+ZigZag (int64_t v)
+{
+  return (static_cast<uint64_t> (v) << 1) ^ static_cast<uint64_t> (v >> 63);
+}
+
+static int64_t
+UnZigZag (uint64_t v)
+{
+  return static_cast<int64_t> (v >> 1) ^ -static_cast<int64_t> (v & 1);
+}
+
+/**
+ * Bounds-checked cursor over a block payload used by the reader.
+ */
+class PayloadCursor
+{
+public:
+  PayloadCursor (const uint8_t *data, uint32_t size)
+    : m_data (data), m_size (size), m_offset (0), m_ok (true)
+  {}
+  uint64_t GetFixed (uint32_t bytes)
+  {
+    if (m_offset + bytes > m_size)
+      {
+        m_ok = false;
+        return 0;
+      }
+    uint64_t v = 0;
+    for (uint32_t i = 0; i < bytes; ++i)
+      {
+        v |= static_cast<uint64_t> (m_data[m_offset++]) << (8 * i);
+      }
+    return v;
+  }
+  uint64_t GetVarint (void)
+  {
+    uint64_t v = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+      {
+        if (m_offset >= m_size)
+          {
+            break;
+          }
+        uint8_t byte = m_data[m_offset++];
+        v |= static_cast<uint64_t> (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+          {
+            return v;
+          }
+      }
+    m_ok = false;
+    return 0;
+  }
+  bool IsOk (void) const
+  {
+    return m_ok;
+  }
+private:
+  const uint8_t *m_data;
+  uint32_t m_size;
+  uint32_t m_offset;
+  bool m_ok;
+};
+
+BinaryTraceFile::BinaryTraceFile (std::string filename, bool compress, uint32_t blockRecords)
+  : m_compress (compress),
+    m_blockRecords (blockRecords),
+    m_records (0),
+    m_front (&m_blocks[0]),
+    m_back (&m_blocks[1]),
+    m_mutex (0),
+    m_haveBlock (0),
+    m_blockDone (0),
+    m_pending (false),
+    m_stop (false)
+{
+  NS_LOG_FUNCTION (this << filename << compress << blockRecords);
+  NS_ABORT_MSG_IF (blockRecords == 0 || blockRecords > BTRC_MAX_BLOCK_RECORDS,
+                   "BinaryTraceFile::BinaryTraceFile(): blockRecords must be non-zero and at most " << BTRC_MAX_BLOCK_RECORDS);
+
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Block &b = m_blocks[i];
+      b.time.resize (blockRecords);
+      b.node.resize (blockRecords);
+      b.device.resize (blockRecords);
+      b.event.resize (blockRecords);
+      b.uid.resize (blockRecords);
+      b.size.resize (blockRecords);
+      b.n = 0;
+    }
+
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "BinaryTraceFile::BinaryTraceFile():  Unable to Open " << filename);
+  FatalImpl::RegisterStream (&m_file);
+
+  std::vector<uint8_t> header;
+  header.insert (header.end (), BTRC_MAGIC, BTRC_MAGIC + sizeof (BTRC_MAGIC));
+  PutFixed (header, BTRC_VERSION, 2);
+  PutFixed (header, m_compress ? BTRC_FLAG_COMPRESSED : 0, 2);
+  PutFixed (header, 0, 4);
+  m_file.write (reinterpret_cast<const char *> (&header[0]), header.size ());
+
+#ifdef HAVE_PTHREAD_H
+  m_mutex = new SystemMutex ();
+  m_haveBlock = new SystemCondition ();
+  m_blockDone = new SystemCondition ();
+  m_thread = Create<SystemThread> (MakeCallback (&BinaryTraceFile::WriterThread, this));
+  m_thread->Start ();
+#endif
+}
+
+BinaryTraceFile::~BinaryTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+
+#ifdef HAVE_PTHREAD_H
+  m_mutex->Lock ();
+  m_stop = true;
+  m_haveBlock->SetCondition (true);
+  m_mutex->Unlock ();
+  m_haveBlock->Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  delete m_blockDone;
+  delete m_haveBlock;
+  delete m_mutex;
+#endif
+
+  FatalImpl::UnregisterStream (&m_file);
+  m_file.close ();
+}
+
+void
+BinaryTraceFile::Write (Time t, uint32_t node, uint32_t device, uint8_t event, uint64_t uid, uint32_t size)
+{
+  Block *b = m_front;
+  uint32_t i = b->n;
+  b->time[i] = t.GetNanoSeconds ();
+  b->node[i] = node;
+  b->device[i] = device;
+  b->event[i] = event;
+  b->uid[i] = uid;
+  b->size[i] = size;
+  b->n = i + 1;
+  ++m_records;
+  if (b->n == m_blockRecords)
+    {
+      Submit ();
+    }
+}
+
+void
+BinaryTraceFile::Write (uint32_t node, uint32_t device, uint8_t event, Ptr<const Packet> p)
+{
+  Write (Simulator::Now (), node, device, event, p->GetUid (), p->GetSize ());
+}
+
+void
+BinaryTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_front->n != 0)
+    {
+      Submit ();
+    }
+  WaitBackBlockFree ();
+  m_file.flush ();
+}
+
+uint64_t
+BinaryTraceFile::GetRecordCount (void) const
+{
+  return m_records;
+}
+
+bool
+BinaryTraceFile::Fail (void) const
+{
+  return m_file.fail ();
+}
+
+//
+// Hand the front block over to the writer and start filling the other one.
+// If the writer is still busy with the previous block we have to wait for
+// it; with reasonably sized blocks this only happens when the disk cannot
+// keep up with the trace rate.
+//
+void
+BinaryTraceFile::Submit (void)
+{
+  NS_LOG_FUNCTION (this << m_front->n);
+#ifdef HAVE_PTHREAD_H
+  WaitBackBlockFree ();
+  std::swap (m_front, m_back);
+  m_mutex->Lock ();
+  m_pending = true;
+  m_haveBlock->SetCondition (true);
+  m_mutex->Unlock ();
+  m_haveBlock->Signal ();
+#else
+  WriteBlock (m_front);
+#endif
+}
+
+void
+BinaryTraceFile::WaitBackBlockFree (void)
+{
+#ifdef HAVE_PTHREAD_H
+  m_mutex->Lock ();
+  while (m_pending)
+    {
+      m_blockDone->SetCondition (false);
+      m_mutex->Unlock ();
+      m_blockDone->TimedWait (WRITER_POLL_NS);
+      m_mutex->Lock ();
+    }
+  m_mutex->Unlock ();
+#endif
+}
+
+void
+BinaryTraceFile::WriterThread (void)
+{
+#ifdef HAVE_PTHREAD_H
+  while (true)
+    {
+      m_mutex->Lock ();
+      if (m_pending)
+        {
+          m_mutex->Unlock ();
+          WriteBlock (m_back);
+          m_mutex->Lock ();
+          m_pending = false;
+          m_blockDone->SetCondition (true);
+          m_mutex->Unlock ();
+          m_blockDone->Signal ();
+          continue;
+        }
+      if (m_stop)
+        {
+          m_mutex->Unlock ();
+          return;
+        }
+      m_haveBlock->SetCondition (false);
+      m_mutex->Unlock ();
+      m_haveBlock->TimedWait (WRITER_POLL_NS);
+    }
+#endif
+}
+
+//
+// Encode one block column by column.  This runs on the writer thread, so it
+// must not touch anything but the block it was handed, m_encoded and the file.
+//
+void
+BinaryTraceFile::WriteBlock (Block *b)
+{
+  uint32_t n = b->n;
+  std::vector<uint8_t> &out = m_encoded;
+  out.clear ();
+  out.resize (BTRC_BLOCK_HEADER_SIZE);
+
+  if (m_compress)
+    {
+      int64_t lastTime = 0;
+      uint64_t lastUid = 0;
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutVarint (out, ZigZag (b->time[i] - lastTime));
+          lastTime = b->time[i];
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutVarint (out, b->node[i]);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutVarint (out, b->device[i]);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutU8 (out, b->event[i]);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutVarint (out, ZigZag (static_cast<int64_t> (b->uid[i] - lastUid)));
+          lastUid = b->uid[i];
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutVarint (out, b->size[i]);
+        }
+    }
+  else
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutFixed (out, b->time[i], 8);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutFixed (out, b->node[i], 4);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutFixed (out, b->device[i], 4);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutU8 (out, b->event[i]);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutFixed (out, b->uid[i], 8);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          PutFixed (out, b->size[i], 4);
+        }
+    }
+
+  std::vector<uint8_t> header;
+  PutFixed (header, BTRC_BLOCK_MAGIC, 4);
+  PutFixed (header, n, 4);
+  PutFixed (header, out.size () - BTRC_BLOCK_HEADER_SIZE, 4);
+  PutU8 (header, m_compress ? ENCODING_DELTA_VARINT : ENCODING_RAW);
+  PutFixed (header, 0, 3);
+  std::memcpy (&out[0], &header[0], BTRC_BLOCK_HEADER_SIZE);
+
+  m_file.write (reinterpret_cast<const char *> (&out[0]), out.size ());
+  b->n = 0;
+}
+
+BinaryTraceReader::BinaryTraceReader ()
+{
+}
+
+BinaryTraceReader::~BinaryTraceReader ()
+{
+  Close ();
+}
+
+bool
+BinaryTraceReader::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_file.clear ();
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!m_file.is_open ())
+    {
+      return false;
+    }
+  uint8_t header[16];
+  m_file.read (reinterpret_cast<char *> (header), sizeof (header));
+  if (m_file.gcount () != sizeof (header) || std::memcmp (header, BTRC_MAGIC, sizeof (BTRC_MAGIC)) != 0)
+    {
+      NS_LOG_WARN ("BinaryTraceReader::Open(): " << filename << " is not a binary trace file");
+      return false;
+    }
+  PayloadCursor cursor (header + sizeof (BTRC_MAGIC), 2);
+  if (cursor.GetFixed (2) != BTRC_VERSION)
+    {
+      NS_LOG_WARN ("BinaryTraceReader::Open(): unsupported version in " << filename);
+      return false;
+    }
+  return true;
+}
+
+bool
+BinaryTraceReader::ReadBlock (std::vector<BinaryTraceFile::Record> &records)
+{
+  records.clear ();
+  uint8_t header[BTRC_BLOCK_HEADER_SIZE];
+  m_file.read (reinterpret_cast<char *> (header), sizeof (header));
+  if (m_file.gcount () != sizeof (header))
+    {
+      return false;
+    }
+  PayloadCursor h (header, sizeof (header));
+  uint32_t magic = h.GetFixed (4);
+  uint32_t n = h.GetFixed (4);
+  uint32_t bytes = h.GetFixed (4);
+  uint8_t encoding = h.GetFixed (1);
+  if (magic != BTRC_BLOCK_MAGIC)
+    {
+      NS_LOG_WARN ("BinaryTraceReader::ReadBlock(): bad block magic");
+      return false;
+    }
+  // the encoded size of a record: time, node, device, event, uid and size.
+  uint64_t minRecordBytes;
+  uint64_t maxRecordBytes;
+  if (encoding == ENCODING_DELTA_VARINT)
+    {
+      minRecordBytes = 6;
+      maxRecordBytes = 10 + 5 + 5 + 1 + 10 + 5;
+    }
+  else if (encoding == ENCODING_RAW)
+    {
+      minRecordBytes = maxRecordBytes = 8 + 4 + 4 + 1 + 8 + 4;
+    }
+  else
+    {
+      NS_LOG_WARN ("BinaryTraceReader::ReadBlock(): unknown block encoding " << (uint32_t)encoding);
+      return false;
+    }
+  if (n > BTRC_MAX_BLOCK_RECORDS || n * minRecordBytes > bytes || bytes > n * maxRecordBytes)
+    {
+      NS_LOG_WARN ("BinaryTraceReader::ReadBlock(): malformed block header");
+      return false;
+    }
+
+  m_payload.resize (bytes);
+  if (bytes != 0)
+    {
+      m_file.read (reinterpret_cast<char *> (&m_payload[0]), bytes);
+      if (static_cast<uint32_t> (m_file.gcount ()) != bytes)
+        {
+          // Truncated by a crash: the block is unusable.
+          return false;
+        }
+    }
+
+  records.resize (n);
+  PayloadCursor c (bytes ? &m_payload[0] : 0, bytes);
+  if (encoding == ENCODING_DELTA_VARINT)
+    {
+      int64_t lastTime = 0;
+      uint64_t lastUid = 0;
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          lastTime += UnZigZag (c.GetVarint ());
+          records[i].time = lastTime;
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].node = c.GetVarint ();
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].device = c.GetVarint ();
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].event = c.GetFixed (1);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          lastUid += UnZigZag (c.GetVarint ());
+          records[i].uid = lastUid;
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].size = c.GetVarint ();
+        }
+    }
+  else
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].time = c.GetFixed (8);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].node = c.GetFixed (4);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].device = c.GetFixed (4);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].event = c.GetFixed (1);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].uid = c.GetFixed (8);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          records[i].size = c.GetFixed (4);
+        }
+    }
+
+  if (!c.IsOk ())
+    {
+      NS_LOG_WARN ("BinaryTraceReader::ReadBlock(): malformed block");
+      records.clear ();
+      return false;
+    }
+  return true;
+}
+
+void
+BinaryTraceReader::Close (void)
+{
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+}
+
+BinaryTraceSink::BinaryTraceSink (Ptr<BinaryTraceFile> file, uint32_t node, uint32_t device)
+  : m_file (file),
+    m_node (node),
+    m_device (device)
+{
+}
+
+void
+BinaryTraceSink::Record (uint8_t event, Ptr<const Packet> p)
+{
+  m_file->Write (m_node, m_device, event, p);
+}
+
+void
+BinaryTraceSink::Enqueue (Ptr<const Packet> p)
+{
+  Record (BinaryTraceFile::ENQUEUE, p);
+}
+
+void
+BinaryTraceSink::Dequeue (Ptr<const Packet> p)
+{
+  Record (BinaryTraceFile::DEQUEUE, p);
+}
+
+void
+BinaryTraceSink::Drop (Ptr<const Packet> p)
+{
+  Record (BinaryTraceFile::DROP, p);
+}
+
+void
+BinaryTraceSink::Receive (Ptr<const Packet> p)
+{
+  Record (BinaryTraceFile::RECEIVE, p);
+}
+
+void
+BinaryTraceSink::Transmit (Ptr<const Packet> p)
+{
+  Record (BinaryTraceFile::TRANSMIT, p);
+}
+
+} // namespace ns3
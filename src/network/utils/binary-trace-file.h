@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/core-config.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+class Packet;
+class SystemThread;
+class SystemMutex;
+class SystemCondition;
+
+/**
+ * \brief A compact, binary replacement for ascii device traces.
+ *
+ * Every trace event is reduced to a fixed schema (time, node, device, event
+ * type, packet uid, packet size) instead of being formatted as text.  Events
+ * are accumulated in memory as columns and written out in blocks of
+ * blockRecords entries.  When threading is available, the blocks are encoded
+ * and written by a background thread while the simulation keeps filling a
+ * second block (double buffering), so the simulation thread only ever stores
+ * six integers per event.
+ *
+ * With compression enabled, each column is delta/varint encoded, which is
+ * very effective since times and uids are nearly monotonic and node, device
+ * and event columns are small integers.
+ *
+ * The file layout is:
+ *
+ * \verbatim
+ *   file header:  char magic[8] = "ns3btrc", uint16 version, uint16 flags,
+ *                 uint32 reserved
+ *   block header: uint32 magic, uint32 records, uint32 payload bytes,
+ *                 uint8 encoding, uint8 reserved[3]
+ *   block payload: time[] node[] device[] event[] uid[] size[]
+ * \endverbatim
+ *
+ * All integers are stored little-endian.  Use BinaryTraceReader, or the
+ * binary-trace-to-ascii program in utils/, to read the file back.
+ *
+ * Like OutputStreamWrapper, this class is reference counted so it can be
+ * bound to trace callbacks.  The last block is written out when the object
+ * is destroyed, or earlier on an explicit Flush ().
+ */
+class BinaryTraceFile : public SimpleRefCount<BinaryTraceFile>
+{
+public:
+  static const uint32_t BLOCK_RECORDS_DEFAULT = 16384; /**< Default number of events per block */
+
+  /**
+   * Event type codes.  They match the leading character of the lines written
+   * by the ascii trace helpers.
+   */
+  enum Event {
+    ENQUEUE = '+',
+    DEQUEUE = '-',
+    DROP = 'd',
+    RECEIVE = 'r',
+    TRANSMIT = 't'
+  };
+
+  /**
+   * One decoded trace event.  Time is stored in nanoseconds.
+   */
+  struct Record
+  {
+    int64_t time;
+    uint32_t node;
+    uint32_t device;
+    uint8_t event;
+    uint64_t uid;
+    uint32_t size;
+  };
+
+  /**
+   * \param filename The name of the file to create (truncated if it exists).
+   * \param compress If true, delta/varint encode the blocks.
+   * \param blockRecords Number of events buffered before a block is written,
+   *        at most 2^24.
+   */
+  BinaryTraceFile (std::string filename, bool compress = true,
+                   uint32_t blockRecords = BLOCK_RECORDS_DEFAULT);
+  ~BinaryTraceFile ();
+
+  /**
+   * \brief Record one event.
+   *
+   * \param t Simulation time of the event.
+   * \param node Node id.
+   * \param device Device index on the node.
+   * \param event Event type (usually one of Event).
+   * \param uid Packet uid.
+   * \param size Packet size in bytes.
+   */
+  void Write (Time t, uint32_t node, uint32_t device, uint8_t event, uint64_t uid, uint32_t size);
+
+  /**
+   * \brief Record one event for a packet at the current simulation time.
+   */
+  void Write (uint32_t node, uint32_t device, uint8_t event, Ptr<const Packet> p);
+
+  /**
+   * \brief Write out all buffered events and wait until they reach the file.
+   */
+  void Flush (void);
+
+  /**
+   * \return the number of events recorded so far.
+   */
+  uint64_t GetRecordCount (void) const;
+
+  /**
+   * \return true if the underlying file could not be opened or written.
+   */
+  bool Fail (void) const;
+
+private:
+  struct Block
+  {
+    std::vector<int64_t> time;
+    std::vector<uint32_t> node;
+    std::vector<uint32_t> device;
+    std::vector<uint8_t> event;
+    std::vector<uint64_t> uid;
+    std::vector<uint32_t> size;
+    uint32_t n;
+  };
+
+  BinaryTraceFile (const BinaryTraceFile &);
+  BinaryTraceFile &operator = (const BinaryTraceFile &);
+
+  void Submit (void);
+  void WaitBackBlockFree (void);
+  void WriteBlock (Block *block);
+  void WriterThread (void);
+
+  std::ofstream m_file;
+  bool m_compress;
+  uint32_t m_blockRecords;
+  uint64_t m_records;
+  Block m_blocks[2];
+  Block *m_front;
+  Block *m_back;
+  std::vector<uint8_t> m_encoded;
+
+#ifdef HAVE_PTHREAD_H
+  Ptr<SystemThread> m_thread;
+#endif
+  SystemMutex *m_mutex;
+  SystemCondition *m_haveBlock;
+  SystemCondition *m_blockDone;
+  bool m_pending;
+  bool m_stop;
+};
+
+/**
+ * \brief Sequential reader for files written by BinaryTraceFile.
+ */
+class BinaryTraceReader
+{
+public:
+  BinaryTraceReader ();
+  ~BinaryTraceReader ();
+
+  /**
+   * \brief Open a binary trace file and check its header.
+   * \return true on success.
+   */
+  bool Open (std::string filename);
+
+  /**
+   * \brief Read and decode the next block of events.
+   *
+   * \param records Replaced with the events of the block.
+   * \return false at the end of file or on a malformed block.
+   */
+  bool ReadBlock (std::vector<BinaryTraceFile::Record> &records);
+
+  void Close (void);
+
+private:
+  std::ifstream m_file;
+  std::vector<uint8_t> m_payload;
+};
+
+/**
+ * \brief Binds a BinaryTraceFile to one node/device pair.
+ *
+ * Trace sources only hand the packet to their sinks, and bound callbacks can
+ * carry a single argument, so device helpers bind one of these per device
+ * and connect its methods to the device trace sources.
+ */
+class BinaryTraceSink : public SimpleRefCount<BinaryTraceSink>
+{
+public:
+  BinaryTraceSink (Ptr<BinaryTraceFile> file, uint32_t node, uint32_t device);
+
+  void Record (uint8_t event, Ptr<const Packet> p);
+
+  void Enqueue (Ptr<const Packet> p);
+  void Dequeue (Ptr<const Packet> p);
+  void Drop (Ptr<const Packet> p);
+  void Receive (Ptr<const Packet> p);
+  void Transmit (Ptr<const Packet> p);
+
+private:
+  Ptr<BinaryTraceFile> m_file;
+  uint32_t m_node;
+  uint32_t m_device;
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
@@ -221,6 +221,14 @@ Mac48Address Mac48Address::GetMulticast (Ipv6Address addr)
   return etherAddr;
 }
 
+size_t Mac48AddressHash::operator() (Mac48Address const &x) const
+{
+  // allocated addresses differ mostly in their last bytes
+  const uint8_t *a = x.m_address;
+  return ((size_t)a[2] << 24 | (size_t)a[3] << 16 | (size_t)a[4] << 8 | a[5])
+         ^ ((size_t)a[0] << 8 | a[1]) << 13;
+}
+
 std::ostream& operator<< (std::ostream& os, const Mac48Address & address)
 {
   uint8_t ad[6];
@@ -137,10 +137,16 @@ private:
   friend bool operator == (const Mac48Address &a, const Mac48Address &b);
   friend bool operator != (const Mac48Address &a, const Mac48Address &b);
   friend std::istream& operator>> (std::istream& is, Mac48Address & address);
+  friend class Mac48AddressHash;
 
   uint8_t m_address[6];
 };
 
+class Mac48AddressHash {
+public:
+  size_t operator() (Mac48Address const &x) const;
+};
+
 /**
  * \class ns3::Mac48AddressValue
  * \brief hold objects of type ns3::Mac48Address
@@ -78,6 +78,12 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write out any records buffered because of the "WriteBufferSize"
+   * attribute.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -197,6 +203,8 @@ public:
 private:
   PcapFile m_file;
   uint32_t m_snapLen;
+  uint32_t m_writeBufferSize;
+  bool m_asyncWrite;
 };
 
 } // namespace ns3
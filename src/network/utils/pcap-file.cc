@@ -20,12 +20,18 @@
 
 #include <iostream>
 #include <cstring>
+#include "ns3/core-config.h"
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/header.h"
 #include "ns3/buffer.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif
 #include "pcap-file.h"
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
@@ -43,17 +49,30 @@ const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pc
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 const int32_t  SIGFIGS_DEFAULT = 0;           /**< Significant figures for timestamps (libpcap doesn't even bother) */
 
+const uint32_t RECORD_HEADER_SIZE = 16;       /**< Size of a record header in the file */
+const uint64_t WRITER_POLL_NS = 100000000;    /**< Upper bound on a writer thread wait */
+
 PcapFile::PcapFile ()
   : m_file (),
-    m_swapMode (false)
+    m_swapMode (false),
+    m_batchSize (0),
+    m_async (false),
+    m_front (0),
+    m_mutex (0),
+    m_haveBatch (0),
+    m_batchDone (0),
+    m_pending (false),
+    m_stop (false)
 {
+  m_batchUsed[0] = 0;
+  m_batchUsed[1] = 0;
   FatalImpl::RegisterStream (&m_file);
 }
 
 PcapFile::~PcapFile ()
 {
-  FatalImpl::UnregisterStream (&m_file);
   Close ();
+  FatalImpl::UnregisterStream (&m_file);
 }
 
 
@@ -77,9 +96,180 @@ PcapFile::Clear (void)
 void
 PcapFile::Close (void)
 {
+  Flush ();
+  StopWriter ();
   m_file.close ();
 }
 
+void
+PcapFile::SetWriteBuffer (uint32_t bufferSize, bool async)
+{
+  Flush ();
+  StopWriter ();
+
+  m_batchSize = (bufferSize + WRITE_BUFFER_ALIGN - 1) / WRITE_BUFFER_ALIGN * WRITE_BUFFER_ALIGN;
+  m_async = async;
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      std::vector<uint8_t> empty;
+      m_batch[i].swap (empty);
+      m_batch[i].resize (m_batchSize);
+      m_batchUsed[i] = 0;
+    }
+  m_front = 0;
+}
+
+void
+PcapFile::Flush (void)
+{
+  if (m_batchSize == 0)
+    {
+      return;
+    }
+  if (m_batchUsed[m_front] != 0)
+    {
+      SubmitBatch ();
+    }
+  WaitBatchDone ();
+  m_file.flush ();
+}
+
+//
+// Return room for bytes more bytes in the front batch, handing the batch over
+// to the writer first if it is too full.  Returns zero if the record has to
+// be written through, in which case everything buffered so far has been
+// written out already so that records stay in order.
+//
+uint8_t *
+PcapFile::Reserve (uint32_t bytes)
+{
+  if (m_batchSize == 0)
+    {
+      return 0;
+    }
+  if (bytes > m_batchSize)
+    {
+      Flush ();
+      return 0;
+    }
+  if (m_batchUsed[m_front] + bytes > m_batchSize)
+    {
+      SubmitBatch ();
+    }
+  uint8_t *p = &m_batch[m_front][m_batchUsed[m_front]];
+  m_batchUsed[m_front] += bytes;
+  return p;
+}
+
+void
+PcapFile::SubmitBatch (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_async)
+    {
+      WaitBatchDone ();
+      if (m_thread == 0)
+        {
+          m_mutex = new SystemMutex ();
+          m_haveBatch = new SystemCondition ();
+          m_batchDone = new SystemCondition ();
+          m_stop = false;
+          m_thread = Create<SystemThread> (MakeCallback (&PcapFile::WriterThread, this));
+          m_thread->Start ();
+        }
+      m_front = 1 - m_front;
+      m_mutex->Lock ();
+      m_pending = true;
+      m_haveBatch->SetCondition (true);
+      m_mutex->Unlock ();
+      m_haveBatch->Signal ();
+      return;
+    }
+#endif
+  m_file.write ((const char *)&m_batch[m_front][0], m_batchUsed[m_front]);
+  m_batchUsed[m_front] = 0;
+}
+
+void
+PcapFile::WaitBatchDone (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_thread == 0)
+    {
+      return;
+    }
+  m_mutex->Lock ();
+  while (m_pending)
+    {
+      m_batchDone->SetCondition (false);
+      m_mutex->Unlock ();
+      m_batchDone->TimedWait (WRITER_POLL_NS);
+      m_mutex->Lock ();
+    }
+  m_mutex->Unlock ();
+#endif
+}
+
+void
+PcapFile::StopWriter (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_thread == 0)
+    {
+      return;
+    }
+  m_mutex->Lock ();
+  m_stop = true;
+  m_haveBatch->SetCondition (true);
+  m_mutex->Unlock ();
+  m_haveBatch->Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  delete m_batchDone;
+  delete m_haveBatch;
+  delete m_mutex;
+  m_batchDone = 0;
+  m_haveBatch = 0;
+  m_mutex = 0;
+#endif
+}
+
+//
+// Runs on the I/O thread.  It only touches the back batch and the file; the
+// simulation thread does not write to the file while a batch is pending.
+//
+void
+PcapFile::WriterThread (void)
+{
+#ifdef HAVE_PTHREAD_H
+  while (true)
+    {
+      m_mutex->Lock ();
+      if (m_pending)
+        {
+          uint32_t back = 1 - m_front;
+          m_mutex->Unlock ();
+          m_file.write ((const char *)&m_batch[back][0], m_batchUsed[back]);
+          m_batchUsed[back] = 0;
+          m_mutex->Lock ();
+          m_pending = false;
+          m_batchDone->SetCondition (true);
+          m_mutex->Unlock ();
+          m_batchDone->Signal ();
+          continue;
+        }
+      if (m_stop)
+        {
+          m_mutex->Unlock ();
+          return;
+        }
+      m_haveBatch->SetCondition (false);
+      m_mutex->Unlock ();
+      m_haveBatch->TimedWait (WRITER_POLL_NS);
+    }
+#endif
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -341,15 +531,21 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   //
   m_swapMode = swapMode | bigEndian;
 
+  Flush ();
   WriteFileHeader ();
 }
 
-uint32_t
-PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+//
+// Write the record header, either to the front batch or straight to the
+// file.  Returns where the inclLen bytes of packet data must be copied to, or
+// zero if they have to be written to the file as well.
+//
+uint8_t *
+PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t &inclLen)
 {
   NS_ASSERT (m_file.good ());
 
-  uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+  inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
   PcapRecordHeader header;
   header.m_tsSec = tsSec;
@@ -362,6 +558,16 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
       Swap (&header, &header);
     }
 
+  uint8_t *out = Reserve (RECORD_HEADER_SIZE + inclLen);
+  if (out != 0)
+    {
+      memcpy (out, &header.m_tsSec, sizeof(header.m_tsSec));
+      memcpy (out + 4, &header.m_tsUsec, sizeof(header.m_tsUsec));
+      memcpy (out + 8, &header.m_inclLen, sizeof(header.m_inclLen));
+      memcpy (out + 12, &header.m_origLen, sizeof(header.m_origLen));
+      return out + RECORD_HEADER_SIZE;
+    }
+
   //
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
@@ -370,20 +576,33 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
   m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
   m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  return inclLen;
+  return 0;
 }
 
 void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
+  uint32_t inclLen;
+  uint8_t *out = WritePacketHeader (tsSec, tsUsec, totalLen, inclLen);
+  if (out != 0)
+    {
+      memcpy (out, data, inclLen);
+      return;
+    }
   m_file.write ((const char *)data, inclLen);
 }
 
 void 
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
+  uint32_t inclLen;
+  uint8_t *out = WritePacketHeader (tsSec, tsUsec, p->GetSize (), inclLen);
+  if (out != 0)
+    {
+      // Copies at most inclLen bytes straight out of the packet buffer.
+      p->CopyData (out, inclLen);
+      return;
+    }
   p->CopyData (&m_file, inclLen);
 }
 
@@ -392,12 +611,19 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Header &header, Ptr<const Pack
 {
   uint32_t headerSize = header.GetSerializedSize ();
   uint32_t totalSize = headerSize + p->GetSize ();
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
+  uint32_t inclLen;
+  uint8_t *out = WritePacketHeader (tsSec, tsUsec, totalSize, inclLen);
 
   Buffer headerBuffer;
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
+  if (out != 0)
+    {
+      headerBuffer.CopyData (out, toCopy);
+      p->CopyData (out + toCopy, inclLen - toCopy);
+      return;
+    }
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
   p->CopyData (&m_file, inclLen);
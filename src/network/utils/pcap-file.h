@@ -23,13 +23,18 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
 #include <stdint.h>
+#include "ns3/core-config.h"
 #include "ns3/ptr.h"
 
 namespace ns3 {
 
 class Packet;
 class Header;
+class SystemThread;
+class SystemMutex;
+class SystemCondition;
 
 /*
  * A class representing a pcap file.  This allows easy creation, writing and 
@@ -42,6 +47,7 @@ class PcapFile
 public:
   static const int32_t  ZONE_DEFAULT    = 0;           /**< Time zone offset for current location */
   static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+  static const uint32_t WRITE_BUFFER_ALIGN = 4096;     /**< Write batches are sized in multiples of this */
 
 public:
   PcapFile ();
@@ -147,6 +153,29 @@ public:
    */
   void Write (uint32_t tsSec, uint32_t tsUsec, Header &header, Ptr<const Packet> p);
 
+  /**
+   * \brief Batch written records in memory instead of writing them through.
+   *
+   * Record headers and packet bytes (up to the snap length) are serialized
+   * straight from the packet buffer into one of two batch buffers of
+   * bufferSize bytes, rounded up to a multiple of WRITE_BUFFER_ALIGN.  A full
+   * batch is written out in a single call; if async is true and threading is
+   * available, this happens on a dedicated I/O thread while the caller keeps
+   * filling the other batch.  Records larger than a batch are written
+   * through.
+   *
+   * Buffered records reach the file on Flush (), Close () or destruction.
+   *
+   * \param bufferSize Size of each batch in bytes, zero to write through.
+   * \param async Write full batches from a background thread.
+   */
+  void SetWriteBuffer (uint32_t bufferSize, bool async = true);
+
+  /**
+   * \brief Write out all buffered records and wait until they reach the file.
+   */
+  void Flush (void);
+
 
   /**
    * \brief Read next packet from file
@@ -283,13 +312,33 @@ private:
   void Swap (PcapRecordHeader *from, PcapRecordHeader *to);
 
   void WriteFileHeader (void);
-  uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
+  uint8_t *WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t &inclLen);
   void ReadAndVerifyFileHeader (void);
 
+  uint8_t *Reserve (uint32_t bytes);
+  void SubmitBatch (void);
+  void WaitBatchDone (void);
+  void StopWriter (void);
+  void WriterThread (void);
+
   std::string    m_filename;
   std::fstream   m_file;
   PcapFileHeader m_fileHeader;
   bool m_swapMode;
+
+  uint32_t m_batchSize;                /**< Size of each batch buffer, zero if writing through */
+  bool m_async;                        /**< Write full batches from m_thread */
+  std::vector<uint8_t> m_batch[2];     /**< The batch being filled and the batch being written */
+  uint32_t m_batchUsed[2];             /**< Number of bytes used in each batch */
+  uint32_t m_front;                    /**< Index of the batch being filled */
+#ifdef HAVE_PTHREAD_H
+  Ptr<SystemThread> m_thread;
+#endif
+  SystemMutex *m_mutex;
+  SystemCondition *m_haveBatch;
+  SystemCondition *m_batchDone;
+  bool m_pending;                      /**< The back batch is waiting to be written */
+  bool m_stop;
 };
 
 } // namespace ns3
@@ -214,6 +214,31 @@ PointToPointHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void
+PointToPointHelper::EnableBinaryInternal (Ptr<BinaryTraceSink> sink, Ptr<NetDevice> nd)
+{
+  Ptr<PointToPointNetDevice> device = nd->GetObject<PointToPointNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("PointToPointHelper::EnableBinaryInternal(): Device " << device << " not of type ns3::PointToPointNetDevice");
+      return;
+    }
+
+  //
+  // Same events as the ascii traces: "r" from MacRx, and "+", "-" and "d"
+  // from the transmit queue.
+  //
+  device->TraceConnectWithoutContext ("MacRx", MakeCallback (&BinaryTraceSink::Receive, sink));
+
+  Ptr<Queue> queue = device->GetQueue ();
+  queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&BinaryTraceSink::Enqueue, sink));
+  queue->TraceConnectWithoutContext ("Drop", MakeCallback (&BinaryTraceSink::Drop, sink));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&BinaryTraceSink::Dequeue, sink));
+
+  // PhyRxDrop trace source for "d" event
+  device->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&BinaryTraceSink::Drop, sink));
+}
+
 NetDeviceContainer 
 PointToPointHelper::Install (NodeContainer c)
 {
@@ -177,6 +177,15 @@ private:
     Ptr<NetDevice> nd,
     bool explicitFilename);
 
+  /**
+   * \brief Enable binary trace output on the indicated net device.
+   * \internal
+   *
+   * \param sink The binary trace sink bound to the device.
+   * \param nd Net device for which you want to enable tracing.
+   */
+  virtual void EnableBinaryInternal (Ptr<BinaryTraceSink> sink, Ptr<NetDevice> nd);
+
   ObjectFactory m_queueFactory;
   ObjectFactory m_channelFactory;
   ObjectFactory m_remoteChannelFactory;
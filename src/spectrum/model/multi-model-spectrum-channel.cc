@@ -34,6 +34,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <iostream>
 #include <utility>
+#include <algorithm>
 #include "multi-model-spectrum-channel.h"
 
 
@@ -90,6 +91,7 @@ MultiModelSpectrumChannel::DoDispose ()
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
   m_phyVector.clear ();
+  m_receiverGrid.Clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -111,6 +113,18 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "If positive, the maximum distance in meters between the transmitter and "
+                   "the receivers to which transmissions will be passed. The receivers within "
+                   "this distance are found through a grid index of their positions, and no "
+                   "propagation model is evaluated nor spectrum conversion done for the others. "
+                   "Receivers without a MobilityModel receive all the transmissions. The index "
+                   "relies on the MobilityModels of the receivers to report their course changes. "
+                   "The default value disables the index.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::SetMaxRange,
+                                       &MultiModelSpectrumChannel::GetMaxRange),
+                   MakeDoubleChecker<double> (0.0))
     .AddTraceSource ("PropagationLoss",
                      "If a PropagationLossModel is plugged on the channel, this trace is fired "
                      "whenever a new path loss value is calculated. The first and second parameters "
@@ -145,6 +159,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       NS_ASSERT (*it != phy);
     }
   m_phyVector.push_back (phy);
+  m_receiverGrid.Add (phy);
 
   RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.find (rxSpectrumModelUid);
 
@@ -179,6 +194,21 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 }
 
 
+void
+MultiModelSpectrumChannel::SetMaxRange (double maxRange)
+{
+  NS_LOG_FUNCTION (this << maxRange);
+  m_receiverGrid.SetRange (maxRange);
+}
+
+
+double
+MultiModelSpectrumChannel::GetMaxRange (void) const
+{
+  return m_receiverGrid.GetRange ();
+}
+
+
 TxSpectrumModelInfoMap_t::const_iterator
 MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel)
 {
@@ -232,8 +262,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 
   Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
-  SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
-  NS_LOG_LOGIC (" txSpectrumModelUid " << txSpectrumModelUid);
+  NS_LOG_LOGIC (" txSpectrumModelUid " << txParams->psd->GetSpectrumModelUid ());
 
   //
   TxSpectrumModelInfoMap_t::const_iterator txInfoIteratorerator = FindAndEventuallyAddTxSpectrumModel (txParams->psd->GetSpectrumModel ());
@@ -243,6 +272,39 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  if (txMobility && m_receiverGrid.GetRange () > 0)
+    {
+      // the receivers in range, sorted by SpectrumModel and then in the
+      // order in which they were added, as in m_rxSpectrumModelInfoMap
+      std::vector<uint32_t> receivers;
+      m_receiverGrid.GetReceivers (txMobility, receivers);
+      std::vector<std::pair<SpectrumModelUid_t, uint32_t> > sortedReceivers;
+      sortedReceivers.reserve (receivers.size ());
+      for (std::vector<uint32_t>::const_iterator i = receivers.begin (); i != receivers.end (); ++i)
+        {
+          if (m_phyVector[*i] != txParams->txPhy)
+            {
+              sortedReceivers.push_back (std::make_pair (m_phyVector[*i]->GetRxSpectrumModel ()->GetUid (), *i));
+            }
+        }
+      std::sort (sortedReceivers.begin (), sortedReceivers.end ());
+
+      const SpectrumConverter *converter = 0;
+      Ptr<SpectrumValue> convertedTxPowerSpectrum;
+      for (std::vector<std::pair<SpectrumModelUid_t, uint32_t> >::const_iterator i = sortedReceivers.begin ();
+           i != sortedReceivers.end ();
+           ++i)
+        {
+          if (i == sortedReceivers.begin () || i->first != (i - 1)->first)
+            {
+              converter = GetConverter (txInfoIteratorerator, i->first);
+              convertedTxPowerSpectrum = 0;
+            }
+          StartPropagation (txParams, txMobility, m_phyVector[i->second], converter, convertedTxPowerSpectrum);
+        }
+      return;
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -250,20 +312,9 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC (" rxSpectrumModelUids " << rxSpectrumModelUid);
 
-      Ptr <SpectrumValue> convertedTxPowerSpectrum;
-      if (txSpectrumModelUid == rxSpectrumModelUid)
-        {
-          NS_LOG_LOGIC ("no spectrum conversion needed");
-          convertedTxPowerSpectrum = txParams->psd;
-        }
-      else
-        {
-          NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
-          SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
-          NS_ASSERT (rxConverterIterator != txInfoIteratorerator->second.m_spectrumConverterMap.end ());
-          convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
-        }
-
+      // the psd is converted on the first receiver which is not beyond range
+      const SpectrumConverter *converter = GetConverter (txInfoIteratorerator, rxSpectrumModelUid);
+      Ptr<SpectrumValue> convertedTxPowerSpectrum;
 
       for (std::list<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhyList.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhyList.end ();
@@ -272,57 +323,9 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
                          "MultiModelSpectrumChannel only supports devices that use a single RxSpectrumModel that does not change for the whole simulation");
 
-
-
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
-
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-
-              if (txMobility && receiverMobility)
-                {
-                  if (m_propagationLoss)
-                    {
-                      double gainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      m_propagationLossTrace (txParams->txPhy, *rxPhyIterator, -gainDb);
-                      if ( (-gainDb) > m_maxLossDb)
-                        {
-                          // beyond range
-                          continue;
-                        }
-                      double gainLinear = pow (10.0, gainDb / 10.0);
-                      *(rxParams->psd) *= gainLinear;
-                    }
-
-                  if (m_spectrumPropagationLoss)
-                    {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                    }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
-                }
-
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
+              StartPropagation (txParams, txMobility, *rxPhyIterator, converter, convertedTxPowerSpectrum);
             }
         }
 
@@ -330,6 +333,91 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 }
 
+const SpectrumConverter *
+MultiModelSpectrumChannel::GetConverter (TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+                                         SpectrumModelUid_t rxSpectrumModelUid) const
+{
+  if (txInfoIterator->first == rxSpectrumModelUid)
+    {
+      NS_LOG_LOGIC ("no spectrum conversion needed");
+      return 0;
+    }
+  SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIterator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
+  NS_ASSERT (rxConverterIterator != txInfoIterator->second.m_spectrumConverterMap.end ());
+  return &(rxConverterIterator->second);
+}
+
+void
+MultiModelSpectrumChannel::StartPropagation (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                             Ptr<SpectrumPhy> receiver, const SpectrumConverter *converter,
+                                             Ptr<SpectrumValue> &convertedPsd)
+{
+  NS_LOG_FUNCTION (this << txParams << receiver);
+  Time delay = MicroSeconds (0);
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+
+  double gainLinear = 1.0;
+  if (txMobility && receiverMobility && m_propagationLoss)
+    {
+      double gainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+      m_propagationLossTrace (txParams->txPhy, receiver, -gainDb);
+      if ( (-gainDb) > m_maxLossDb)
+        {
+          // beyond range, no need to copy nor convert the psd
+          return;
+        }
+      gainLinear = pow (10.0, gainDb / 10.0);
+    }
+
+  NS_LOG_LOGIC (" copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  if (converter != 0)
+    {
+      if (convertedPsd == 0)
+        {
+          NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids " << txParams->psd->GetSpectrumModelUid ()
+                                                                          << " --> " << receiver->GetRxSpectrumModel ()->GetUid ());
+          convertedPsd = converter->Convert (txParams->psd);
+        }
+      // the copy of the parameters already holds a copy of the psd
+      // when no conversion is needed.
+      rxParams->psd = Copy<SpectrumValue> (convertedPsd);
+    }
+
+  if (txMobility && receiverMobility)
+    {
+      if (m_propagationLoss)
+        {
+          *(rxParams->psd) *= gainLinear;
+        }
+
+      if (m_spectrumPropagationLoss)
+        {
+          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+        }
+
+      if (m_propagationDelay)
+        {
+          delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+        }
+    }
+
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                      rxParams, receiver);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                           rxParams, receiver);
+    }
+}
+
 void
 MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
 {
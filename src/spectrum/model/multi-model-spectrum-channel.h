@@ -27,6 +27,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/spectrum-receiver-grid.h>
 #include <map>
 #include <list>
 
@@ -140,6 +141,35 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * applies the propagation models to a transmission and schedules its
+   * reception by a receiver, unless the receiver is beyond MaxLossDb. The
+   * psd of the transmission is converted to the SpectrumModel of the
+   * receiver on the first receiver which needs it.
+   *
+   * @param txParams the parameters of the transmission
+   * @param txMobility the mobility model of the transmitter
+   * @param receiver the receiver
+   * @param converter the converter to the SpectrumModel of the receiver,
+   * or 0 if the receiver uses the SpectrumModel of the transmission
+   * @param convertedPsd the converted psd, or 0 if not converted yet
+   */
+  void StartPropagation (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                         Ptr<SpectrumPhy> receiver, const SpectrumConverter *converter,
+                         Ptr<SpectrumValue> &convertedPsd);
+
+  /**
+   * @param txInfoIterator the entry of the TX SpectrumModel in m_txSpectrumModelInfoMap
+   * @param rxSpectrumModelUid the Uid of the RX SpectrumModel
+   *
+   * @return the converter between the two SpectrumModels, or 0 if they are the same
+   */
+  const SpectrumConverter * GetConverter (TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+                                          SpectrumModelUid_t rxSpectrumModelUid) const;
+
+  void SetMaxRange (double maxRange);
+  double GetMaxRange (void) const;
+
 
 
   /**
@@ -187,6 +217,12 @@ private:
 
   double m_maxLossDb;
 
+  /**
+   * grid index of the SpectrumPhy instances of m_phyVector, used when
+   * MaxRange is set
+   */
+  SpectrumReceiverGrid m_receiverGrid;
+
   TracedCallback<Ptr<SpectrumPhy>, Ptr<SpectrumPhy>, double > m_propagationLossTrace;
 };
 
@@ -54,6 +54,7 @@ SingleModelSpectrumChannel::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   m_phyList.clear ();
+  m_receiverGrid.Clear ();
   m_spectrumModel = 0;
   m_propagationDelay = 0;
   m_propagationLoss = 0;
@@ -80,6 +81,18 @@ SingleModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&SingleModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "If positive, the maximum distance in meters between the transmitter and "
+                   "the receivers to which transmissions will be passed. The receivers within "
+                   "this distance are found through a grid index of their positions, and no "
+                   "propagation model is evaluated for the others. Receivers without a "
+                   "MobilityModel receive all the transmissions. The index relies on the "
+                   "MobilityModels of the receivers to report their course changes. "
+                   "The default value disables the index.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&SingleModelSpectrumChannel::SetMaxRange,
+                                       &SingleModelSpectrumChannel::GetMaxRange),
+                   MakeDoubleChecker<double> (0.0))
     .AddTraceSource ("PropagationLoss",
                      "If a PropagationLossModel is plugged on the channel, this trace is fired "
                      "whenever a new path loss value is calculated. The first and second parameters "
@@ -99,6 +112,22 @@ SingleModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  m_receiverGrid.Add (phy);
+}
+
+
+void
+SingleModelSpectrumChannel::SetMaxRange (double maxRange)
+{
+  NS_LOG_FUNCTION (this << maxRange);
+  m_receiverGrid.SetRange (maxRange);
+}
+
+
+double
+SingleModelSpectrumChannel::GetMaxRange (void) const
+{
+  return m_receiverGrid.GetRange ();
 }
 
 
@@ -126,61 +155,88 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
 
+  if (senderMobility && m_receiverGrid.GetRange () > 0)
+    {
+      std::vector<uint32_t> receivers;
+      m_receiverGrid.GetReceivers (senderMobility, receivers);
+      for (std::vector<uint32_t>::const_iterator i = receivers.begin (); i != receivers.end (); ++i)
+        {
+          if (m_phyList[*i] != txParams->txPhy)
+            {
+              StartPropagation (txParams, senderMobility, m_phyList[*i]);
+            }
+        }
+      return;
+    }
+
   for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
        rxPhyIterator != m_phyList.end ();
        ++rxPhyIterator)
     {
       if ((*rxPhyIterator) != txParams->txPhy)
         {
-          Time delay  = MicroSeconds (0);
+          StartPropagation (txParams, senderMobility, *rxPhyIterator);
+        }
+    }
 
-          Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-          NS_LOG_LOGIC ("copying signal parameters " << txParams);
-          Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+}
 
-          if (senderMobility && receiverMobility)
-            {
-              if (m_propagationLoss)
-                {
-                  double gainDb = m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
-                  m_propagationLossTrace (txParams->txPhy, *rxPhyIterator, -gainDb);
-                  if ( (-gainDb) > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
-                    }
-                  double gainLinear = pow (10.0, gainDb / 10.0);
-                  *(rxParams->psd) *= gainLinear;
-                }
-
-              if (m_spectrumPropagationLoss)
-                {
-                  rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, senderMobility, receiverMobility);
-                }
-
-              if (m_propagationDelay)
-                {
-                  delay = m_propagationDelay->GetDelay (senderMobility, receiverMobility);
-                }
-            }
+void
+SingleModelSpectrumChannel::StartPropagation (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> senderMobility,
+                                              Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this << txParams << receiver);
+  Time delay  = MicroSeconds (0);
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
 
+  double gainLinear = 1.0;
+  if (senderMobility && receiverMobility && m_propagationLoss)
+    {
+      double gainDb = m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
+      m_propagationLossTrace (txParams->txPhy, receiver, -gainDb);
+      if ( (-gainDb) > m_maxLossDb)
+        {
+          // beyond range, no need to copy the signal parameters
+          return;
+        }
+      gainLinear = pow (10.0, gainDb / 10.0);
+    }
 
-          Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-          if (netDev)
-            {
-              // the receiver has a NetDevice, so we expect that it is attached to a Node
-              uint32_t dstNode =  netDev->GetNode ()->GetId ();
-              Simulator::ScheduleWithContext (dstNode, delay, &SingleModelSpectrumChannel::StartRx, this, rxParams, *rxPhyIterator);
-            }
-          else
-            {
-              // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-              Simulator::Schedule (delay, &SingleModelSpectrumChannel::StartRx, this,
-                                   rxParams, *rxPhyIterator);
-            }
+  NS_LOG_LOGIC ("copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+
+  if (senderMobility && receiverMobility)
+    {
+      if (m_propagationLoss)
+        {
+          *(rxParams->psd) *= gainLinear;
+        }
+
+      if (m_spectrumPropagationLoss)
+        {
+          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, senderMobility, receiverMobility);
+        }
+
+      if (m_propagationDelay)
+        {
+          delay = m_propagationDelay->GetDelay (senderMobility, receiverMobility);
         }
     }
 
+
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &SingleModelSpectrumChannel::StartRx, this, rxParams, receiver);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &SingleModelSpectrumChannel::StartRx, this,
+                           rxParams, receiver);
+    }
 }
 
 void
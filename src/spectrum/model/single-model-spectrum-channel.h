@@ -25,6 +25,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-model.h>
 #include <ns3/traced-callback.h>
+#include <ns3/spectrum-receiver-grid.h>
 
 namespace ns3 {
 
@@ -74,6 +75,20 @@ private:
    */
   void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * applies the propagation models to a transmission and schedules its
+   * reception by a receiver, unless the receiver is beyond MaxLossDb
+   *
+   * @param txParams the parameters of the transmission
+   * @param senderMobility the mobility model of the transmitter
+   * @param receiver the receiver
+   */
+  void StartPropagation (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> senderMobility,
+                         Ptr<SpectrumPhy> receiver);
+
+  void SetMaxRange (double maxRange);
+  double GetMaxRange (void) const;
+
   /**
    * list of SpectrumPhy instances attached to
    * the channel
@@ -109,6 +124,11 @@ private:
 
   double m_maxLossDb;
 
+  /**
+   * grid index of the receivers, used when MaxRange is set
+   */
+  SpectrumReceiverGrid m_receiverGrid;
+
   TracedCallback<Ptr<SpectrumPhy>, Ptr<SpectrumPhy>, double > m_propagationLossTrace;
 };
 
@@ -39,20 +39,38 @@ SpectrumConverter::SpectrumConverter (Ptr<const SpectrumModel> fromSpectrumModel
   m_fromSpectrumModel = fromSpectrumModel;
   m_toSpectrumModel = toSpectrumModel;
 
+  /*
+   * Each band of the destination model only overlaps a few contiguous bands
+   * of the source model: keep the coefficients from the first to the last
+   * overlapping band only, so that a conversion does not multiply the
+   * whole source value for each destination band.
+   */
   for (Bands::const_iterator toit = toSpectrumModel->Begin (); toit != toSpectrumModel->End (); ++toit)
     {
       std::vector<double> coeffs;
+      size_t first = 0;
 
-      for (Bands::const_iterator fromit = fromSpectrumModel->Begin (); fromit != fromSpectrumModel->End (); ++fromit)
+      size_t fromIndex = 0;
+      for (Bands::const_iterator fromit = fromSpectrumModel->Begin (); fromit != fromSpectrumModel->End (); ++fromit, ++fromIndex)
         {
           double c = GetCoefficient (*fromit, *toit);
           NS_LOG_LOGIC ("(" << fromit->fl << ","  << fromit->fh << ")"
                             << " --> " <<
                         "(" << toit->fl << "," << toit->fh << ")"
                             << " = " << c);
+          if (c == 0 && coeffs.empty ())
+            {
+              first = fromIndex + 1;
+              continue;
+            }
           coeffs.push_back (c);
         }
+      while (!coeffs.empty () && coeffs.back () == 0)
+        {
+          coeffs.pop_back ();
+        }
 
+      m_conversionOffsets.push_back (first);
       m_conversionMatrix.push_back (coeffs);
     }
 
@@ -78,14 +96,14 @@ SpectrumConverter::Convert (Ptr<const SpectrumValue> fvvf) const
   Ptr<SpectrumValue> tvvf = Create<SpectrumValue> (m_toSpectrumModel);
 
   Values::iterator tvit = tvvf->ValuesBegin ();
-
+  std::vector<size_t>::const_iterator offit = m_conversionOffsets.begin ();
 
   for (std::vector<std::vector<double> >::const_iterator toit = m_conversionMatrix.begin ();
        toit != m_conversionMatrix.end ();
-       ++toit)
+       ++toit, ++offit)
     {
       NS_ASSERT (tvit != tvvf->ValuesEnd ());
-      Values::const_iterator fvit = fvvf->ConstValuesBegin ();
+      Values::const_iterator fvit = fvvf->ConstValuesBegin () + *offit;
 
       double sum = 0;
       for (std::vector<double>::const_iterator fromit = toit->begin ();
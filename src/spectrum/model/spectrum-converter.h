@@ -78,7 +78,8 @@ private:
    */
   double GetCoefficient (const BandInfo& from, const BandInfo& to) const;
 
-  std::vector<std::vector<double> > m_conversionMatrix; // /< matrix of conversion coefficients
+  std::vector<std::vector<double> > m_conversionMatrix; // /< non-zero span of the conversion coefficients of each band
+  std::vector<size_t> m_conversionOffsets;  // /< index of the first "from" band of each span
   Ptr<const SpectrumModel> m_fromSpectrumModel;  // /<  the SpectrumModel this SpectrumConverter instance can convert from
   Ptr<const SpectrumModel> m_toSpectrumModel;    // /<  the SpectrumModel this SpectrumConverter instance can convert to
 
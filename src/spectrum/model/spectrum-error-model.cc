@@ -22,6 +22,11 @@
 
 #include <ns3/nstime.h>
 #include <ns3/log.h>
+#include <math.h>
+
+#ifdef __FreeBSD__
+#define log2(x) (log (x) / M_LN2)
+#endif
 
 NS_LOG_COMPONENT_DEFINE ("ShannonSpectrumErrorModel");
 
@@ -51,20 +56,21 @@ void
 ShannonSpectrumErrorModel::EvaluateChunk (const SpectrumValue& sinr, Time duration)
 {
   NS_LOG_FUNCTION (this << sinr << duration);
-  SpectrumValue CapacityPerHertz = Log2 (1 + sinr);
+  // the capacity per Hertz of each band is log2 (1 + sinr): compute it
+  // band by band rather than in temporary SpectrumValues.
   double capacity = 0;
 
-  Bands::const_iterator bi = CapacityPerHertz.ConstBandsBegin ();
-  Values::const_iterator vi = CapacityPerHertz.ConstValuesBegin ();
+  Bands::const_iterator bi = sinr.ConstBandsBegin ();
+  Values::const_iterator vi = sinr.ConstValuesBegin ();
 
-  while (bi != CapacityPerHertz.ConstBandsEnd ())
+  while (bi != sinr.ConstBandsEnd ())
     {
-      NS_ASSERT (vi != CapacityPerHertz.ConstValuesEnd ());
-      capacity += (bi->fh - bi->fl) * (*vi);
+      NS_ASSERT (vi != sinr.ConstValuesEnd ());
+      capacity += (bi->fh - bi->fl) * log2 (1 + *vi);
       ++bi;
       ++vi;
     }
-  NS_ASSERT (vi == CapacityPerHertz.ConstValuesEnd ());
+  NS_ASSERT (vi == sinr.ConstValuesEnd ());
   NS_LOG_LOGIC ("ChunkCapacity = " << capacity);
   m_deliverableBytes += static_cast<uint32_t> (capacity * duration.GetSeconds () / 8);
   NS_LOG_LOGIC ("DeliverableBytes = " << m_deliverableBytes);
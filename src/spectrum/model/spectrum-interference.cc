@@ -24,6 +24,7 @@
 
 #include <ns3/simulator.h>
 #include <ns3/log.h>
+#include <algorithm>
 
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumInterference");
@@ -36,6 +37,10 @@ SpectrumInterference::SpectrumInterference ()
     m_rxSignal (0),
     m_allSignals (0),
     m_noise (0),
+    m_sinr (0),
+    m_rxFirst (0),
+    m_rxEnd (0),
+    m_numSignals (0),
     m_errorModel (0)
 {
   NS_LOG_FUNCTION (this);
@@ -53,6 +58,7 @@ SpectrumInterference::DoDispose ()
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
+  m_sinr = 0;
   m_errorModel = 0;
   Object::DoDispose ();
 }
@@ -64,6 +70,9 @@ SpectrumInterference::StartRx (Ptr<const Packet> p, Ptr<const SpectrumValue> rxP
   m_rxSignal = rxPsd;
   m_lastChangeTime = Now ();
   m_receiving = true;
+  FindBands (rxPsd, m_rxFirst, m_rxEnd);
+  *m_sinr = 0;
+  UpdateSinr (m_rxFirst, m_rxEnd);
   m_errorModel->StartRx (p);
 }
 
@@ -82,27 +91,95 @@ void
 SpectrumInterference::AddSignal (Ptr<const SpectrumValue> spd, const Time duration)
 {
   NS_LOG_FUNCTION (this << *spd << duration);
-  DoAddSignal (spd);
-  Simulator::Schedule (duration, &SpectrumInterference::DoSubtractSignal, this, spd);
+  NS_ASSERT (spd->GetSpectrumModel () == m_allSignals->GetSpectrumModel ());
+  uint32_t first;
+  uint32_t end;
+  FindBands (spd, first, end);
+  DoAddSignal (spd, first, end);
+  Simulator::Schedule (duration, &SpectrumInterference::DoSubtractSignal, this, spd, first, end);
 }
 
 
 void
-SpectrumInterference::DoAddSignal  (Ptr<const SpectrumValue> spd)
+SpectrumInterference::DoAddSignal  (Ptr<const SpectrumValue> spd, uint32_t first, uint32_t end)
 {
-  NS_LOG_FUNCTION (this << *spd);
+  NS_LOG_FUNCTION (this << *spd << first << end);
   ConditionallyEvaluateChunk ();
-  (*m_allSignals) += (*spd);
+  Values::iterator all = m_allSignals->ValuesBegin ();
+  Values::const_iterator s = spd->ConstValuesBegin ();
+  for (uint32_t i = first; i < end; ++i)
+    {
+      all[i] += s[i];
+    }
+  m_numSignals++;
   m_lastChangeTime = Now ();
+  UpdateSinr (first, end);
 }
 
 void
-SpectrumInterference::DoSubtractSignal  (Ptr<const SpectrumValue> spd)
+SpectrumInterference::DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t first, uint32_t end)
 {
-  NS_LOG_FUNCTION (this << *spd);
+  NS_LOG_FUNCTION (this << *spd << first << end);
   ConditionallyEvaluateChunk ();
-  (*m_allSignals) -= (*spd);
+  NS_ASSERT (m_numSignals > 0);
+  m_numSignals--;
+  if (m_numSignals == 0)
+    {
+      // do not carry the rounding errors of the sum over to the next signals
+      *m_allSignals = 0;
+      first = m_rxFirst;
+      end = m_rxEnd;
+    }
+  else
+    {
+      Values::iterator all = m_allSignals->ValuesBegin ();
+      Values::const_iterator s = spd->ConstValuesBegin ();
+      for (uint32_t i = first; i < end; ++i)
+        {
+          all[i] -= s[i];
+        }
+    }
   m_lastChangeTime = Now ();
+  UpdateSinr (first, end);
+}
+
+void
+SpectrumInterference::UpdateSinr (uint32_t first, uint32_t end)
+{
+  if (!m_receiving)
+    {
+      return;
+    }
+  first = std::max (first, m_rxFirst);
+  end = std::min (end, m_rxEnd);
+  Values::iterator sinr = m_sinr->ValuesBegin ();
+  Values::const_iterator rx = m_rxSignal->ConstValuesBegin ();
+  Values::const_iterator all = m_allSignals->ConstValuesBegin ();
+  Values::const_iterator noise = m_noise->ConstValuesBegin ();
+  for (uint32_t i = first; i < end; ++i)
+    {
+      sinr[i] = rx[i] / (all[i] - rx[i] + noise[i]);
+    }
+}
+
+void
+SpectrumInterference::FindBands (Ptr<const SpectrumValue> spd, uint32_t &first, uint32_t &end)
+{
+  Values::const_iterator begin = spd->ConstValuesBegin ();
+  Values::const_iterator it = begin;
+  while (it != spd->ConstValuesEnd () && *it == 0)
+    {
+      ++it;
+    }
+  first = it - begin;
+  end = first;
+  for (uint32_t i = first; it != spd->ConstValuesEnd (); ++it, ++i)
+    {
+      if (*it != 0)
+        {
+          end = i + 1;
+        }
+    }
 }
 
 
@@ -116,10 +193,9 @@ SpectrumInterference::ConditionallyEvaluateChunk ()
   NS_LOG_LOGIC ("if condition: " << condition);
   if (condition)
     {
-      SpectrumValue sinr = (*m_rxSignal) / ((*m_allSignals) - (*m_rxSignal) + (*m_noise));
       Time duration = Now () - m_lastChangeTime;
       NS_LOG_LOGIC ("calling m_errorModel->EvaluateChunk (sinr, duration)");
-      m_errorModel->EvaluateChunk (sinr, duration);
+      m_errorModel->EvaluateChunk (*m_sinr, duration);
     }
 }
 
@@ -133,6 +209,7 @@ SpectrumInterference::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noi
   // we'll now create a zeroed SpectrumValue using the same
   // SpectrumModel which is being specified for the noise.
   m_allSignals = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
+  m_sinr = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
 }
 
 void
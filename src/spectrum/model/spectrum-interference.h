@@ -42,6 +42,14 @@ class SpectrumErrorModel;
  * This class implements a gaussian interference model, i.e., all
  * incoming signals are added to the total interference.
  *
+ * The total power spectral density is a running sum: each signal is
+ * added when it starts and subtracted when it ends, in the bands where
+ * its power spectral density is not zero only. During a RX attempt, the
+ * SINR of the signal being received is kept up to date in the same way:
+ * a change recomputes it only in the bands shared by the changing signal
+ * and the signal being received, and each chunk is evaluated with it
+ * without any further computation. Any SpectrumPhy can use this class
+ * to model the interference of its incoming signals.
  */
 class SpectrumInterference : public Object
 {
@@ -103,8 +111,27 @@ protected:
 
 private:
   void ConditionallyEvaluateChunk ();
-  void DoAddSignal  (Ptr<const SpectrumValue> spd);
-  void DoSubtractSignal  (Ptr<const SpectrumValue> spd);
+  void DoAddSignal  (Ptr<const SpectrumValue> spd, uint32_t first, uint32_t end);
+  void DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t first, uint32_t end);
+
+  /**
+   * Recomputes the SINR of the signal being received in the bands
+   * [first, end) which it shares with it, if a RX attempt is ongoing.
+   *
+   * @param first the first band which changed
+   * @param end the band after the last band which changed
+   */
+  void UpdateSinr (uint32_t first, uint32_t end);
+
+  /**
+   * Finds the bands in which a power spectral density is not zero.
+   *
+   * @param spd the power spectral density
+   * @param first the first band in which spd is not zero
+   * @param end the band after the last band in which spd is not zero, or
+   * first if spd is zero in all the bands
+   */
+  static void FindBands (Ptr<const SpectrumValue> spd, uint32_t &first, uint32_t &end);
 
 
 
@@ -122,6 +149,17 @@ private:
 
   Ptr<const SpectrumValue> m_noise;
 
+  Ptr<SpectrumValue> m_sinr; /**< the SINR of the signal whose RX is being
+                              * attempted, valid in the bands [m_rxFirst,
+                              * m_rxEnd) during the RX attempt and zero
+                              * outside them
+                              */
+
+  uint32_t m_rxFirst; /**< the first band of the signal being RX */
+  uint32_t m_rxEnd;   /**< the band after the last band of the signal being RX */
+
+  uint32_t m_numSignals; /**< the number of signals in m_allSignals */
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
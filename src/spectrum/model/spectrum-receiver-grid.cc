@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/simulator.h>
+#include <ns3/mobility-model.h>
+#include <ns3/spectrum-phy.h>
+#include "spectrum-receiver-grid.h"
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumReceiverGrid");
+
+namespace ns3 {
+
+SpectrumReceiverGrid::SpectrumReceiverGrid ()
+  : m_range (0),
+    m_maxSpeed (0),
+    m_valid (false)
+{
+}
+
+SpectrumReceiverGrid::~SpectrumReceiverGrid ()
+{
+  Clear ();
+}
+
+void
+SpectrumReceiverGrid::SetRange (double range)
+{
+  NS_LOG_FUNCTION (this << range);
+  NS_ASSERT (range >= 0);
+  m_range = range;
+  m_valid = false;
+}
+
+double
+SpectrumReceiverGrid::GetRange (void) const
+{
+  return m_range;
+}
+
+void
+SpectrumReceiverGrid::Add (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  struct Receiver receiver;
+  receiver.phy = phy;
+  m_receivers.push_back (receiver);
+  m_valid = false;
+}
+
+void
+SpectrumReceiverGrid::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  DisconnectAll ();
+  m_receivers.clear ();
+  m_unlocated.clear ();
+  m_cells.clear ();
+  m_valid = false;
+}
+
+void
+SpectrumReceiverGrid::DisconnectAll (void)
+{
+  for (MobilityMap::iterator i = m_mobilities.begin (); i != m_mobilities.end (); ++i)
+    {
+      i->second.mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                         MakeCallback (&SpectrumReceiverGrid::CourseChanged, this));
+    }
+  m_mobilities.clear ();
+}
+
+SpectrumReceiverGrid::Cell
+SpectrumReceiverGrid::GetCell (double x, double y) const
+{
+  return Cell (static_cast<int64_t> (std::floor (x / m_range)),
+               static_cast<int64_t> (std::floor (y / m_range)));
+}
+
+void
+SpectrumReceiverGrid::Rebuild (void)
+{
+  NS_LOG_FUNCTION (this);
+  DisconnectAll ();
+  m_unlocated.clear ();
+  m_cells.clear ();
+  m_maxSpeed = 0;
+  for (uint32_t i = 0; i < m_receivers.size (); i++)
+    {
+      struct Receiver &receiver = m_receivers[i];
+      receiver.mobility = receiver.phy->GetMobility ();
+      if (receiver.mobility == 0)
+        {
+          m_unlocated.push_back (i);
+          continue;
+        }
+      MobilityMap::iterator j = m_mobilities.find (PeekPointer (receiver.mobility));
+      if (j == m_mobilities.end ())
+        {
+          // several receivers of a node share its mobility model.
+          j = m_mobilities.insert (std::make_pair (PeekPointer (receiver.mobility), Mobility ())).first;
+          j->second.mobility = receiver.mobility;
+          receiver.mobility->TraceConnectWithoutContext ("CourseChange",
+                                                         MakeCallback (&SpectrumReceiverGrid::CourseChanged, this));
+          NotifySpeed (receiver.mobility);
+        }
+      j->second.receivers.push_back (i);
+      Locate (i);
+    }
+  m_buildTime = Simulator::Now ();
+  m_valid = true;
+}
+
+void
+SpectrumReceiverGrid::Locate (uint32_t receiver)
+{
+  Vector position = m_receivers[receiver].mobility->GetPosition ();
+  Cell cell = GetCell (position.x, position.y);
+  m_receivers[receiver].cell = cell;
+  m_cells[cell].push_back (receiver);
+}
+
+void
+SpectrumReceiverGrid::Unlocate (uint32_t receiver)
+{
+  CellMap::iterator i = m_cells.find (m_receivers[receiver].cell);
+  NS_ASSERT (i != m_cells.end ());
+  std::vector<uint32_t>::iterator j = std::find (i->second.begin (), i->second.end (), receiver);
+  NS_ASSERT (j != i->second.end ());
+  i->second.erase (j);
+  if (i->second.empty ())
+    {
+      m_cells.erase (i);
+    }
+}
+
+void
+SpectrumReceiverGrid::NotifySpeed (Ptr<const MobilityModel> mobility)
+{
+  Vector velocity = mobility->GetVelocity ();
+  double speed = std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z);
+  m_maxSpeed = std::max (m_maxSpeed, speed);
+}
+
+void
+SpectrumReceiverGrid::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  MobilityMap::iterator i = m_mobilities.find (PeekPointer (mobility));
+  NS_ASSERT (i != m_mobilities.end ());
+  // the receiver is indexed at its new position after the index was
+  // built, from where it drifts at most at its new speed.
+  NotifySpeed (mobility);
+  for (std::vector<uint32_t>::const_iterator j = i->second.receivers.begin (); j != i->second.receivers.end (); ++j)
+    {
+      Unlocate (*j);
+      Locate (*j);
+    }
+}
+
+void
+SpectrumReceiverGrid::GetReceivers (Ptr<MobilityModel> txMobility, std::vector<uint32_t> &receivers)
+{
+  NS_LOG_FUNCTION (this << txMobility);
+  NS_ASSERT (m_range > 0);
+  Time now = Simulator::Now ();
+  if (!m_valid || now < m_buildTime
+      || m_maxSpeed * (now - m_buildTime).GetSeconds () > m_range / 2)
+    {
+      Rebuild ();
+    }
+  double reach = m_range + m_maxSpeed * (now - m_buildTime).GetSeconds ();
+  Vector position = txMobility->GetPosition ();
+  Cell low = GetCell (position.x - reach, position.y - reach);
+  Cell high = GetCell (position.x + reach, position.y + reach);
+
+  receivers.clear ();
+  for (int64_t x = low.first; x <= high.first; x++)
+    {
+      for (int64_t y = low.second; y <= high.second; y++)
+        {
+          CellMap::const_iterator i = m_cells.find (Cell (x, y));
+          if (i == m_cells.end ())
+            {
+              continue;
+            }
+          for (std::vector<uint32_t>::const_iterator j = i->second.begin (); j != i->second.end (); ++j)
+            {
+              if (CalculateDistance (m_receivers[*j].mobility->GetPosition (), position) <= m_range)
+                {
+                  receivers.push_back (*j);
+                }
+            }
+        }
+    }
+  receivers.insert (receivers.end (), m_unlocated.begin (), m_unlocated.end ());
+  std::sort (receivers.begin (), receivers.end ());
+  NS_LOG_LOGIC (receivers.size () << " of " << m_receivers.size () << " receivers in range");
+}
+
+} // namespace ns3
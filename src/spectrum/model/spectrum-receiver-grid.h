@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPECTRUM_RECEIVER_GRID_H
+#define SPECTRUM_RECEIVER_GRID_H
+
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include <ns3/ptr.h>
+#include <ns3/nstime.h>
+
+namespace ns3 {
+
+class SpectrumPhy;
+class MobilityModel;
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief Grid index of the positions of the receivers of a SpectrumChannel.
+ *
+ * The receivers are stored in square cells of the xy plane whose side is
+ * the range, so that the receivers within range of a transmitter are found
+ * in the few cells around it instead of computing the distance from the
+ * transmitter to every receiver of the channel.
+ *
+ * A receiver is moved to its new cell when its MobilityModel reports a
+ * course change.  Between two course changes, a receiver drifts from its
+ * indexed position by at most the highest speed of the receivers times
+ * the time since the index was built: the cells within this drift of the
+ * range are searched, and the index is rebuilt once the drift reaches half
+ * the range.  Mobility models whose speed changes without a course change,
+ * such as ConstantAccelerationMobilityModel, break this bound.
+ *
+ * The mobility model of a receiver is read from its SpectrumPhy when the
+ * index is built, so that the mobility may be set after the receiver is
+ * added to the channel but before the first transmission.
+ */
+class SpectrumReceiverGrid
+{
+public:
+  SpectrumReceiverGrid ();
+  ~SpectrumReceiverGrid ();
+
+  /**
+   * \param range the range in meters, or zero to disable the index.
+   */
+  void SetRange (double range);
+  /**
+   * \returns the range in meters, or zero when the index is disabled.
+   */
+  double GetRange (void) const;
+  /**
+   * \param phy the receiver to add, whose index is the number of receivers
+   *        added before it.
+   */
+  void Add (Ptr<SpectrumPhy> phy);
+  /**
+   * \brief Remove all the receivers.
+   */
+  void Clear (void);
+  /**
+   * \param txMobility the mobility model of the transmitter.
+   * \param receivers the indexes, in increasing order, of the receivers
+   *        within range of the transmitter and of those without a mobility
+   *        model.
+   */
+  void GetReceivers (Ptr<MobilityModel> txMobility, std::vector<uint32_t> &receivers);
+
+private:
+  SpectrumReceiverGrid (SpectrumReceiverGrid const &);
+  SpectrumReceiverGrid &operator = (SpectrumReceiverGrid const &);
+
+  typedef std::pair<int64_t, int64_t> Cell;
+
+  struct Receiver
+  {
+    Ptr<SpectrumPhy> phy;
+    Ptr<MobilityModel> mobility;
+    Cell cell;
+  };
+  struct Mobility
+  {
+    Ptr<MobilityModel> mobility;
+    std::vector<uint32_t> receivers;
+  };
+  typedef std::map<Cell, std::vector<uint32_t> > CellMap;
+  typedef std::map<const MobilityModel *, struct Mobility> MobilityMap;
+
+  Cell GetCell (double x, double y) const;
+  void Rebuild (void);
+  void Locate (uint32_t receiver);
+  void Unlocate (uint32_t receiver);
+  void NotifySpeed (Ptr<const MobilityModel> mobility);
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  void DisconnectAll (void);
+
+  std::vector<struct Receiver> m_receivers;
+  std::vector<uint32_t> m_unlocated;
+  CellMap m_cells;
+  MobilityMap m_mobilities;
+  double m_range;
+  double m_maxSpeed;
+  Time m_buildTime;
+  bool m_valid;
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_RECEIVER_GRID_H */
@@ -21,6 +21,7 @@
 
 #include <ns3/spectrum-value.h>
 #include <math.h>
+#include <algorithm>
 #include <ns3/log.h>
 
 #ifdef __FreeBSD__
@@ -104,20 +105,33 @@ SpectrumValue::ConstBandsEnd () const
 }
 
 
+/*
+ * The operations below run over the contiguous storage of the values with
+ * an index, so that the compiler can vectorize them. Both operands of a
+ * component-by-component operation must share the same (immutable)
+ * SpectrumModel: a value is never converted implicitly.
+ */
+
 void
-SpectrumValue::Add (const SpectrumValue& x)
+SpectrumValue::CheckSpectrumModel (const SpectrumValue& x) const
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
-  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT_MSG (m_spectrumModel == x.m_spectrumModel,
+                 "operands defined over different SpectrumModels (uid "
+                 << (m_spectrumModel == 0 ? 0 : m_spectrumModel->GetUid ()) << " and "
+                 << (x.m_spectrumModel == 0 ? 0 : x.m_spectrumModel->GetUid ()) << ")");
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+}
 
-  while (it1 != m_values.end ())
+void
+SpectrumValue::Add (const SpectrumValue& x)
+{
+  CheckSpectrumModel (x);
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  const double *w = n > 0 ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v[i] += w[i];
     }
 }
 
@@ -125,12 +139,11 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
@@ -139,17 +152,13 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
-  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  CheckSpectrumModel (x);
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  const double *w = n > 0 ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v[i] -= w[i];
     }
 }
 
@@ -165,17 +174,13 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
-  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  CheckSpectrumModel (x);
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  const double *w = n > 0 ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v[i] *= w[i];
     }
 }
 
@@ -183,12 +188,11 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
@@ -198,17 +202,13 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
-  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  CheckSpectrumModel (x);
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  const double *w = n > 0 ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v[i] /= w[i];
     }
 }
 
@@ -217,12 +217,11 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] /= s;
     }
 }
 
@@ -232,12 +231,11 @@ SpectrumValue::Divide (double s)
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = -(*it1);
-      ++it1;
+      v[i] = -v[i];
     }
 }
 
@@ -245,34 +243,26 @@ SpectrumValue::ChangeSign ()
 void
 SpectrumValue::ShiftLeft (int n)
 {
-  int i = 0;
-  while (i < (int) m_values.size () - n)
-    {
-      m_values.at (i) = m_values.at (i + n);
-      i++;
-    }
-  while (i < (int)m_values.size ())
+  if (n >= (int) m_values.size ())
     {
-      m_values.at (i) = 0;
-      i++;
+      std::fill (m_values.begin (), m_values.end (), 0.0);
+      return;
     }
+  std::copy (m_values.begin () + n, m_values.end (), m_values.begin ());
+  std::fill (m_values.end () - n, m_values.end (), 0.0);
 }
 
 
 void
 SpectrumValue::ShiftRight (int n)
 {
-  int i = m_values.size () - 1;
-  while (i - n >= 0)
+  if (n >= (int) m_values.size ())
     {
-      m_values.at (i) = m_values.at (i - n);
-      i = i - 1;
-    }
-  while (i >= 0)
-    {
-      m_values.at (i) = 0;
-      --i;
+      std::fill (m_values.begin (), m_values.end (), 0.0);
+      return;
     }
+  std::copy_backward (m_values.begin (), m_values.end () - n, m_values.end ());
+  std::fill (m_values.begin (), m_values.begin () + n, 0.0);
 }
 
 
@@ -281,12 +271,11 @@ void
 SpectrumValue::Pow (double exp)
 {
   NS_LOG_FUNCTION (this << exp);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = pow (*it1, exp);
-      ++it1;
+      v[i] = pow (v[i], exp);
     }
 }
 
@@ -295,12 +284,11 @@ void
 SpectrumValue::Exp (double base)
 {
   NS_LOG_FUNCTION (this << base);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = pow (base, *it1);
-      ++it1;
+      v[i] = pow (base, v[i]);
     }
 }
 
@@ -309,12 +297,11 @@ void
 SpectrumValue::Log10 ()
 {
   NS_LOG_FUNCTION (this);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = log10 (*it1);
-      ++it1;
+      v[i] = log10 (v[i]);
     }
 }
 
@@ -322,12 +309,11 @@ void
 SpectrumValue::Log2 ()
 {
   NS_LOG_FUNCTION (this);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = log2 (*it1);
-      ++it1;
+      v[i] = log2 (v[i]);
     }
 }
 
@@ -336,12 +322,11 @@ void
 SpectrumValue::Log ()
 {
   NS_LOG_FUNCTION (this);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  size_t n = m_values.size ();
+  double *v = n > 0 ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = log (*it1);
-      ++it1;
+      v[i] = log (v[i]);
     }
 }
 
@@ -462,9 +447,8 @@ operator+ (double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
+  SpectrumValue res = lhs;
+  res.Subtract (rhs);
   return res;
 }
 
@@ -659,13 +643,7 @@ SpectrumValue:: operator/= (double rhs)
 SpectrumValue&
 SpectrumValue:: operator= (double rhs)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 = rhs;
-      ++it1;
-    }
+  std::fill (m_values.begin (), m_values.end (), rhs);
   return *this;
 }
 
@@ -498,6 +498,14 @@ public:
 
 
 private:
+  /**
+   * Checks, when asserts are enabled, that x is defined over the same
+   * SpectrumModel as *this.
+   *
+   * @param x the other operand of a component-by-component operation
+   */
+  void CheckSpectrumModel (const SpectrumValue& x) const;
+
   void Add (const SpectrumValue& x);
   void Add (double s);
   void Subtract (const SpectrumValue& x);
@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/object.h>
+#include <ns3/log.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/random-variable.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/net-device.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <algorithm>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumChannelTest");
+
+namespace ns3 {
+
+
+// a SpectrumPhy which reports the signals it receives.
+class SpectrumChannelTestPhy : public SpectrumPhy
+{
+public:
+  SpectrumChannelTestPhy ();
+
+  void SetRxSpectrumModel (Ptr<const SpectrumModel> model);
+  void SetRxCallback (Callback<void, Ptr<SpectrumChannelTestPhy>, Ptr<SpectrumSignalParameters> > callback);
+
+  // inherited from SpectrumPhy
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice ();
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+private:
+  virtual void DoDispose (void);
+
+  Ptr<MobilityModel> m_mobility;
+  Ptr<const SpectrumModel> m_model;
+  Callback<void, Ptr<SpectrumChannelTestPhy>, Ptr<SpectrumSignalParameters> > m_rxCallback;
+};
+
+SpectrumChannelTestPhy::SpectrumChannelTestPhy ()
+{
+}
+
+void
+SpectrumChannelTestPhy::DoDispose (void)
+{
+  m_mobility = 0;
+  m_model = 0;
+  m_rxCallback = MakeNullCallback<void, Ptr<SpectrumChannelTestPhy>, Ptr<SpectrumSignalParameters> > ();
+  SpectrumPhy::DoDispose ();
+}
+
+void
+SpectrumChannelTestPhy::SetRxSpectrumModel (Ptr<const SpectrumModel> model)
+{
+  m_model = model;
+}
+
+void
+SpectrumChannelTestPhy::SetRxCallback (Callback<void, Ptr<SpectrumChannelTestPhy>, Ptr<SpectrumSignalParameters> > callback)
+{
+  m_rxCallback = callback;
+}
+
+void
+SpectrumChannelTestPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+SpectrumChannelTestPhy::GetDevice ()
+{
+  return 0;
+}
+
+void
+SpectrumChannelTestPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+SpectrumChannelTestPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+SpectrumChannelTestPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+SpectrumChannelTestPhy::GetRxSpectrumModel () const
+{
+  return m_model;
+}
+
+void
+SpectrumChannelTestPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  m_rxCallback (this, params);
+}
+
+
+
+/*
+ * Moving receivers change their course at random times while random
+ * transmitters send signals through a channel with a MaxRange: the signals
+ * must reach exactly the receivers within range at the time of the
+ * transmission, and those without mobility, in the order in which the
+ * channel delivers them without the index.
+ */
+class SpectrumChannelMaxRangeTestCase : public TestCase
+{
+public:
+  SpectrumChannelMaxRangeTestCase (bool multiModel);
+
+private:
+  virtual void DoRun (void);
+  void Transmit (uint32_t tx);
+  void ChangeCourse (uint32_t phy, Vector velocity);
+  void Receive (Ptr<SpectrumChannelTestPhy> phy, Ptr<SpectrumSignalParameters> params);
+
+  bool m_multiModel;
+  double m_range;
+  Ptr<SpectrumChannel> m_channel;
+  std::vector<Ptr<SpectrumChannelTestPhy> > m_phys;
+  // the transmitter and receiver of each expected or actual reception.
+  std::vector<std::pair<uint32_t, uint32_t> > m_expected;
+  std::vector<std::pair<uint32_t, uint32_t> > m_received;
+};
+
+SpectrumChannelMaxRangeTestCase::SpectrumChannelMaxRangeTestCase (bool multiModel)
+  : TestCase (multiModel ? "Receivers within MaxRange of a MultiModelSpectrumChannel"
+              : "Receivers within MaxRange of a SingleModelSpectrumChannel"),
+    m_multiModel (multiModel),
+    m_range (150)
+{
+}
+
+void
+SpectrumChannelMaxRangeTestCase::Transmit (uint32_t tx)
+{
+  Ptr<MobilityModel> txMobility = m_phys[tx]->GetMobility ();
+  std::vector<std::pair<SpectrumModelUid_t, uint32_t> > receivers;
+  for (uint32_t i = 0; i < m_phys.size (); i++)
+    {
+      Ptr<MobilityModel> rxMobility = m_phys[i]->GetMobility ();
+      if (i != tx && (txMobility == 0 || rxMobility == 0
+                      || CalculateDistance (txMobility->GetPosition (), rxMobility->GetPosition ()) <= m_range))
+        {
+          // the multi-model channel delivers the receivers of each SpectrumModel in turn.
+          SpectrumModelUid_t uid = m_multiModel ? m_phys[i]->GetRxSpectrumModel ()->GetUid () : 0;
+          receivers.push_back (std::make_pair (uid, i));
+        }
+    }
+  std::sort (receivers.begin (), receivers.end ());
+  for (uint32_t i = 0; i < receivers.size (); i++)
+    {
+      m_expected.push_back (std::make_pair (tx, receivers[i].second));
+    }
+
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->psd = Create<SpectrumValue> (m_phys[tx]->GetRxSpectrumModel ());
+  *(params->psd) = 1.0;
+  params->duration = MilliSeconds (1);
+  params->txPhy = m_phys[tx];
+  m_channel->StartTx (params);
+}
+
+void
+SpectrumChannelMaxRangeTestCase::ChangeCourse (uint32_t phy, Vector velocity)
+{
+  m_phys[phy]->GetMobility ()->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (velocity);
+}
+
+void
+SpectrumChannelMaxRangeTestCase::Receive (Ptr<SpectrumChannelTestPhy> phy, Ptr<SpectrumSignalParameters> params)
+{
+  uint32_t tx = std::find (m_phys.begin (), m_phys.end (), params->txPhy) - m_phys.begin ();
+  uint32_t rx = std::find (m_phys.begin (), m_phys.end (), phy) - m_phys.begin ();
+  m_received.push_back (std::make_pair (tx, rx));
+  NS_TEST_EXPECT_MSG_EQ (params->psd->GetSpectrumModelUid (), phy->GetRxSpectrumModel ()->GetUid (),
+                         "Signal not converted to the SpectrumModel of the receiver");
+}
+
+void
+SpectrumChannelMaxRangeTestCase::DoRun (void)
+{
+  UniformVariable random;
+  std::vector<double> freqs1;
+  std::vector<double> freqs2;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      freqs1.push_back (2.400e9 + i * 5e6);
+      freqs2.push_back (2.402e9 + i * 10e6);
+    }
+  Ptr<const SpectrumModel> model1 = Create<SpectrumModel> (freqs1);
+  Ptr<const SpectrumModel> model2 = Create<SpectrumModel> (freqs2);
+
+  if (m_multiModel)
+    {
+      m_channel = CreateObject<MultiModelSpectrumChannel> ();
+    }
+  else
+    {
+      m_channel = CreateObject<SingleModelSpectrumChannel> ();
+    }
+  m_channel->SetAttribute ("MaxRange", DoubleValue (m_range));
+
+  const uint32_t nPhys = 60;
+  const uint32_t nUnlocated = 2;
+  for (uint32_t i = 0; i < nPhys; i++)
+    {
+      Ptr<SpectrumChannelTestPhy> phy = CreateObject<SpectrumChannelTestPhy> ();
+      phy->SetRxSpectrumModel (m_multiModel && i % 2 ? model2 : model1);
+      phy->SetRxCallback (MakeCallback (&SpectrumChannelMaxRangeTestCase::Receive, this));
+      m_channel->AddRx (phy);
+      m_phys.push_back (phy);
+    }
+  // the mobility is set after the receivers are added to the channel, as
+  // when the mobility is installed on the nodes after their devices.
+  for (uint32_t i = nUnlocated; i < nPhys; i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (random.GetValue (0, 1000), random.GetValue (0, 1000), 0));
+      mobility->SetVelocity (Vector (random.GetValue (-15, 15), random.GetValue (-15, 15), 0));
+      m_phys[i]->SetMobility (mobility);
+    }
+
+  for (uint32_t i = 0; i < 400; i++)
+    {
+      Simulator::Schedule (Seconds (random.GetValue (0, 100)), &SpectrumChannelMaxRangeTestCase::ChangeCourse, this,
+                           random.GetInteger (nUnlocated, nPhys - 1),
+                           Vector (random.GetValue (-25, 25), random.GetValue (-25, 25), 0));
+    }
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      Simulator::Schedule (Seconds (random.GetValue (0, 100)), &SpectrumChannelMaxRangeTestCase::Transmit, this,
+                           random.GetInteger (0, nPhys - 1));
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), m_expected.size (), "Wrong number of receptions");
+  NS_TEST_ASSERT_MSG_LT (m_expected.size (), 300 * (nPhys - 1), "No receiver beyond range");
+  for (uint32_t i = 0; i < m_expected.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_received[i].first, m_expected[i].first, "Wrong transmitter of reception " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_received[i].second, m_expected[i].second, "Wrong receiver of reception " << i);
+    }
+
+  m_channel->Dispose ();
+  m_channel = 0;
+  for (uint32_t i = 0; i < m_phys.size (); i++)
+    {
+      m_phys[i]->Dispose ();
+    }
+  m_phys.clear ();
+}
+
+
+
+class SpectrumChannelTestSuite : public TestSuite
+{
+public:
+  SpectrumChannelTestSuite ();
+};
+
+SpectrumChannelTestSuite::SpectrumChannelTestSuite ()
+  : TestSuite ("spectrum-channel", UNIT)
+{
+  AddTestCase (new SpectrumChannelMaxRangeTestCase (false));
+  AddTestCase (new SpectrumChannelMaxRangeTestCase (true));
+}
+
+static SpectrumChannelTestSuite g_spectrumChannelTestSuite;
+
+} // namespace ns3
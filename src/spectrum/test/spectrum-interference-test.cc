@@ -26,7 +26,9 @@
 #include <ns3/simulator.h>
 #include <ns3/packet.h>
 #include <ns3/ptr.h>
+#include <ns3/random-variable.h>
 #include <iostream>
+#include <vector>
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumInterferenceTest");
 
@@ -131,6 +133,145 @@ SpectrumInterferenceTestCase::RetrieveTestResult (SpectrumInterference* si)
 
 
 
+/**
+ * Error model which records the SINR of the evaluated chunks.
+ */
+class SinrRecorderErrorModel : public SpectrumErrorModel
+{
+public:
+  virtual void StartRx (Ptr<const Packet> p)
+  {
+  }
+  virtual void EvaluateChunk (const SpectrumValue& sinr, Time duration)
+  {
+    m_chunks.push_back (Chunk (Now () - duration, Now (), sinr));
+  }
+  virtual bool IsRxCorrect ()
+  {
+    return true;
+  }
+
+  struct Chunk
+  {
+    Chunk (Time s, Time e, SpectrumValue v)
+      : start (s), end (e), sinr (v)
+    {
+    }
+    Time start;
+    Time end;
+    SpectrumValue sinr;
+  };
+  std::vector<Chunk> m_chunks;
+};
+
+
+
+class SpectrumInterferenceBandsTestCase : public TestCase
+{
+public:
+  SpectrumInterferenceBandsTestCase ();
+  virtual void DoRun (void);
+
+private:
+  struct Signal
+  {
+    Ptr<SpectrumValue> psd;
+    Time start;
+    Time end;
+  };
+  Ptr<SpectrumValue> CreateSignal (UniformVariable &random, Ptr<const SpectrumModel> m,
+                                   uint32_t first, uint32_t end);
+};
+
+SpectrumInterferenceBandsTestCase::SpectrumInterferenceBandsTestCase ()
+  : TestCase ("Check the SINR of narrow band signals overlapping the signal being received")
+{
+}
+
+Ptr<SpectrumValue>
+SpectrumInterferenceBandsTestCase::CreateSignal (UniformVariable &random, Ptr<const SpectrumModel> m,
+                                                 uint32_t first, uint32_t end)
+{
+  Ptr<SpectrumValue> psd = Create<SpectrumValue> (m);
+  for (uint32_t i = first; i < end; i++)
+    {
+      (*psd)[i] = random.GetValue (1e-17, 1e-15);
+    }
+  return psd;
+}
+
+void
+SpectrumInterferenceBandsTestCase::DoRun (void)
+{
+  UniformVariable random;
+  const uint32_t numBands = 20;
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < numBands; i++)
+    {
+      freqs.push_back (2.4e9 + i * 1e6);
+    }
+  Ptr<SpectrumModel> m = Create<SpectrumModel> (freqs);
+  Ptr<SpectrumValue> n = Create<SpectrumValue> (m);
+  *n = 4e-19;
+
+  Ptr<SinrRecorderErrorModel> recorder = CreateObject<SinrRecorderErrorModel> ();
+  SpectrumInterference si;
+  si.SetErrorModel (recorder);
+  si.SetNoisePowerSpectralDensity (n);
+
+  // the signal being received, from 2 s to 6 s in the bands 5 to 14.
+  std::vector<Signal> signals;
+  Signal rx;
+  rx.psd = CreateSignal (random, m, 5, 15);
+  rx.start = Seconds (2);
+  rx.end = Seconds (6);
+  signals.push_back (rx);
+  Simulator::Schedule (rx.start, &SpectrumInterference::AddSignal, &si, rx.psd, rx.end - rx.start);
+  Simulator::Schedule (rx.start, &SpectrumInterference::StartRx, &si, Create<Packet> (100), rx.psd);
+  Simulator::Schedule (rx.end, &SpectrumInterference::EndRx, &si);
+
+  // interferers over a few bands, some outside the bands of the signal
+  for (uint32_t k = 0; k < 40; k++)
+    {
+      uint32_t first = random.GetInteger (0, numBands - 1);
+      uint32_t end = std::min (numBands, first + random.GetInteger (1, 5));
+      Signal interferer;
+      interferer.psd = CreateSignal (random, m, first, end);
+      interferer.start = MilliSeconds (random.GetInteger (0, 7000));
+      interferer.end = interferer.start + MilliSeconds (random.GetInteger (1, 2000));
+      signals.push_back (interferer);
+      Simulator::Schedule (interferer.start, &SpectrumInterference::AddSignal, &si,
+                           interferer.psd, interferer.end - interferer.start);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Time total = Seconds (0);
+  for (uint32_t c = 0; c < recorder->m_chunks.size (); c++)
+    {
+      SinrRecorderErrorModel::Chunk &chunk = recorder->m_chunks[c];
+      total += chunk.end - chunk.start;
+      // the signals change at the bounds of the chunks only
+      SpectrumValue all (m);
+      for (uint32_t k = 0; k < signals.size (); k++)
+        {
+          if (signals[k].start < chunk.end && signals[k].end > chunk.start)
+            {
+              all += *signals[k].psd;
+            }
+        }
+      SpectrumValue expected = *rx.psd / (all - *rx.psd + *n);
+      for (uint32_t i = 0; i < numBands; i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (chunk.sinr[i], expected[i], expected[i] * 1e-9,
+                                     "Wrong SINR in band " << i << " at " << chunk.end);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (total, rx.end - rx.start, "Chunks do not cover the RX attempt");
+}
+
+
+
 class SpectrumInterferenceTestSuite : public TestSuite
 {
 public:
@@ -190,6 +331,8 @@ SpectrumInterferenceTestSuite::SpectrumInterferenceTestSuite ()
   AddTestCase (new SpectrumInterferenceTestCase (s2, static_cast<uint32_t> (b * 1.5 + 0.5), false,   "sdBm  = [-63 -61]  tx bytes: b*1.5"));
   AddTestCase (new SpectrumInterferenceTestCase (s2, 0xffffffff, false,     "sdBm  = [-63 -61]  tx bytes: 2^32-1"));
 
+  AddTestCase (new SpectrumInterferenceBandsTestCase ());
+
 }
 
 static SpectrumInterferenceTestSuite spectrumInterferenceTestSuite;
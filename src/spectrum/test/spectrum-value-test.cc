@@ -329,6 +329,20 @@ SpectrumConverterTestSuite::SpectrumConverterTestSuite ()
 //   NS_LOG_LOGIC(*res);
   AddTestCase (new SpectrumValueTestCase (t21b, *res, ""));
 
+  // bands which overlap the end of the other model, or not at all
+  std::vector<double> f3;
+  for (f = 7; f <= 11; f += 1)
+    {
+      f3.push_back (f);
+    }
+  Ptr<SpectrumModel> sof3 = Create<SpectrumModel> (f3);
+  SpectrumConverter c13 (sof1, sof3);
+  res = c13.Convert (v1);
+  SpectrumValue t13 (sof3);
+  t13[0] = 4;
+  t13[1] = 2;
+  AddTestCase (new SpectrumValueTestCase (t13, *res, ""));
+
 
 }
 
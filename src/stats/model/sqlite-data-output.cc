@@ -24,6 +24,7 @@
 
 #include "ns3/log.h"
 #include "ns3/nstime.h"
+#include "ns3/simulator.h"
 
 #include "data-collector.h"
 #include "data-calculator.h"
@@ -36,6 +37,12 @@ NS_LOG_COMPONENT_DEFINE ("SqliteDataOutput");
 //--------------------------------------------------------------
 //----------------------------------------------
 SqliteDataOutput::SqliteDataOutput()
+  : m_db (0),
+    m_wal (false),
+    m_insertExperiment (0),
+    m_insertMetadata (0),
+    m_insertSingleton (0),
+    m_insertSnapshot (0)
 {
   m_filePrefix = "data";
   NS_LOG_FUNCTION_NOARGS ();
@@ -43,115 +50,217 @@ SqliteDataOutput::SqliteDataOutput()
 SqliteDataOutput::~SqliteDataOutput()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  Close ();
 }
 void
 SqliteDataOutput::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
+  StopStreaming ();
+  Close ();
   DataOutputInterface::DoDispose ();
   // end SqliteDataOutput::DoDispose
 }
 
+void
+SqliteDataOutput::SetWal (bool wal)
+{
+  m_wal = wal;
+}
+
 int
 SqliteDataOutput::Exec (std::string exe) {
-  int res;
-  char **result;
-  int nrows, ncols;
   char *errMsg = 0;
 
   NS_LOG_INFO ("executing '" << exe << "'");
 
-  res = sqlite3_get_table (m_db,
-                           exe.c_str (),
-                           &result, &nrows, &ncols,
-                           &errMsg);
-
+  int res = sqlite3_exec (m_db, exe.c_str (), 0, 0, &errMsg);
   if (res != SQLITE_OK) {
       NS_LOG_ERROR ("sqlite3 error: \"" << errMsg << "\"");
-      /*
-      } else {
-        // std::cout << "nrows " << nrows << " ncols " << ncols << std::endl;
-
-        if (nrows > 0) {
-          for (int i = 0; i < ncols; i++) {
-            std::cout << "  " << result[i];
-          }
-          std::cout << std::endl;
-
-          for (int r = 1; r <= nrows; r++) {
-            for (int c = 0; c < ncols; c++) {
-              std::cout << "  " << result[(r*ncols)+c];
-            }
-            std::cout << std::endl;
-          }
-          std::cout << std::endl;
-        }
-      */
     }
-
-  sqlite3_free_table (result);
+  sqlite3_free (errMsg);
   return res;
 
   // end SqliteDataOutput::Exec
 }
 
-//----------------------------------------------
-void
-SqliteDataOutput::Output (DataCollector &dc)
+sqlite3_stmt *
+SqliteDataOutput::Prepare (std::string sql)
+{
+  sqlite3_stmt *stmt = 0;
+  if (sqlite3_prepare_v2 (m_db, sql.c_str (), -1, &stmt, 0) != SQLITE_OK) {
+      NS_LOG_ERROR ("sqlite3 error \"" << sqlite3_errmsg (m_db) << "\" preparing '" << sql << "'");
+    }
+  return stmt;
+}
+
+int
+SqliteDataOutput::Step (sqlite3_stmt *stmt)
+{
+  int res = sqlite3_step (stmt);
+  if (res != SQLITE_DONE) {
+      NS_LOG_ERROR ("sqlite3 error: \"" << sqlite3_errmsg (m_db) << "\"");
+    }
+  sqlite3_reset (stmt);
+  return res;
+}
+
+bool
+SqliteDataOutput::Open ()
 {
-  std::string m_dbFile = m_filePrefix + ".db";
+  std::string dbFile = m_filePrefix + ".db";
+  if (m_db != 0 && dbFile == m_dbFile) {
+      return true;
+    }
+  Close ();
 
-  if (sqlite3_open (m_dbFile.c_str (), &m_db)) {
-      NS_LOG_ERROR ("Could not open sqlite3 database \"" << m_dbFile << "\"");
+  if (sqlite3_open (dbFile.c_str (), &m_db)) {
+      NS_LOG_ERROR ("Could not open sqlite3 database \"" << dbFile << "\"");
       NS_LOG_ERROR ("sqlite3 error \"" << sqlite3_errmsg (m_db) << "\"");
       sqlite3_close (m_db);
+      m_db = 0;
       // TODO: Better error reporting, management!
+      return false;
+    }
+  m_dbFile = dbFile;
+
+  // other replications may be writing to the same database.
+  sqlite3_busy_timeout (m_db, 60000);
+  if (m_wal) {
+      Exec ("PRAGMA journal_mode=WAL");
+      Exec ("PRAGMA synchronous=NORMAL");
+    }
+
+  Exec ("create table if not exists Experiments (run, experiment, strategy, input, description text)");
+  Exec ("create table if not exists Metadata ( run text, key text, value)");
+  Exec ("create table if not exists Singletons ( run text, name text, variable text, value )");
+  Exec ("create table if not exists Snapshots ( run text, name text, variable text, value, time integer )");
+
+  m_insertExperiment = Prepare ("insert into Experiments (run,experiment,strategy,input,description) values (?1,?2,?3,?4,?5)");
+  m_insertMetadata = Prepare ("insert into Metadata (run,key,value) values (?1,?2,?3)");
+  m_insertSingleton = Prepare ("insert into Singletons (run,name,variable,value) values (?1,?2,?3,?4)");
+  m_insertSnapshot = Prepare ("insert into Snapshots (run,name,variable,value,time) values (?1,?2,?3,?4,?5)");
+  if (m_insertExperiment == 0 || m_insertMetadata == 0 || m_insertSingleton == 0 || m_insertSnapshot == 0) {
+      Close ();
+      return false;
+    }
+  return true;
+}
+
+void
+SqliteDataOutput::Close ()
+{
+  if (m_db == 0) {
+      return;
+    }
+  // finalizing a null statement is a no-op.
+  sqlite3_finalize (m_insertExperiment);
+  sqlite3_finalize (m_insertMetadata);
+  sqlite3_finalize (m_insertSingleton);
+  sqlite3_finalize (m_insertSnapshot);
+  m_insertExperiment = 0;
+  m_insertMetadata = 0;
+  m_insertSingleton = 0;
+  m_insertSnapshot = 0;
+  sqlite3_close (m_db);
+  m_db = 0;
+}
+
+//----------------------------------------------
+void
+SqliteDataOutput::Output (DataCollector &dc)
+{
+  if (PeekPointer (m_streamed) == &dc) {
+      StopStreaming ();
+    }
+  if (!Open ()) {
       return;
     }
 
   std::string run = dc.GetRunLabel ();
+  std::string experiment = dc.GetExperimentLabel ();
+  std::string strategy = dc.GetStrategyLabel ();
+  std::string input = dc.GetInputLabel ();
+  std::string description = dc.GetDescription ();
 
-  Exec ("create table if not exists Experiments (run, experiment, strategy, input, description text)");
-  Exec ("insert into Experiments (run,experiment,strategy,input,description) values ('" +
-        run + "', '" +
-        dc.GetExperimentLabel () + "', '" +
-        dc.GetStrategyLabel () + "', '" +
-        dc.GetInputLabel () + "', '" +
-        dc.GetDescription () + "')");
+  Exec ("BEGIN IMMEDIATE");
 
-  Exec ("create table if not exists Metadata ( run text, key text, value)");
+  sqlite3_bind_text (m_insertExperiment, 1, run.c_str (), -1, SQLITE_STATIC);
+  sqlite3_bind_text (m_insertExperiment, 2, experiment.c_str (), -1, SQLITE_STATIC);
+  sqlite3_bind_text (m_insertExperiment, 3, strategy.c_str (), -1, SQLITE_STATIC);
+  sqlite3_bind_text (m_insertExperiment, 4, input.c_str (), -1, SQLITE_STATIC);
+  sqlite3_bind_text (m_insertExperiment, 5, description.c_str (), -1, SQLITE_STATIC);
+  Step (m_insertExperiment);
 
   for (MetadataList::iterator i = dc.MetadataBegin ();
        i != dc.MetadataEnd (); i++) {
-      std::pair<std::string, std::string> blob = (*i);
-      Exec ("insert into Metadata (run,key,value) values ('" +
-            run + "', '" +
-            blob.first + "', '" +
-            blob.second + "')");
+      sqlite3_bind_text (m_insertMetadata, 1, run.c_str (), -1, SQLITE_STATIC);
+      sqlite3_bind_text (m_insertMetadata, 2, i->first.c_str (), -1, SQLITE_STATIC);
+      sqlite3_bind_text (m_insertMetadata, 3, i->second.c_str (), -1, SQLITE_STATIC);
+      Step (m_insertMetadata);
     }
 
-  Exec ("BEGIN");
-  SqliteOutputCallback callback (this, run);
+  SqliteOutputCallback callback (this, m_insertSingleton, run, Seconds (0), false);
   for (DataCalculatorList::iterator i = dc.DataCalculatorBegin ();
        i != dc.DataCalculatorEnd (); i++) {
       (*i)->Output (callback);
     }
   Exec ("COMMIT");
 
-  sqlite3_close (m_db);
-
   // end SqliteDataOutput::Output
 }
 
-SqliteDataOutput::SqliteOutputCallback::SqliteOutputCallback
-  (Ptr<SqliteDataOutput> owner, std::string run) :
-  m_owner (owner),
-  m_runLabel (run)
+void
+SqliteDataOutput::Flush (DataCollector &dc)
 {
+  if (!Open ()) {
+      return;
+    }
+
+  Exec ("BEGIN IMMEDIATE");
+  SqliteOutputCallback callback (this, m_insertSnapshot, dc.GetRunLabel (), Simulator::Now (), true);
+  for (DataCalculatorList::iterator i = dc.DataCalculatorBegin ();
+       i != dc.DataCalculatorEnd (); i++) {
+      (*i)->Output (callback);
+    }
+  Exec ("COMMIT");
 
-  m_owner->Exec ("create table if not exists Singletons ( run text, name text, variable text, value )");
+  // end SqliteDataOutput::Flush
+}
 
+void
+SqliteDataOutput::StartStreaming (Ptr<DataCollector> dc, Time interval)
+{
+  NS_LOG_FUNCTION (this << dc << interval);
+  StopStreaming ();
+  m_streamed = dc;
+  m_streamInterval = interval;
+  m_streamEvent = Simulator::Schedule (interval, &SqliteDataOutput::Stream, this);
+}
+
+void
+SqliteDataOutput::StopStreaming ()
+{
+  m_streamEvent.Cancel ();
+  m_streamed = 0;
+}
+
+void
+SqliteDataOutput::Stream ()
+{
+  Flush (*m_streamed);
+  m_streamEvent = Simulator::Schedule (m_streamInterval, &SqliteDataOutput::Stream, this);
+}
+
+SqliteDataOutput::SqliteOutputCallback::SqliteOutputCallback
+  (Ptr<SqliteDataOutput> owner, sqlite3_stmt *stmt, std::string run, Time time, bool hasTime) :
+  m_owner (owner),
+  m_stmt (stmt),
+  m_runLabel (run),
+  m_time (time),
+  m_hasTime (hasTime)
+{
   // end SqliteDataOutput::SqliteOutputCallback::SqliteOutputCallback
 }
 
@@ -173,21 +282,27 @@ SqliteDataOutput::SqliteOutputCallback::OutputStatistic (std::string key,
     OutputSingleton (key,variable+"-stddev", statSum->getStddev ());
 }
 
+void
+SqliteDataOutput::SqliteOutputCallback::Bind (std::string const &key,
+                                              std::string const &variable)
+{
+  // the strings outlive the step of the statement.
+  sqlite3_bind_text (m_stmt, 1, m_runLabel.c_str (), -1, SQLITE_STATIC);
+  sqlite3_bind_text (m_stmt, 2, key.c_str (), -1, SQLITE_STATIC);
+  sqlite3_bind_text (m_stmt, 3, variable.c_str (), -1, SQLITE_STATIC);
+  if (m_hasTime) {
+      sqlite3_bind_int64 (m_stmt, 5, m_time.GetTimeStep ());
+    }
+}
 
 void
 SqliteDataOutput::SqliteOutputCallback::OutputSingleton (std::string key,
                                                          std::string variable,
                                                          int val)
 {
-
-  std::stringstream sstr;
-  sstr << "insert into Singletons (run,name,variable,value) values ('" <<
-  m_runLabel << "', '" <<
-  key << "', '" <<
-  variable << "', " <<
-  val << ")";
-  m_owner->Exec (sstr.str ());
-
+  Bind (key, variable);
+  sqlite3_bind_int (m_stmt, 4, val);
+  m_owner->Step (m_stmt);
   // end SqliteDataOutput::SqliteOutputCallback::OutputSingleton
 }
 void
@@ -195,13 +310,9 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton (std::string key,
                                                          std::string variable,
                                                          uint32_t val)
 {
-  std::stringstream sstr;
-  sstr << "insert into Singletons (run,name,variable,value) values ('" <<
-  m_runLabel << "', '" <<
-  key << "', '" <<
-  variable << "', " <<
-  val << ")";
-  m_owner->Exec (sstr.str ());
+  Bind (key, variable);
+  sqlite3_bind_int64 (m_stmt, 4, val);
+  m_owner->Step (m_stmt);
   // end SqliteDataOutput::SqliteOutputCallback::OutputSingleton
 }
 void
@@ -209,13 +320,9 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton (std::string key,
                                                          std::string variable,
                                                          double val)
 {
-  std::stringstream sstr;
-  sstr << "insert into Singletons (run,name,variable,value) values ('" <<
-  m_runLabel << "', '" <<
-  key << "', '" <<
-  variable << "', " <<
-  val << ")";
-  m_owner->Exec (sstr.str ());
+  Bind (key, variable);
+  sqlite3_bind_double (m_stmt, 4, val);
+  m_owner->Step (m_stmt);
   // end SqliteDataOutput::SqliteOutputCallback::OutputSingleton
 }
 void
@@ -223,13 +330,9 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton (std::string key,
                                                          std::string variable,
                                                          std::string val)
 {
-  std::stringstream sstr;
-  sstr << "insert into Singletons (run,name,variable,value) values ('" <<
-  m_runLabel << "', '" <<
-  key << "', '" <<
-  variable << "', '" <<
-  val << "')";
-  m_owner->Exec (sstr.str ());
+  Bind (key, variable);
+  sqlite3_bind_text (m_stmt, 4, val.c_str (), -1, SQLITE_STATIC);
+  m_owner->Step (m_stmt);
   // end SqliteDataOutput::SqliteOutputCallback::OutputSingleton
 }
 void
@@ -237,12 +340,8 @@ SqliteDataOutput::SqliteOutputCallback::OutputSingleton (std::string key,
                                                          std::string variable,
                                                          Time val)
 {
-  std::stringstream sstr;
-  sstr << "insert into Singletons (run,name,variable,value) values ('" <<
-  m_runLabel << "', '" <<
-  key << "', '" <<
-  variable << "', " <<
-  val.GetTimeStep () << ")";
-  m_owner->Exec (sstr.str ());
+  Bind (key, variable);
+  sqlite3_bind_int64 (m_stmt, 4, val.GetTimeStep ());
+  m_owner->Step (m_stmt);
   // end SqliteDataOutput::SqliteOutputCallback::OutputSingleton
 }
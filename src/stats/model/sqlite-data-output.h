@@ -22,20 +22,32 @@
 #define SQLITE_DATA_OUTPUT_H
 
 #include "ns3/nstime.h"
+#include "ns3/event-id.h"
 
 #include "data-output-interface.h"
 
 #define STATS_HAS_SQLITE3
 
 class sqlite3;
+struct sqlite3_stmt;
 
 namespace ns3 {
 
+class DataCollector;
+
 //------------------------------------------------------------
 //--------------------------------------------
 /**
  * \ingroup stats
  *
+ * Write the results of a DataCollector to the sqlite3 database
+ * <prefix>.db, which stays open until the prefix changes or the object is
+ * disposed, so that the results of many runs can be appended cheaply.
+ * Each Output is written in one transaction with prepared statements.
+ *
+ * In the streaming mode, the current values of the calculators are also
+ * written periodically during the simulation in the Snapshots table,
+ * together with the simulation time in time steps.
  */
 class SqliteDataOutput : public DataOutputInterface {
 public:
@@ -44,13 +56,33 @@ public:
 
   virtual void Output (DataCollector &dc);
 
+  /**
+   * Use the write-ahead log of sqlite3: faster commits, and several
+   * processes (replications) can write to the same database.  Takes
+   * effect when the database is opened.
+   */
+  void SetWal (bool wal);
+
+  /**
+   * Write the current values of the calculators of dc every interval of
+   * simulation time, until Output is called for dc.
+   */
+  void StartStreaming (Ptr<DataCollector> dc, Time interval);
+  void StopStreaming ();
+  /**
+   * Write the current values of the calculators of dc in the Snapshots
+   * table.
+   */
+  void Flush (DataCollector &dc);
+
 protected:
   virtual void DoDispose ();
 
 private:
   class SqliteOutputCallback : public DataOutputCallback {
 public:
-    SqliteOutputCallback(Ptr<SqliteDataOutput> owner, std::string run);
+    SqliteOutputCallback(Ptr<SqliteDataOutput> owner, sqlite3_stmt *stmt,
+                         std::string run, Time time, bool hasTime);
 
     void OutputStatistic (std::string key,
                           std::string variable,
@@ -77,15 +109,36 @@ public:
                           Time val);
 
 private:
+    // bind the columns other than the value.
+    void Bind (std::string const &key, std::string const &variable);
+
     Ptr<SqliteDataOutput> m_owner;
+    sqlite3_stmt *m_stmt;
     std::string m_runLabel;
+    Time m_time;
+    bool m_hasTime;
 
     // end class SqliteOutputCallback
   };
 
+  bool Open ();
+  void Close ();
+  int Exec (std::string exe);
+  sqlite3_stmt *Prepare (std::string sql);
+  int Step (sqlite3_stmt *stmt);
+  void Stream ();
 
   sqlite3 *m_db;
-  int Exec (std::string exe);
+  std::string m_dbFile;
+  bool m_wal;
+  sqlite3_stmt *m_insertExperiment;
+  sqlite3_stmt *m_insertMetadata;
+  sqlite3_stmt *m_insertSingleton;
+  sqlite3_stmt *m_insertSnapshot;
+
+  Ptr<DataCollector> m_streamed;
+  Time m_streamInterval;
+  EventId m_streamEvent;
 
   // end class SqliteDataOutput
 };
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <stdio.h>
+#include <sqlite3.h>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/basic-data-calculators.h"
+#include "ns3/data-collector.h"
+#include "ns3/sqlite-data-output.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for the output of several runs in one database.
+// ===========================================================================
+
+class SqliteDataOutputTestCase : public TestCase
+{
+public:
+  SqliteDataOutputTestCase (bool wal);
+  virtual ~SqliteDataOutputTestCase ();
+
+private:
+  virtual void DoRun (void);
+  // returns the first column of the first row of the result.
+  std::string Query (std::string sql);
+  void Packet (Ptr<CounterCalculator<> > counter, Ptr<MinMaxAvgTotalCalculator<double> > delay, double value);
+
+  bool m_wal;
+  sqlite3 *m_db;
+};
+
+SqliteDataOutputTestCase::SqliteDataOutputTestCase (bool wal)
+  : TestCase (wal ? "Output and streaming of several runs, WAL journal"
+              : "Output and streaming of several runs, default journal"),
+    m_wal (wal),
+    m_db (0)
+{
+}
+
+SqliteDataOutputTestCase::~SqliteDataOutputTestCase ()
+{
+}
+
+std::string
+SqliteDataOutputTestCase::Query (std::string sql)
+{
+  sqlite3_stmt *stmt;
+  std::string result = "<error>";
+  if (sqlite3_prepare_v2 (m_db, sql.c_str (), -1, &stmt, 0) == SQLITE_OK)
+    {
+      if (sqlite3_step (stmt) == SQLITE_ROW)
+        {
+          result = reinterpret_cast<char const *> (sqlite3_column_text (stmt, 0));
+        }
+      sqlite3_finalize (stmt);
+    }
+  return result;
+}
+
+void
+SqliteDataOutputTestCase::Packet (Ptr<CounterCalculator<> > counter, Ptr<MinMaxAvgTotalCalculator<double> > delay,
+                                  double value)
+{
+  counter->Update ();
+  delay->Update (value);
+}
+
+void
+SqliteDataOutputTestCase::DoRun (void)
+{
+  std::string prefix = CreateTempDirFilename (m_wal ? "sqlite-output-wal" : "sqlite-output");
+  remove ((prefix + ".db").c_str ());
+
+  Ptr<SqliteDataOutput> output = CreateObject<SqliteDataOutput> ();
+  output->SetFilePrefix (prefix);
+  output->SetWal (m_wal);
+
+  for (uint32_t run = 0; run < 3; run++)
+    {
+      Ptr<DataCollector> dc = CreateObject<DataCollector> ();
+      std::ostringstream label;
+      label << "run 'o" << run;
+      dc->DescribeRun ("experiment", "strategy", "input", label.str (), "it's quoted");
+      dc->AddMetadata ("author", "o'brien");
+      Ptr<CounterCalculator<> > counter = CreateObject<CounterCalculator<> > ();
+      counter->SetKey ("packets");
+      counter->SetContext ("node[0]");
+      dc->AddDataCalculator (counter);
+      Ptr<MinMaxAvgTotalCalculator<double> > delay = CreateObject<MinMaxAvgTotalCalculator<double> > ();
+      delay->SetKey ("delay");
+      delay->SetContext ("node[0]");
+      dc->AddDataCalculator (delay);
+
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          Simulator::Schedule (Seconds (i + 0.5), &SqliteDataOutputTestCase::Packet, this, counter, delay, i);
+        }
+      output->StartStreaming (dc, Seconds (4));
+      Simulator::Stop (Seconds (10));
+      Simulator::Run ();
+      output->Output (*dc);
+      Simulator::Destroy ();
+    }
+  output->Dispose ();
+
+  NS_TEST_ASSERT_MSG_EQ (sqlite3_open ((prefix + ".db").c_str (), &m_db), SQLITE_OK, "Could not open the database");
+  NS_TEST_ASSERT_MSG_EQ (Query ("select count(*) from Experiments"), "3", "Wrong number of runs");
+  NS_TEST_ASSERT_MSG_EQ (Query ("select description from Experiments where run = 'run ''o1'"), "it's quoted",
+                         "Wrong description");
+  NS_TEST_ASSERT_MSG_EQ (Query ("select count(*) from Metadata where value = 'o''brien'"), "3", "Wrong metadata");
+  NS_TEST_ASSERT_MSG_EQ (Query ("select value from Singletons where run = 'run ''o2' and variable = 'packets'"), "10",
+                         "Wrong counter");
+  NS_TEST_ASSERT_MSG_EQ (Query ("select value from Singletons where run = 'run ''o2' and variable = 'delay-max'"), "9.0",
+                         "Wrong maximum");
+  // the calculators are streamed at 4s and 8s of each run.
+  NS_TEST_ASSERT_MSG_EQ (Query ("select count(*) from Snapshots where variable = 'packets'"), "6",
+                         "Wrong number of snapshots");
+  NS_TEST_ASSERT_MSG_EQ (Query ("select value from Snapshots where run = 'run ''o0' and variable = 'packets' "
+                                "and time = (select max(time) from Snapshots)"), "8", "Wrong snapshot");
+  NS_TEST_ASSERT_MSG_EQ (Query ("pragma journal_mode"), (m_wal ? "wal" : "delete"), "Wrong journal mode");
+  sqlite3_close (m_db);
+  remove ((prefix + ".db").c_str ());
+  remove ((prefix + ".db-wal").c_str ());
+  remove ((prefix + ".db-shm").c_str ());
+}
+
+class SqliteDataOutputTestSuite : public TestSuite
+{
+public:
+  SqliteDataOutputTestSuite ();
+};
+
+SqliteDataOutputTestSuite::SqliteDataOutputTestSuite ()
+  : TestSuite ("sqlite-data-output", UNIT)
+{
+  AddTestCase (new SqliteDataOutputTestCase (false));
+  AddTestCase (new SqliteDataOutputTestCase (true));
+}
+
+static SqliteDataOutputTestSuite sqliteDataOutputTestSuite;
@@ -15,14 +15,18 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/csma-helper.h"
 #include "ns3/flow-monitor.h"
 #include "ns3/flow-monitor-helper.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-router-interface.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing.h"
 #include "ns3/ipv4-global-routing-helper.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node.h"
@@ -390,6 +394,121 @@ GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  GlobalRoutingUpdateTestCase ();
+  virtual ~GlobalRoutingUpdateTestCase ();
+
+private:
+  virtual void DoRun (void);
+  std::string GetRoutes (NodeContainer const &nodes);
+  void Recompute (uint32_t threads);
+};
+
+GlobalRoutingUpdateTestCase::GlobalRoutingUpdateTestCase ()
+  : TestCase ("Threaded and incremental global routing computations")
+{
+}
+
+GlobalRoutingUpdateTestCase::~GlobalRoutingUpdateTestCase ()
+{
+}
+
+std::string
+GlobalRoutingUpdateTestCase::GetRoutes (NodeContainer const &nodes)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      oss << "node " << i << std::endl;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << *routing->GetRoute (j) << std::endl;
+        }
+    }
+  return oss.str ();
+}
+
+void
+GlobalRoutingUpdateTestCase::Recompute (uint32_t threads)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+}
+
+// A 4x4 grid of point-to-point links, with equal cost paths, and a separate
+// CSMA LAN which no change of the grid affects.  (A LAN reached through equal
+// cost paths is not supported by the SPF calculation.)
+void
+GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  const uint32_t n = 4;
+  NodeContainer grid;
+  grid.Create (n * n);
+  NodeContainer lan;
+  lan.Create (3);
+  NodeContainer all (grid, lan);
+
+  InternetStackHelper internet;
+  internet.Install (all);
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < n * n; i++)
+    {
+      if (i % n != n - 1)
+        {
+          ipv4.Assign (p2p.Install (grid.Get (i), grid.Get (i + 1)));
+          ipv4.NewNetwork ();
+        }
+      if (i / n != n - 1)
+        {
+          ipv4.Assign (p2p.Install (grid.Get (i), grid.Get (i + n)));
+          ipv4.NewNetwork ();
+        }
+    }
+  CsmaHelper csma;
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  ipv4.Assign (csma.Install (lan));
+
+  Recompute (1);
+  std::string serial = GetRoutes (all);
+  Recompute (4);
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (all), serial, "The routes computed by several threads differ");
+
+  // a route which only survives if the routes of the LAN are not recomputed.
+  Ptr<Ipv4GlobalRouting> lanRouting = lan.Get (0)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+  lanRouting->AddHostRouteTo (Ipv4Address ("10.4.0.1"), 1);
+  uint32_t lanRoutes = lanRouting->GetNRoutes ();
+  grid.Get (n + 1)->GetObject<Ipv4> ()->SetDown (1);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (lanRouting->GetNRoutes (), lanRoutes, "The routes of the LAN were recomputed");
+  for (uint32_t j = 0; j < lanRouting->GetNRoutes (); j++)
+    {
+      if (lanRouting->GetRoute (j)->GetDest () == Ipv4Address ("10.4.0.1"))
+        {
+          lanRouting->RemoveRoute (j);
+          break;
+        }
+    }
+  std::string updated = GetRoutes (all);
+  NS_TEST_ASSERT_MSG_NE (updated, serial, "The routes did not change with the topology");
+  Recompute (1);
+  NS_TEST_ASSERT_MSG_EQ (updated, GetRoutes (all), "The updated routes differ from a full computation");
+
+  grid.Get (n + 1)->GetObject<Ipv4> ()->SetUp (1);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (all), serial, "The routes differ after the interface is up again");
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
 
 class GlobalRoutingTestSuite : public TestSuite
 {
@@ -402,6 +521,7 @@ GlobalRoutingTestSuite::GlobalRoutingTestSuite ()
 {
   AddTestCase (new DynamicGlobalRoutingTestCase);
   AddTestCase (new GlobalRoutingSlash32TestCase);
+  AddTestCase (new GlobalRoutingUpdateTestCase);
 }
 
 // Do not forget to allocate an instance of this TestSuite
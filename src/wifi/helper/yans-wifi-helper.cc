@@ -88,6 +88,28 @@ AsciiPhyReceiveSinkWithoutContext (
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
+static void
+BinaryPhyTransmitSink (
+  Ptr<BinaryTraceSink> sink,
+  Ptr<const Packet> p,
+  WifiMode mode,
+  WifiPreamble preamble,
+  uint8_t txLevel)
+{
+  sink->Transmit (p);
+}
+
+static void
+BinaryPhyReceiveSink (
+  Ptr<BinaryTraceSink> sink,
+  Ptr<const Packet> p,
+  double snr,
+  WifiMode mode,
+  enum WifiPreamble preamble)
+{
+  sink->Receive (p);
+}
+
 YansWifiChannelHelper::YansWifiChannelHelper ()
 {
 }
@@ -536,4 +558,26 @@ YansWifiPhyHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiPhyTransmitSinkWithContext, stream));
 }
 
+void
+YansWifiPhyHelper::EnableBinaryInternal (Ptr<BinaryTraceSink> sink, Ptr<NetDevice> nd)
+{
+  Ptr<WifiNetDevice> device = nd->GetObject<WifiNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("YansWifiHelper::EnableBinaryInternal(): Device " << device << " not of type ns3::WifiNetDevice");
+      return;
+    }
+
+  uint32_t nodeid = nd->GetNode ()->GetId ();
+  uint32_t deviceid = nd->GetIfIndex ();
+  std::ostringstream oss;
+
+  oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid << "/$ns3::WifiNetDevice/Phy/State/RxOk";
+  Config::ConnectWithoutContext (oss.str (), MakeBoundCallback (&BinaryPhyReceiveSink, sink));
+
+  oss.str ("");
+  oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid << "/$ns3::WifiNetDevice/Phy/State/Tx";
+  Config::ConnectWithoutContext (oss.str (), MakeBoundCallback (&BinaryPhyTransmitSink, sink));
+}
+
 } // namespace ns3
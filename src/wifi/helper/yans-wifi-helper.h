@@ -272,6 +272,18 @@ private:
                                     Ptr<NetDevice> nd,
                                     bool explicitFilename);
 
+  /**
+   * \brief Enable binary trace output on the indicated net device.
+   * \internal
+   *
+   * Records "t" events from the PHY state Tx source and "r" events from
+   * RxOk, like the ascii traces.
+   *
+   * \param sink The binary trace sink bound to the device.
+   * \param nd Net device for which you want to enable tracing.
+   */
+  virtual void EnableBinaryInternal (Ptr<BinaryTraceSink> sink, Ptr<NetDevice> nd);
+
   ObjectFactory m_phy;
   ObjectFactory m_errorRateModel;
   Ptr<YansWifiChannel> m_channel;
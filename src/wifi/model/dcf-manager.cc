@@ -267,6 +267,8 @@ DcfManager::DcfManager ()
     m_lastSwitchingStart (MicroSeconds (0)),
     m_lastSwitchingDuration (MicroSeconds (0)),
     m_rxing (false),
+    m_accessTimeoutDeferred (false),
+    m_avoidedReschedules (0),
     m_slotTimeUs (0),
     m_sifs (Seconds (0.0)),
     m_phyListener (0),
@@ -310,6 +312,12 @@ DcfManager::SetEifsNoDifs (Time eifsNoDifs)
 {
   m_eifsNoDifs = eifsNoDifs;
 }
+uint64_t
+DcfManager::GetAvoidedReschedules (void) const
+{
+  return m_avoidedReschedules;
+}
+
 Time
 DcfManager::GetEifsNoDifs () const
 {
@@ -415,12 +423,13 @@ DcfManager::RequestAccess (DcfState *state)
 void
 DcfManager::DoGrantAccess (void)
 {
+  Time accessGrantStart = GetAccessGrantStart ();
   uint32_t k = 0;
   for (States::const_iterator i = m_states.begin (); i != m_states.end (); k++)
     {
       DcfState *state = *i;
       if (state->IsAccessRequested ()
-          && GetBackoffEndFor (state) <= Simulator::Now () )
+          && GetBackoffEndFor (state, accessGrantStart) <= Simulator::Now () )
         {
           /**
            * This is the first dcf we find with an expired backoff and which
@@ -434,7 +443,7 @@ DcfManager::DoGrantAccess (void)
             {
               DcfState *otherState = *j;
               if (otherState->IsAccessRequested ()
-                  && GetBackoffEndFor (otherState) <= Simulator::Now ())
+                  && GetBackoffEndFor (otherState, accessGrantStart) <= Simulator::Now ())
                 {
                   MY_DEBUG ("dcf " << k << " needs access. backoff expired. internal collision. slots=" <<
                             otherState->GetBackoffSlots ());
@@ -513,29 +522,32 @@ DcfManager::GetAccessGrantStart (void) const
 }
 
 Time
-DcfManager::GetBackoffStartFor (DcfState *state)
+DcfManager::GetBackoffStartFor (DcfState *state, Time accessGrantStart) const
 {
   Time mostRecentEvent = MostRecent (state->GetBackoffStart (),
-                                     GetAccessGrantStart () + MicroSeconds (state->GetAifsn () * m_slotTimeUs));
+                                     accessGrantStart + MicroSeconds (state->GetAifsn () * m_slotTimeUs));
 
   return mostRecentEvent;
 }
 
 Time
-DcfManager::GetBackoffEndFor (DcfState *state)
+DcfManager::GetBackoffEndFor (DcfState *state, Time accessGrantStart) const
 {
-  return GetBackoffStartFor (state) + MicroSeconds (state->GetBackoffSlots () * m_slotTimeUs);
+  return GetBackoffStartFor (state, accessGrantStart) + MicroSeconds (state->GetBackoffSlots () * m_slotTimeUs);
 }
 
 void
 DcfManager::UpdateBackoff (void)
 {
+  // the medium state does not change while we walk the states so the
+  // access grant start is computed once for all of them.
+  Time accessGrantStart = GetAccessGrantStart ();
   uint32_t k = 0;
   for (States::const_iterator i = m_states.begin (); i != m_states.end (); i++, k++)
     {
       DcfState *state = *i;
 
-      Time backoffStart = GetBackoffStartFor (state);
+      Time backoffStart = GetBackoffStartFor (state, accessGrantStart);
       if (backoffStart <= Simulator::Now ())
         {
           uint32_t nus = (Simulator::Now () - backoffStart).GetMicroSeconds ();
@@ -557,12 +569,14 @@ DcfManager::DoRestartAccessTimeoutIfNeeded (void)
    */
   bool accessTimeoutNeeded = false;
   Time expectedBackoffEnd = Simulator::GetMaximumSimulationTime ();
+  Time accessGrantStart = GetAccessGrantStart ();
+  m_accessTimeoutDeferred = false;
   for (States::const_iterator i = m_states.begin (); i != m_states.end (); i++)
     {
       DcfState *state = *i;
       if (state->IsAccessRequested ())
         {
-          Time tmp = GetBackoffEndFor (state);
+          Time tmp = GetBackoffEndFor (state, accessGrantStart);
           if (tmp > Simulator::Now ())
             {
               accessTimeoutNeeded = true;
@@ -570,6 +584,20 @@ DcfManager::DoRestartAccessTimeoutIfNeeded (void)
             }
         }
     }
+  if (accessTimeoutNeeded && m_rxing)
+    {
+      /**
+       * No access can be granted before the end of the current
+       * reception and we do not know yet whether that reception will
+       * require an EIFS.  Rather than scheduling a timeout which would
+       * most likely need to be rescheduled, wait for the end of the
+       * reception to compute the backoff end.
+       */
+      MY_DEBUG ("rxing, defer access timeout");
+      m_accessTimeoutDeferred = true;
+      m_avoidedReschedules++;
+      return;
+    }
   if (accessTimeoutNeeded)
     {
       MY_DEBUG ("expected backoff end=" << expectedBackoffEnd);
@@ -603,6 +631,14 @@ DcfManager::NotifyRxEndOkNow (void)
   m_lastRxEnd = Simulator::Now ();
   m_lastRxReceivedOk = true;
   m_rxing = false;
+  /**
+   * A successful reception ends a pending EIFS so, the access timeout
+   * might have to be moved earlier.
+   */
+  if (m_accessTimeoutDeferred || m_accessTimeout.IsRunning ())
+    {
+      DoRestartAccessTimeoutIfNeeded ();
+    }
 }
 void
 DcfManager::NotifyRxEndErrorNow (void)
@@ -611,6 +647,10 @@ DcfManager::NotifyRxEndErrorNow (void)
   m_lastRxEnd = Simulator::Now ();
   m_lastRxReceivedOk = false;
   m_rxing = false;
+  if (m_accessTimeoutDeferred)
+    {
+      DoRestartAccessTimeoutIfNeeded ();
+    }
 }
 void
 DcfManager::NotifyTxStartNow (Time duration)
@@ -630,6 +670,10 @@ DcfManager::NotifyTxStartNow (Time duration)
   UpdateBackoff ();
   m_lastTxStart = Simulator::Now ();
   m_lastTxDuration = duration;
+  if (m_accessTimeoutDeferred)
+    {
+      DoRestartAccessTimeoutIfNeeded ();
+    }
 }
 void
 DcfManager::NotifyMaybeCcaBusyStartNow (Time duration)
@@ -678,6 +722,7 @@ DcfManager::NotifySwitchingStartNow (Time duration)
     {
       m_accessTimeout.Cancel ();
     }
+  m_accessTimeoutDeferred = false;
 
   // Reset backoffs
   for (States::iterator i = m_states.begin (); i != m_states.end (); i++)
@@ -207,6 +207,16 @@ public:
    */
   Time GetEifsNoDifs () const;
 
+  /**
+   * \return the number of times the access timeout was not scheduled
+   * because a reception was in progress.
+   *
+   * The access timeout is only scheduled once the backoff end can be
+   * computed from a known medium state: while a packet is being received,
+   * it is deferred until the end of the reception.
+   */
+  uint64_t GetAvoidedReschedules (void) const;
+
   /**
    * \param dcf a new DcfState.
    *
@@ -299,8 +309,8 @@ private:
    * be granted
    */
   Time GetAccessGrantStart (void) const;
-  Time GetBackoffStartFor (DcfState *state);
-  Time GetBackoffEndFor (DcfState *state);
+  Time GetBackoffStartFor (DcfState *state, Time accessGrantStart) const;
+  Time GetBackoffEndFor (DcfState *state, Time accessGrantStart) const;
   void DoRestartAccessTimeoutIfNeeded (void);
   void AccessTimeout (void);
   void DoGrantAccess (void);
@@ -327,6 +337,8 @@ private:
   bool m_sleeping;
   Time m_eifsNoDifs;
   EventId m_accessTimeout;
+  bool m_accessTimeoutDeferred;
+  uint64_t m_avoidedReschedules;
   uint32_t m_slotTimeUs;
   Time m_sifs;
   PhyListener* m_phyListener;
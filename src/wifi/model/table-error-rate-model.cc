@@ -0,0 +1,344 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "table-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("TableErrorRateModel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TableErrorRateModel);
+
+// chunk size used to sample the underlying model.  Large enough to keep
+// the precision of small bit error rates, and the success rate of a
+// single bit is used when this one underflows.
+static const uint32_t TABLE_REFERENCE_BITS = 1024;
+// log (DBL_MIN): keeps the interpolation away from -inf.
+static const double TABLE_MIN_LOG_SUCCESS = -708.0;
+
+TypeId
+TableErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TableErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .AddConstructor<TableErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The error rate model which is tabulated. A NistErrorRateModel is used if none is set.",
+                   PointerValue (),
+                   MakePointerAccessor (&TableErrorRateModel::SetErrorRateModel,
+                                        &TableErrorRateModel::GetErrorRateModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnr",
+                   "The lowest SNR (dB) of the tables.",
+                   DoubleValue (-10.0),
+                   MakeDoubleAccessor (&TableErrorRateModel::SetMinSnr,
+                                       &TableErrorRateModel::GetMinSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The highest SNR (dB) of the tables.",
+                   DoubleValue (40.0),
+                   MakeDoubleAccessor (&TableErrorRateModel::SetMaxSnr,
+                                       &TableErrorRateModel::GetMaxSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrStep",
+                   "The SNR (dB) between two entries of the tables.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&TableErrorRateModel::SetSnrStep,
+                                       &TableErrorRateModel::GetSnrStep),
+                   MakeDoubleChecker<double> (0.001))
+    .AddAttribute ("CacheFile",
+                   "The file in which the tables are stored across runs. The tables "
+                   "are not stored if empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&TableErrorRateModel::SetCacheFile,
+                                       &TableErrorRateModel::GetCacheFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+TableErrorRateModel::TableErrorRateModel ()
+  : m_cacheRead (false),
+    m_cacheHeaderOk (false)
+{
+}
+
+TableErrorRateModel::~TableErrorRateModel ()
+{
+  ClearTables ();
+}
+
+void
+TableErrorRateModel::DoDispose (void)
+{
+  m_model = 0;
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TableErrorRateModel::SetErrorRateModel (Ptr<ErrorRateModel> model)
+{
+  m_model = model;
+  ClearTables ();
+}
+
+Ptr<ErrorRateModel>
+TableErrorRateModel::GetErrorRateModel (void) const
+{
+  return m_model;
+}
+
+void
+TableErrorRateModel::SetMinSnr (double snrDb)
+{
+  m_minSnrDb = snrDb;
+  ClearTables ();
+}
+
+double
+TableErrorRateModel::GetMinSnr (void) const
+{
+  return m_minSnrDb;
+}
+
+void
+TableErrorRateModel::SetMaxSnr (double snrDb)
+{
+  m_maxSnrDb = snrDb;
+  ClearTables ();
+}
+
+double
+TableErrorRateModel::GetMaxSnr (void) const
+{
+  return m_maxSnrDb;
+}
+
+void
+TableErrorRateModel::SetSnrStep (double stepDb)
+{
+  m_stepDb = stepDb;
+  ClearTables ();
+}
+
+double
+TableErrorRateModel::GetSnrStep (void) const
+{
+  return m_stepDb;
+}
+
+void
+TableErrorRateModel::SetCacheFile (std::string cacheFile)
+{
+  m_cacheFile = cacheFile;
+  ClearTables ();
+}
+
+std::string
+TableErrorRateModel::GetCacheFile (void) const
+{
+  return m_cacheFile;
+}
+
+void
+TableErrorRateModel::ClearTables (void)
+{
+  // the tables are rebuilt, or read again from the cache, on demand.
+  for (std::vector<Table *>::iterator i = m_tables.begin (); i != m_tables.end (); ++i)
+    {
+      delete *i;
+    }
+  m_tables.clear ();
+  m_cached.clear ();
+  m_cacheRead = false;
+  m_cacheHeaderOk = false;
+}
+
+double
+TableErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+{
+  const Table *table = GetTable (mode);
+  if (snr > 0)
+    {
+      double x = (10.0 * std::log10 (snr) - m_minSnrDb) / m_stepDb;
+      if (x >= 0 && x < table->size () - 1)
+        {
+          uint32_t i = static_cast<uint32_t> (x);
+          double frac = x - i;
+          double logSuccess = (*table)[i] + frac * ((*table)[i + 1] - (*table)[i]);
+          return std::exp (nbits * logSuccess);
+        }
+    }
+  return m_model->GetChunkSuccessRate (mode, snr, nbits);
+}
+
+const TableErrorRateModel::Table *
+TableErrorRateModel::GetTable (WifiMode mode) const
+{
+  uint32_t uid = mode.GetUid ();
+  if (uid < m_tables.size () && m_tables[uid] != 0)
+    {
+      return m_tables[uid];
+    }
+  if (m_model == 0)
+    {
+      m_model = CreateObject<NistErrorRateModel> ();
+    }
+  if (uid >= m_tables.size ())
+    {
+      m_tables.resize (uid + 1, 0);
+    }
+  Table *table = new Table ();
+  m_tables[uid] = table;
+  if (!m_cacheFile.empty () && !m_cacheRead)
+    {
+      ReadCache ();
+    }
+  CachedTables::iterator i = m_cached.find (mode.GetUniqueName ());
+  if (i != m_cached.end ())
+    {
+      NS_LOG_DEBUG ("table of " << mode << " read from " << m_cacheFile);
+      table->swap (i->second);
+      m_cached.erase (i);
+      return table;
+    }
+  BuildTable (mode, *table);
+  if (!m_cacheFile.empty ())
+    {
+      AppendCache (mode, *table);
+    }
+  return table;
+}
+
+void
+TableErrorRateModel::BuildTable (WifiMode mode, Table &table) const
+{
+  NS_LOG_FUNCTION (this << mode);
+  uint32_t n = static_cast<uint32_t> ((m_maxSnrDb - m_minSnrDb) / m_stepDb + 0.5) + 1;
+  table.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double snr = std::pow (10.0, (m_minSnrDb + i * m_stepDb) / 10.0);
+      double logSuccess;
+      double csr = m_model->GetChunkSuccessRate (mode, snr, TABLE_REFERENCE_BITS);
+      if (csr > 0)
+        {
+          logSuccess = std::log (csr) / TABLE_REFERENCE_BITS;
+        }
+      else
+        {
+          csr = m_model->GetChunkSuccessRate (mode, snr, 1);
+          logSuccess = csr > 0 ? std::log (csr) : TABLE_MIN_LOG_SUCCESS;
+        }
+      table[i] = std::max (logSuccess, TABLE_MIN_LOG_SUCCESS);
+    }
+}
+
+std::string
+TableErrorRateModel::GetCacheHeader (void) const
+{
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << "ns3::TableErrorRateModel " << m_model->GetInstanceTypeId ().GetName ()
+      << " " << m_minSnrDb << " " << m_maxSnrDb << " " << m_stepDb;
+  return oss.str ();
+}
+
+void
+TableErrorRateModel::ReadCache (void) const
+{
+  m_cacheRead = true;
+  std::ifstream is (m_cacheFile.c_str ());
+  if (!is.is_open ())
+    {
+      return;
+    }
+  std::string line;
+  std::getline (is, line);
+  if (line != GetCacheHeader ())
+    {
+      NS_LOG_WARN ("tables in " << m_cacheFile << " do not match this model, they will be rebuilt");
+      return;
+    }
+  m_cacheHeaderOk = true;
+  uint32_t n = static_cast<uint32_t> ((m_maxSnrDb - m_minSnrDb) / m_stepDb + 0.5) + 1;
+  while (std::getline (is, line))
+    {
+      std::istringstream iss (line);
+      std::string name;
+      iss >> name;
+      Table table;
+      double v;
+      while (iss >> v)
+        {
+          table.push_back (v);
+        }
+      // ignore the lines truncated by a run which was interrupted
+      if (table.size () == n)
+        {
+          m_cached[name].swap (table);
+        }
+    }
+}
+
+void
+TableErrorRateModel::AppendCache (WifiMode mode, const Table &table) const
+{
+  std::ofstream os;
+  if (m_cacheHeaderOk)
+    {
+      os.open (m_cacheFile.c_str (), std::ios::out | std::ios::app);
+    }
+  else
+    {
+      os.open (m_cacheFile.c_str (), std::ios::out | std::ios::trunc);
+    }
+  if (!os.is_open ())
+    {
+      NS_LOG_WARN ("unable to write tables to " << m_cacheFile);
+      return;
+    }
+  if (!m_cacheHeaderOk)
+    {
+      os << GetCacheHeader () << std::endl;
+      if (!os)
+        {
+          NS_LOG_WARN ("unable to write tables to " << m_cacheFile);
+          return;
+        }
+      m_cacheHeaderOk = true;
+    }
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << mode.GetUniqueName ();
+  for (Table::const_iterator i = table.begin (); i != table.end (); ++i)
+    {
+      oss << " " << *i;
+    }
+  oss << "\n";
+  // a single write so that concurrent runs sharing the cache do not
+  // interleave their lines.
+  os << oss.str () << std::flush;
+}
+
+} // namespace ns3
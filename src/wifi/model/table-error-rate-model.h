@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TABLE_ERROR_RATE_MODEL_H
+#define TABLE_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "ns3/ptr.h"
+#include "wifi-mode.h"
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A link abstraction error rate model: the chunk success rates of another
+ * error rate model are sampled once per WifiMode over a range of SNR values
+ * and then looked up and linearly interpolated in constant time.
+ *
+ * All the error rate models of this module assume that bit errors are
+ * independent, that is, the success rate of a chunk of nbits bits is the
+ * success rate of a single bit raised to the power nbits.  The tables thus
+ * hold the log of the success rate of a single bit for each SNR (in dB)
+ * and are valid for any chunk size.  Outside of the tabulated range, the
+ * underlying model is used directly.
+ *
+ * When the CacheFile attribute is set, the tables are read from that file
+ * and the tables of the modes which were not found there are appended to
+ * it, so that they are computed only once across simulation runs.
+ */
+class TableErrorRateModel : public ErrorRateModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TableErrorRateModel ();
+  virtual ~TableErrorRateModel ();
+
+  /**
+   * \param model the error rate model which is tabulated.
+   *
+   * Defaults to a NistErrorRateModel.
+   */
+  void SetErrorRateModel (Ptr<ErrorRateModel> model);
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+
+  virtual double GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const;
+
+private:
+  typedef std::vector<double> Table;
+  typedef std::map<std::string, Table> CachedTables;
+
+  virtual void DoDispose (void);
+  void SetMinSnr (double snrDb);
+  double GetMinSnr (void) const;
+  void SetMaxSnr (double snrDb);
+  double GetMaxSnr (void) const;
+  void SetSnrStep (double stepDb);
+  double GetSnrStep (void) const;
+  void SetCacheFile (std::string cacheFile);
+  std::string GetCacheFile (void) const;
+  void ClearTables (void);
+  const Table *GetTable (WifiMode mode) const;
+  void BuildTable (WifiMode mode, Table &table) const;
+  std::string GetCacheHeader (void) const;
+  void ReadCache (void) const;
+  void AppendCache (WifiMode mode, const Table &table) const;
+
+  mutable Ptr<ErrorRateModel> m_model;
+  double m_minSnrDb;
+  double m_maxSnrDb;
+  double m_stepDb;
+  std::string m_cacheFile;
+  // tables indexed by WifiMode uid, built on demand
+  mutable std::vector<Table *> m_tables;
+  mutable CachedTables m_cached;
+  mutable bool m_cacheRead;
+  mutable bool m_cacheHeaderOk;
+};
+
+} // namespace ns3
+
+#endif /* TABLE_ERROR_RATE_MODEL_H */
@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "wave-wifi-mac.h"
+#include "dca-txop.h"
+#include "edca-txop-n.h"
+#include "wifi-mac-queue.h"
+#include "wifi-phy.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("WaveWifiMac");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (WaveWifiMac);
+
+TypeId
+WaveWifiMac::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WaveWifiMac")
+    .SetParent<AdhocWifiMac> ()
+    .AddConstructor<WaveWifiMac> ()
+    .AddAttribute ("CchNumber", "The channel number of the control channel.",
+                   UintegerValue (178),
+                   MakeUintegerAccessor (&WaveWifiMac::m_cchNumber),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("SchNumber", "The channel number of the service channel.",
+                   UintegerValue (172),
+                   MakeUintegerAccessor (&WaveWifiMac::m_schNumber),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CchInterval", "The duration of the control channel interval.",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&WaveWifiMac::m_cchInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("SchInterval", "The duration of the service channel interval.",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&WaveWifiMac::m_schInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("GuardInterval", "The duration of the guard interval at the start of each "
+                   "channel interval. Must be longer than the channel switch delay of the PHY.",
+                   TimeValue (MilliSeconds (4)),
+                   MakeTimeAccessor (&WaveWifiMac::m_guardInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxQueueSize", "The maximum number of packets waiting for the interval of each channel.",
+                   UintegerValue (400),
+                   MakeUintegerAccessor (&WaveWifiMac::m_maxQueueSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+WaveWifiMac::WaveWifiMac ()
+  : m_current (CCH),
+    m_guard (true)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+WaveWifiMac::~WaveWifiMac ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+WaveWifiMac::DoStart (void)
+{
+  NS_LOG_FUNCTION (this);
+  AdhocWifiMac::DoStart ();
+  // join the sync interval in progress.
+  Time sync = m_cchInterval + m_schInterval;
+  if (!sync.IsStrictlyPositive ())
+    {
+      NS_FATAL_ERROR ("WaveWifiMac: the sync interval (CchInterval + SchInterval) must be positive");
+    }
+  Time elapsed = TimeStep (Simulator::Now ().GetTimeStep () % sync.GetTimeStep ());
+  enum ChannelIndex channel = CCH;
+  if (elapsed >= m_cchInterval)
+    {
+      channel = SCH;
+      elapsed -= m_cchInterval;
+    }
+  EnterInterval (channel, elapsed);
+}
+
+void
+WaveWifiMac::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextInterval.Cancel ();
+  m_endGuard.Cancel ();
+  m_queues[CCH].clear ();
+  m_queues[SCH].clear ();
+  AdhocWifiMac::DoDispose ();
+}
+
+bool
+WaveWifiMac::IsCchInterval (void) const
+{
+  return m_current == CCH;
+}
+
+bool
+WaveWifiMac::IsGuardInterval (void) const
+{
+  return m_guard;
+}
+
+uint16_t
+WaveWifiMac::GetChannelNumber (enum ChannelIndex channel) const
+{
+  return channel == CCH ? m_cchNumber : m_schNumber;
+}
+
+void
+WaveWifiMac::Enqueue (Ptr<const Packet> packet, Mac48Address to)
+{
+  NS_LOG_FUNCTION (this << packet << to);
+  enum ChannelIndex channel = to.IsGroup () ? CCH : SCH;
+  if (channel == m_current && !m_guard)
+    {
+      AdhocWifiMac::Enqueue (packet, to);
+      return;
+    }
+  if (m_queues[channel].size () >= m_maxQueueSize)
+    {
+      NS_LOG_DEBUG ("queue of channel " << GetChannelNumber (channel) << " full, drop " << packet);
+      NotifyTxDrop (packet);
+      return;
+    }
+  m_queues[channel].push_back (std::make_pair (packet, to));
+}
+
+void
+WaveWifiMac::TakeBackQueue (Ptr<WifiMacQueue> queue, enum ChannelIndex channel)
+{
+  while (!queue->IsEmpty ())
+    {
+      WifiMacHeader hdr;
+      Ptr<const Packet> packet = queue->Dequeue (&hdr);
+      m_queues[channel].push_back (std::make_pair (packet, hdr.GetAddr1 ()));
+    }
+}
+
+void
+WaveWifiMac::StartInterval (enum ChannelIndex channel)
+{
+  EnterInterval (channel, Seconds (0));
+}
+
+void
+WaveWifiMac::EnterInterval (enum ChannelIndex channel, Time elapsed)
+{
+  NS_LOG_FUNCTION (this << GetChannelNumber (channel) << elapsed);
+  enum ChannelIndex previous = m_current;
+  m_current = channel;
+  m_guard = true;
+  if (previous != channel)
+    {
+      // The DCFs flush their queues when the PHY switches channel, keep
+      // what was not sent yet for the next interval of its channel.
+      TakeBackQueue (m_dca->GetQueue (), previous);
+      for (EdcaQueues::iterator i = m_edca.begin (); i != m_edca.end (); ++i)
+        {
+          TakeBackQueue (i->second->GetQueue (), previous);
+        }
+    }
+  if (m_phy->GetChannelNumber () != GetChannelNumber (channel))
+    {
+      m_phy->SetChannelNumber (GetChannelNumber (channel));
+    }
+  Time length = channel == CCH ? m_cchInterval : m_schInterval;
+  m_nextInterval = Simulator::Schedule (length - elapsed, &WaveWifiMac::StartInterval, this,
+                                        channel == CCH ? SCH : CCH);
+  if (elapsed < m_guardInterval)
+    {
+      m_endGuard = Simulator::Schedule (m_guardInterval - elapsed, &WaveWifiMac::EndGuardInterval, this);
+    }
+  else
+    {
+      EndGuardInterval ();
+    }
+}
+
+void
+WaveWifiMac::EndGuardInterval (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_guard = false;
+  ChannelQueue queue;
+  queue.swap (m_queues[m_current]);
+  NS_LOG_DEBUG ("channel " << GetChannelNumber (m_current) << " release " << queue.size () << " packets");
+  for (ChannelQueue::const_iterator i = queue.begin (); i != queue.end (); ++i)
+    {
+      AdhocWifiMac::Enqueue (i->first, i->second);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef WAVE_WIFI_MAC_H
+#define WAVE_WIFI_MAC_H
+
+#include <deque>
+#include <utility>
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "adhoc-wifi-mac.h"
+#include "wifi-mac-queue.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * An ad hoc MAC which alternates between a control channel (CCH) and a
+ * service channel (SCH) as in the IEEE 1609.4 alternating channel access.
+ *
+ * All the nodes are assumed to be synchronized: each sync interval,
+ * starting at a multiple of CchInterval + SchInterval, is made of a CCH
+ * interval followed by a SCH interval.  Each interval starts with a guard
+ * interval during which the PHY switches to the channel of the interval
+ * and nothing is transmitted.
+ *
+ * Group addressed packets (safety messages, beacons, routing hellos) are
+ * sent on the CCH and unicast packets on the SCH.  Each channel has its
+ * own queue of packets which waits for the next interval of that channel.
+ * The packets which were not transmitted at the end of an interval are
+ * taken back from the DCF queues so that they are not flushed by the
+ * channel switch, except the packet which was already being transmitted.
+ */
+class WaveWifiMac : public AdhocWifiMac
+{
+public:
+  static TypeId GetTypeId (void);
+
+  WaveWifiMac ();
+  virtual ~WaveWifiMac ();
+
+  virtual void Enqueue (Ptr<const Packet> packet, Mac48Address to);
+
+  /**
+   * \returns true if the current interval is a CCH interval.
+   */
+  bool IsCchInterval (void) const;
+  /**
+   * \returns true during the guard interval at the start of each interval.
+   */
+  bool IsGuardInterval (void) const;
+
+private:
+  enum ChannelIndex
+  {
+    CCH = 0,
+    SCH = 1
+  };
+  typedef std::deque<std::pair<Ptr<const Packet>, Mac48Address> > ChannelQueue;
+
+  virtual void DoStart (void);
+  virtual void DoDispose (void);
+
+  void StartInterval (enum ChannelIndex channel);
+  /**
+   * \param channel the channel of the interval.
+   * \param elapsed the time elapsed since the start of the interval.
+   */
+  void EnterInterval (enum ChannelIndex channel, Time elapsed);
+  void EndGuardInterval (void);
+  void TakeBackQueue (Ptr<WifiMacQueue> queue, enum ChannelIndex channel);
+  uint16_t GetChannelNumber (enum ChannelIndex channel) const;
+
+  uint16_t m_cchNumber;
+  uint16_t m_schNumber;
+  Time m_cchInterval;
+  Time m_schInterval;
+  Time m_guardInterval;
+  uint32_t m_maxQueueSize;
+
+  enum ChannelIndex m_current;
+  bool m_guard;
+  ChannelQueue m_queues[2];
+  EventId m_nextInterval;
+  EventId m_endGuard;
+};
+
+} // namespace ns3
+
+#endif /* WAVE_WIFI_MAC_H */
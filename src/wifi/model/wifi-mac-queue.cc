@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include <algorithm>
 
 #include "wifi-mac-queue.h"
 #include "qos-blocked-destinations.h"
@@ -32,14 +33,7 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (WifiMacQueue);
 
-WifiMacQueue::Item::Item (Ptr<const Packet> packet,
-                          const WifiMacHeader &hdr,
-                          Time tstamp)
-  : packet (packet),
-    hdr (hdr),
-    tstamp (tstamp)
-{
-}
+const uint32_t WifiMacQueue::NONE;
 
 TypeId
 WifiMacQueue::GetTypeId (void)
@@ -60,7 +54,11 @@ WifiMacQueue::GetTypeId (void)
 }
 
 WifiMacQueue::WifiMacQueue ()
-  : m_size (0)
+  : m_head (NONE),
+    m_tail (NONE),
+    m_free (NONE),
+    m_peeked (NONE),
+    m_size (0)
 {
 }
 
@@ -93,6 +91,100 @@ WifiMacQueue::GetMaxDelay (void) const
   return m_maxDelay;
 }
 
+uint32_t
+WifiMacQueue::Allocate (Ptr<const Packet> packet, const WifiMacHeader &hdr)
+{
+  if (m_free == NONE)
+    {
+      // grow the pool, the slots are then reused for the lifetime of the queue.
+      uint32_t old = m_items.size ();
+      uint32_t n = std::max<uint32_t> (16, 2 * old);
+      m_items.resize (n);
+      for (uint32_t i = n; i > old; i--)
+        {
+          m_items[i - 1].next = m_free;
+          m_free = i - 1;
+        }
+    }
+  uint32_t i = m_free;
+  Item &item = m_items[i];
+  m_free = item.next;
+  item.packet = packet;
+  item.hdr = hdr;
+  item.tstamp = Simulator::Now ();
+  item.prev = NONE;
+  item.next = NONE;
+  item.flowPrev = NONE;
+  item.flowNext = NONE;
+  item.pushedFront = false;
+  m_size++;
+  return i;
+}
+
+void
+WifiMacQueue::Erase (uint32_t i)
+{
+  Item &item = m_items[i];
+  if (item.prev != NONE)
+    {
+      m_items[item.prev].next = item.next;
+    }
+  else
+    {
+      m_head = item.next;
+    }
+  if (item.next != NONE)
+    {
+      m_items[item.next].prev = item.prev;
+    }
+  else
+    {
+      m_tail = item.prev;
+    }
+  if (item.hdr.IsQosData ())
+    {
+      Flows::iterator it = m_flows.find (FlowKey (item.hdr.GetAddr1 (), item.hdr.GetQosTid ()));
+      NS_ASSERT (it != m_flows.end ());
+      Flow *flow = &it->second;
+      if (item.flowPrev != NONE)
+        {
+          m_items[item.flowPrev].flowNext = item.flowNext;
+        }
+      else
+        {
+          flow->head = item.flowNext;
+        }
+      if (item.flowNext != NONE)
+        {
+          m_items[item.flowNext].flowPrev = item.flowPrev;
+        }
+      else
+        {
+          flow->tail = item.flowPrev;
+        }
+      flow->count--;
+      if (flow->count == 0)
+        {
+          // the flows of the peers which come and go are not kept around.
+          m_flows.erase (it);
+        }
+    }
+  if (m_peeked == i)
+    {
+      m_peeked = NONE;
+    }
+  item.packet = 0;
+  item.next = m_free;
+  m_free = i;
+  m_size--;
+}
+
+WifiMacQueue::Flow *
+WifiMacQueue::LookupFlow (uint8_t tid, Mac48Address addr)
+{
+  return &m_flows[FlowKey (addr, tid)];
+}
+
 void
 WifiMacQueue::Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
@@ -101,47 +193,106 @@ WifiMacQueue::Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
     {
       return;
     }
-  Time now = Simulator::Now ();
-  m_queue.push_back (Item (packet, hdr, now));
-  m_size++;
+  uint32_t i = Allocate (packet, hdr);
+  Item &item = m_items[i];
+  item.prev = m_tail;
+  if (m_tail != NONE)
+    {
+      m_items[m_tail].next = i;
+    }
+  else
+    {
+      m_head = i;
+    }
+  m_tail = i;
+  if (hdr.IsQosData ())
+    {
+      Flow *flow = LookupFlow (hdr.GetQosTid (), hdr.GetAddr1 ());
+      item.flowPrev = flow->tail;
+      if (flow->tail != NONE)
+        {
+          m_items[flow->tail].flowNext = i;
+        }
+      else
+        {
+          flow->head = i;
+        }
+      flow->tail = i;
+      flow->count++;
+    }
 }
 
 void
-WifiMacQueue::Cleanup (void)
+WifiMacQueue::PushFront (Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
-  if (m_queue.empty ())
+  Cleanup ();
+  if (m_size == m_maxSize)
     {
       return;
     }
+  uint32_t i = Allocate (packet, hdr);
+  Item &item = m_items[i];
+  item.pushedFront = true;
+  item.next = m_head;
+  if (m_head != NONE)
+    {
+      m_items[m_head].prev = i;
+    }
+  else
+    {
+      m_tail = i;
+    }
+  m_head = i;
+  if (hdr.IsQosData ())
+    {
+      Flow *flow = LookupFlow (hdr.GetQosTid (), hdr.GetAddr1 ());
+      item.flowNext = flow->head;
+      if (flow->head != NONE)
+        {
+          m_items[flow->head].flowPrev = i;
+        }
+      else
+        {
+          flow->tail = i;
+        }
+      flow->head = i;
+      flow->count++;
+    }
+}
 
+void
+WifiMacQueue::Cleanup (void)
+{
+  // The packets which were enqueued at the tail are in timestamp order
+  // and are all behind the packets pushed at the head so, we can stop at
+  // the first of them which has not expired.
   Time now = Simulator::Now ();
-  uint32_t n = 0;
-  for (PacketQueueI i = m_queue.begin (); i != m_queue.end ();)
+  uint32_t i = m_head;
+  while (i != NONE)
     {
-      if (i->tstamp + m_maxDelay > now)
+      uint32_t next = m_items[i].next;
+      if (m_items[i].tstamp + m_maxDelay <= now)
         {
-          i++;
+          Erase (i);
         }
-      else
+      else if (!m_items[i].pushedFront)
         {
-          i = m_queue.erase (i);
-          n++;
+          break;
         }
+      i = next;
     }
-  m_size -= n;
 }
 
 Ptr<const Packet>
 WifiMacQueue::Dequeue (WifiMacHeader *hdr)
 {
   Cleanup ();
-  if (!m_queue.empty ())
+  if (m_head != NONE)
     {
-      Item i = m_queue.front ();
-      m_queue.pop_front ();
-      m_size--;
-      *hdr = i.hdr;
-      return i.packet;
+      Ptr<const Packet> packet = m_items[m_head].packet;
+      *hdr = m_items[m_head].hdr;
+      Erase (m_head);
+      return packet;
     }
   return 0;
 }
@@ -150,41 +301,48 @@ Ptr<const Packet>
 WifiMacQueue::Peek (WifiMacHeader *hdr)
 {
   Cleanup ();
-  if (!m_queue.empty ())
+  if (m_head != NONE)
     {
-      Item i = m_queue.front ();
-      *hdr = i.hdr;
-      return i.packet;
+      *hdr = m_items[m_head].hdr;
+      return m_items[m_head].packet;
     }
   return 0;
 }
 
+uint32_t
+WifiMacQueue::FindByTidAndAddress (uint8_t tid, WifiMacHeader::AddressType type, Mac48Address dest)
+{
+  NS_ASSERT (type <= 4);
+  if (type == WifiMacHeader::ADDR1)
+    {
+      Flows::const_iterator flow = m_flows.find (FlowKey (dest, tid));
+      return flow == m_flows.end () ? NONE : flow->second.head;
+    }
+  for (uint32_t i = m_head; i != NONE; i = m_items[i].next)
+    {
+      if (m_items[i].hdr.IsQosData ()
+          && GetAddressForPacket (type, i) == dest
+          && m_items[i].hdr.GetQosTid () == tid)
+        {
+          return i;
+        }
+    }
+  return NONE;
+}
+
 Ptr<const Packet>
 WifiMacQueue::DequeueByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
                                       WifiMacHeader::AddressType type, Mac48Address dest)
 {
   Cleanup ();
-  Ptr<const Packet> packet = 0;
-  if (!m_queue.empty ())
+  uint32_t i = FindByTidAndAddress (tid, type, dest);
+  if (i == NONE)
     {
-      PacketQueueI it;
-      NS_ASSERT (type <= 4);
-      for (it = m_queue.begin (); it != m_queue.end (); ++it)
-        {
-          if (it->hdr.IsQosData ())
-            {
-              if (GetAddressForPacket (type, it) == dest
-                  && it->hdr.GetQosTid () == tid)
-                {
-                  packet = it->packet;
-                  *hdr = it->hdr;
-                  m_queue.erase (it);
-                  m_size--;
-                  break;
-                }
-            }
-        }
+      return 0;
     }
+  Ptr<const Packet> packet = m_items[i].packet;
+  *hdr = m_items[i].hdr;
+  Erase (i);
   return packet;
 }
 
@@ -193,31 +351,21 @@ WifiMacQueue::PeekByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
                                    WifiMacHeader::AddressType type, Mac48Address dest)
 {
   Cleanup ();
-  if (!m_queue.empty ())
+  uint32_t i = FindByTidAndAddress (tid, type, dest);
+  if (i == NONE)
     {
-      PacketQueueI it;
-      NS_ASSERT (type <= 4);
-      for (it = m_queue.begin (); it != m_queue.end (); ++it)
-        {
-          if (it->hdr.IsQosData ())
-            {
-              if (GetAddressForPacket (type, it) == dest
-                  && it->hdr.GetQosTid () == tid)
-                {
-                  *hdr = it->hdr;
-                  return it->packet;
-                }
-            }
-        }
+      return 0;
     }
-  return 0;
+  m_peeked = i;
+  *hdr = m_items[i].hdr;
+  return m_items[i].packet;
 }
 
 bool
 WifiMacQueue::IsEmpty (void)
 {
   Cleanup ();
-  return m_queue.empty ();
+  return m_head == NONE;
 }
 
 uint32_t
@@ -229,24 +377,35 @@ WifiMacQueue::GetSize (void)
 void
 WifiMacQueue::Flush (void)
 {
-  m_queue.erase (m_queue.begin (), m_queue.end ());
+  for (uint32_t i = m_head; i != NONE; )
+    {
+      uint32_t next = m_items[i].next;
+      m_items[i].packet = 0;
+      m_items[i].next = m_free;
+      m_free = i;
+      i = next;
+    }
+  m_head = NONE;
+  m_tail = NONE;
+  m_peeked = NONE;
+  m_flows.clear ();
   m_size = 0;
 }
 
 Mac48Address
-WifiMacQueue::GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQueueI it)
+WifiMacQueue::GetAddressForPacket (enum WifiMacHeader::AddressType type, uint32_t i)
 {
   if (type == WifiMacHeader::ADDR1)
     {
-      return it->hdr.GetAddr1 ();
+      return m_items[i].hdr.GetAddr1 ();
     }
   if (type == WifiMacHeader::ADDR2)
     {
-      return it->hdr.GetAddr2 ();
+      return m_items[i].hdr.GetAddr2 ();
     }
   if (type == WifiMacHeader::ADDR3)
     {
-      return it->hdr.GetAddr3 ();
+      return m_items[i].hdr.GetAddr3 ();
     }
   return 0;
 }
@@ -254,51 +413,41 @@ WifiMacQueue::GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQ
 bool
 WifiMacQueue::Remove (Ptr<const Packet> packet)
 {
-  PacketQueueI it = m_queue.begin ();
-  for (; it != m_queue.end (); it++)
+  // EdcaTxopN removes the packets it just peeked.
+  if (m_peeked != NONE && m_items[m_peeked].packet == packet)
+    {
+      Erase (m_peeked);
+      return true;
+    }
+  for (uint32_t i = m_head; i != NONE; i = m_items[i].next)
     {
-      if (it->packet == packet)
+      if (m_items[i].packet == packet)
         {
-          m_queue.erase (it);
-          m_size--;
+          Erase (i);
           return true;
         }
     }
   return false;
 }
 
-void
-WifiMacQueue::PushFront (Ptr<const Packet> packet, const WifiMacHeader &hdr)
-{
-  Cleanup ();
-  if (m_size == m_maxSize)
-    {
-      return;
-    }
-  Time now = Simulator::Now ();
-  m_queue.push_front (Item (packet, hdr, now));
-  m_size++;
-}
-
 uint32_t
 WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, WifiMacHeader::AddressType type,
                                           Mac48Address addr)
 {
   Cleanup ();
+  NS_ASSERT (type <= 4);
+  if (type == WifiMacHeader::ADDR1)
+    {
+      Flows::const_iterator flow = m_flows.find (FlowKey (addr, tid));
+      return flow == m_flows.end () ? 0 : flow->second.count;
+    }
   uint32_t nPackets = 0;
-  if (!m_queue.empty ())
+  for (uint32_t i = m_head; i != NONE; i = m_items[i].next)
     {
-      PacketQueueI it;
-      NS_ASSERT (type <= 4);
-      for (it = m_queue.begin (); it != m_queue.end (); it++)
+      if (GetAddressForPacket (type, i) == addr
+          && m_items[i].hdr.IsQosData () && m_items[i].hdr.GetQosTid () == tid)
         {
-          if (GetAddressForPacket (type, it) == addr)
-            {
-              if (it->hdr.IsQosData () && it->hdr.GetQosTid () == tid)
-                {
-                  nPackets++;
-                }
-            }
+          nPackets++;
         }
     }
   return nPackets;
@@ -309,21 +458,20 @@ WifiMacQueue::DequeueFirstAvailable (WifiMacHeader *hdr, Time &timestamp,
                                      const QosBlockedDestinations *blockedPackets)
 {
   Cleanup ();
-  Ptr<const Packet> packet = 0;
-  for (PacketQueueI it = m_queue.begin (); it != m_queue.end (); it++)
+  for (uint32_t i = m_head; i != NONE; i = m_items[i].next)
     {
-      if (!it->hdr.IsQosData ()
-          || !blockedPackets->IsBlocked (it->hdr.GetAddr1 (), it->hdr.GetQosTid ()))
+      const Item &item = m_items[i];
+      if (!item.hdr.IsQosData ()
+          || !blockedPackets->IsBlocked (item.hdr.GetAddr1 (), item.hdr.GetQosTid ()))
         {
-          *hdr = it->hdr;
-          timestamp = it->tstamp;
-          packet = it->packet;
-          m_queue.erase (it);
-          m_size--;
+          *hdr = item.hdr;
+          timestamp = item.tstamp;
+          Ptr<const Packet> packet = item.packet;
+          Erase (i);
           return packet;
         }
     }
-  return packet;
+  return 0;
 }
 
 Ptr<const Packet>
@@ -331,14 +479,15 @@ WifiMacQueue::PeekFirstAvailable (WifiMacHeader *hdr, Time &timestamp,
                                   const QosBlockedDestinations *blockedPackets)
 {
   Cleanup ();
-  for (PacketQueueI it = m_queue.begin (); it != m_queue.end (); it++)
+  for (uint32_t i = m_head; i != NONE; i = m_items[i].next)
     {
-      if (!it->hdr.IsQosData ()
-          || !blockedPackets->IsBlocked (it->hdr.GetAddr1 (), it->hdr.GetQosTid ()))
+      const Item &item = m_items[i];
+      if (!item.hdr.IsQosData ()
+          || !blockedPackets->IsBlocked (item.hdr.GetAddr1 (), item.hdr.GetQosTid ()))
         {
-          *hdr = it->hdr;
-          timestamp = it->tstamp;
-          return it->packet;
+          *hdr = item.hdr;
+          timestamp = item.tstamp;
+          return item.packet;
         }
     }
   return 0;
@@ -22,11 +22,12 @@
 #ifndef WIFI_MAC_QUEUE_H
 #define WIFI_MAC_QUEUE_H
 
-#include <list>
+#include <vector>
 #include <utility>
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
+#include "ns3/sgi-hashmap.h"
 #include "wifi-mac-header.h"
 
 namespace ns3 {
@@ -48,6 +49,12 @@ class QosBlockedDestinations;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * The packets are stored in a pool of slots which is reused once it
+ * has grown to the working size of the queue, linked in FIFO order and,
+ * for QoS data packets, in one list per (address1, tid) pair.  Since
+ * packets are enqueued in timestamp order, only the head of the queue
+ * needs to be checked for expired packets.
  */
 class WifiMacQueue : public Object
 {
@@ -121,26 +128,54 @@ public:
   bool IsEmpty (void);
   uint32_t GetSize (void);
 private:
-  struct Item;
-
-  typedef std::list<struct Item> PacketQueue;
-  typedef std::list<struct Item>::reverse_iterator PacketQueueRI;
-  typedef std::list<struct Item>::iterator PacketQueueI;
-
-  void Cleanup (void);
-  Mac48Address GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQueueI);
-
   struct Item
   {
-    Item (Ptr<const Packet> packet,
-          const WifiMacHeader &hdr,
-          Time tstamp);
     Ptr<const Packet> packet;
     WifiMacHeader hdr;
     Time tstamp;
+    // FIFO list
+    uint32_t prev;
+    uint32_t next;
+    // per (address1, tid) list, only for QoS data
+    uint32_t flowPrev;
+    uint32_t flowNext;
+    // pushed at the head, out of timestamp order
+    bool pushedFront;
+  };
+  struct Flow
+  {
+    Flow () : head (NONE), tail (NONE), count (0) {}
+    uint32_t head;
+    uint32_t tail;
+    uint32_t count;
+  };
+  typedef std::pair<Mac48Address, uint8_t> FlowKey;
+  class FlowKeyHash
+  {
+  public:
+    size_t operator() (FlowKey const &x) const
+    {
+      return Mac48AddressHash () (x.first) * 17 + x.second;
+    }
   };
+  typedef sgi::hash_map<FlowKey, Flow, FlowKeyHash> Flows;
+
+  static const uint32_t NONE = 0xffffffff;
+
+  void Cleanup (void);
+  Mac48Address GetAddressForPacket (enum WifiMacHeader::AddressType type, uint32_t i);
+  uint32_t Allocate (Ptr<const Packet> packet, const WifiMacHeader &hdr);
+  void Erase (uint32_t i);
+  Flow *LookupFlow (uint8_t tid, Mac48Address addr);
+  uint32_t FindByTidAndAddress (uint8_t tid, WifiMacHeader::AddressType type, Mac48Address addr);
 
-  PacketQueue m_queue;
+  std::vector<Item> m_items;
+  uint32_t m_head;
+  uint32_t m_tail;
+  uint32_t m_free;
+  // slot returned by the last PeekByTidAndAddress, checked first by Remove
+  uint32_t m_peeked;
+  Flows m_flows;
   WifiMacParameters *m_parameters;
   uint32_t m_size;
   uint32_t m_maxSize;
@@ -171,6 +171,12 @@ WifiRemoteStationManager::GetTypeId (void)
                    WifiModeValue (),
                    MakeWifiModeAccessor (&WifiRemoteStationManager::m_nonUnicastMode),
                    MakeWifiModeChecker ())
+    .AddAttribute ("IdleStationTimeout", "Remote stations which are not associated and have not been used for "
+                   "this long are forgotten, together with their rate control state. Zero keeps every station "
+                   "which was ever heard.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&WifiRemoteStationManager::m_idleTimeout),
+                   MakeTimeChecker ())
     .AddTraceSource ("MacTxRtsFailed",
                      "The transmission of a RTS by the MAC layer has failed",
                      MakeTraceSourceAccessor (&WifiRemoteStationManager::m_macTxRtsFailed))
@@ -199,12 +205,12 @@ WifiRemoteStationManager::DoDispose (void)
 {
   for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_states.clear ();
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_stations.clear ();
 }
@@ -676,18 +682,25 @@ WifiRemoteStationManager::GetInfo (Mac48Address address)
 WifiRemoteStationState *
 WifiRemoteStationManager::LookupState (Mac48Address address) const
 {
-  for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+  StationStates::const_iterator i = m_states.find (address);
+  if (i != m_states.end ())
     {
-      if ((*i)->m_address == address)
+      if (!m_idleTimeout.IsZero ())
         {
-          return (*i);
+          i->second->m_lastUsed = Simulator::Now ();
         }
+      return i->second;
+    }
+  if (!m_idleTimeout.IsZero () && Simulator::Now () - m_lastEviction >= m_idleTimeout)
+    {
+      EvictIdleStations ();
     }
   WifiRemoteStationState *state = new WifiRemoteStationState ();
   state->m_state = WifiRemoteStationState::BRAND_NEW;
   state->m_address = address;
   state->m_operationalRateSet.push_back (GetDefaultMode ());
-  const_cast<WifiRemoteStationManager *> (this)->m_states.push_back (state);
+  state->m_lastUsed = Simulator::Now ();
+  m_states[address] = state;
   return state;
 }
 WifiRemoteStation *
@@ -707,13 +720,14 @@ WifiRemoteStationManager::Lookup (Mac48Address address, const WifiMacHeader *hea
 WifiRemoteStation *
 WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
 {
-  for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
+  Stations::const_iterator i = m_stations.find (StationKey (address, tid));
+  if (i != m_stations.end ())
     {
-      if ((*i)->m_tid == tid
-          && (*i)->m_state->m_address == address)
+      if (!m_idleTimeout.IsZero ())
         {
-          return (*i);
+          i->second->m_state->m_lastUsed = Simulator::Now ();
         }
+      return i->second;
     }
   WifiRemoteStationState *state = LookupState (address);
 
@@ -722,12 +736,53 @@ WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
   station->m_tid = tid;
   station->m_ssrc = 0;
   station->m_slrc = 0;
-  // XXX
-  const_cast<WifiRemoteStationManager *> (this)->m_stations.push_back (station);
+  m_stations[StationKey (address, tid)] = station;
   return station;
 
 }
 
+//
+// Forget the stations which were not used for m_idleTimeout, so that a
+// node which hears a stream of passing vehicles does not keep them all.
+// Associated stations are kept since forgetting them would drop the
+// association.  The station being looked up right now is never idle.
+//
+void
+WifiRemoteStationManager::EvictIdleStations (void) const
+{
+  Time now = Simulator::Now ();
+  m_lastEviction = now;
+  for (Stations::iterator i = m_stations.begin (); i != m_stations.end (); )
+    {
+      WifiRemoteStationState *state = i->second->m_state;
+      if (state->m_state != WifiRemoteStationState::GOT_ASSOC_TX_OK
+          && now - state->m_lastUsed >= m_idleTimeout)
+        {
+          delete i->second;
+          m_stations.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  for (StationStates::iterator i = m_states.begin (); i != m_states.end (); )
+    {
+      WifiRemoteStationState *state = i->second;
+      if (state->m_state != WifiRemoteStationState::GOT_ASSOC_TX_OK
+          && now - state->m_lastUsed >= m_idleTimeout)
+        {
+          NS_LOG_DEBUG ("forget idle station " << state->m_address);
+          delete state;
+          m_states.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
 WifiMode
 WifiRemoteStationManager::GetDefaultMode (void) const
 {
@@ -738,7 +793,7 @@ WifiRemoteStationManager::Reset (void)
 {
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_stations.clear ();
   m_bssBasicRateSet.clear ();
@@ -27,6 +27,7 @@
 #include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/nstime.h"
+#include "ns3/sgi-hashmap.h"
 #include "wifi-mode.h"
 
 namespace ns3 {
@@ -395,11 +396,28 @@ private:
   WifiMode GetControlAnswerMode (Mac48Address address, WifiMode reqMode);
   uint32_t GetNFragments (Ptr<const Packet> packet);
 
-  typedef std::vector <WifiRemoteStation *> Stations;
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  void EvictIdleStations (void) const;
 
-  StationStates m_states;
-  Stations m_stations;
+  typedef std::pair<Mac48Address, uint8_t> StationKey;
+  class StationKeyHash
+  {
+  public:
+    size_t operator() (StationKey const &x) const
+    {
+      return Mac48AddressHash () (x.first) * 17 + x.second;
+    }
+  };
+  typedef sgi::hash_map<StationKey, WifiRemoteStation *, StationKeyHash> Stations;
+  typedef sgi::hash_map<Mac48Address, WifiRemoteStationState *, Mac48AddressHash> StationStates;
+
+  mutable StationStates m_states;
+  mutable Stations m_stations;
+  /**
+   * Stations which have not been used for this long are forgotten, unless
+   * they are associated.  Zero means that stations are never forgotten.
+   */
+  Time m_idleTimeout;
+  mutable Time m_lastEviction;
   /**
    * This is a pointer to the WifiPhy associated with this
    * WifiRemoteStationManager that is set on call to
@@ -472,6 +490,9 @@ struct WifiRemoteStationState
 
   Mac48Address m_address;
   WifiRemoteStationInfo m_info;
+  /// last time this station was looked up, only kept when the
+  /// IdleStationTimeout attribute is set.
+  Time m_lastUsed;
 };
 
 /**
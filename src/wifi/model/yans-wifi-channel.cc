@@ -29,6 +29,7 @@
 #include "yans-wifi-phy.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
@@ -61,6 +62,7 @@ YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_phyList.clear ();
+  m_channelPhys.clear ();
 }
 
 void
@@ -80,18 +82,15 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  // For now don't account for inter channel interference
+  ChannelPhys::const_iterator phys = m_channelPhys.find (sender->GetChannelNumber ());
+  NS_ASSERT (phys != m_channelPhys.end ());
+  for (PhyIndexes::const_iterator i = phys->second.begin (); i != phys->second.end (); i++)
     {
-      if (sender != (*i))
+      uint32_t j = *i;
+      if (sender != m_phyList[j])
         {
-          // For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
-            {
-              continue;
-            }
-
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->GetObject<MobilityModel> ();
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
@@ -135,7 +134,29 @@ YansWifiChannel::GetDevice (uint32_t i) const
 void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
+  m_channelPhys[phy->GetChannelNumber ()].push_back (m_phyList.size ());
   m_phyList.push_back (phy);
 }
 
+void
+YansWifiChannel::NotifyChannelNumberChange (Ptr<YansWifiPhy> phy, uint16_t oldChannelNumber)
+{
+  NS_LOG_FUNCTION (this << phy << oldChannelNumber << phy->GetChannelNumber ());
+  PhyIndexes &from = m_channelPhys[oldChannelNumber];
+  for (PhyIndexes::iterator i = from.begin (); i != from.end (); i++)
+    {
+      if (m_phyList[*i] == phy)
+        {
+          uint32_t j = *i;
+          from.erase (i);
+          // keep the indexes sorted so that receptions are scheduled in
+          // the order in which the PHYs were added.
+          PhyIndexes &to = m_channelPhys[phy->GetChannelNumber ()];
+          to.insert (std::lower_bound (to.begin (), to.end (), j), j);
+          return;
+        }
+    }
+  NS_FATAL_ERROR ("PHY not found on channel " << oldChannelNumber);
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <map>
 #include <stdint.h>
 #include "ns3/packet.h"
 #include "wifi-channel.h"
@@ -59,6 +60,14 @@ public:
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
   void Add (Ptr<YansWifiPhy> phy);
+  /**
+   * \param phy a PHY already added to this channel.
+   * \param oldChannelNumber the channel number the PHY just left.
+   *
+   * Invoked by YansWifiPhy whenever its channel number changes so that
+   * the PHYs can be indexed by channel number.
+   */
+  void NotifyChannelNumberChange (Ptr<YansWifiPhy> phy, uint16_t oldChannelNumber);
 
   /**
    * \param loss the new propagation loss model.
@@ -79,7 +88,8 @@ public:
    * This method should not be invoked by normal users. It is
    * currently invoked only from WifiPhy::Send. YansWifiChannel
    * delivers packets only between PHYs with the same m_channelNumber,
-   * e.g. PHYs that are operating on the same channel.
+   * e.g. PHYs that are operating on the same channel, and only visits
+   * the PHYs of that channel.
    */
   void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
              WifiMode wifiMode, WifiPreamble preamble) const;
@@ -89,11 +99,15 @@ private:
   YansWifiChannel (const YansWifiChannel &);
 
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+  // indexes in m_phyList of the PHYs on a channel number, sorted.
+  typedef std::vector<uint32_t> PhyIndexes;
+  typedef std::map<uint16_t, PhyIndexes> ChannelPhys;
   void Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
                 WifiMode txMode, WifiPreamble preamble) const;
 
 
   PhyList m_phyList;
+  ChannelPhys m_channelPhys;
   Ptr<PropagationLossModel> m_loss;
   Ptr<PropagationDelayModel> m_delay;
 };
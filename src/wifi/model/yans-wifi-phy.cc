@@ -331,7 +331,12 @@ YansWifiPhy::SetChannelNumber (uint16_t nch)
     {
       // this is not channel switch, this is initialization
       NS_LOG_DEBUG ("start at channel " << nch);
+      uint16_t old = m_channelNumber;
       m_channelNumber = nch;
+      if (m_channel != 0 && old != nch)
+        {
+          m_channel->NotifyChannelNumberChange (this, old);
+        }
       return;
     }
 
@@ -370,7 +375,12 @@ switchChannel:
    * state are added to the event list and are employed later to figure
    * out the state of the medium after the switching.
    */
+  uint16_t old = m_channelNumber;
   m_channelNumber = nch;
+  if (m_channel != 0 && old != nch)
+    {
+      m_channel->NotifyChannelNumberChange (this, old);
+    }
 }
 
 uint16_t
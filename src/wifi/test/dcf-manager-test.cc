@@ -74,6 +74,7 @@ private:
   void EndTest (void);
   void ExpectInternalCollision (uint64_t time, uint32_t from, uint32_t nSlots);
   void ExpectCollision (uint64_t time, uint32_t from, uint32_t nSlots);
+  void ExpectAvoidedReschedules (uint64_t n);
   void AddRxOkEvt (uint64_t at, uint64_t duration);
   void AddRxErrorEvt (uint64_t at, uint64_t duration);
   void AddRxInsideSifsEvt (uint64_t at, uint64_t duration);
@@ -98,6 +99,8 @@ private:
   DcfManager *m_dcfManager;
   DcfStates m_dcfStates;
   uint32_t m_ackTimeoutValue;
+  bool m_checkAvoidedReschedules;
+  uint64_t m_expectedAvoidedReschedules;
 };
 
 
@@ -216,6 +219,7 @@ DcfManagerTest::StartTest (uint64_t slotTime, uint64_t sifs, uint64_t eifsNoDifs
   m_dcfManager->SetSifs (MicroSeconds (sifs));
   m_dcfManager->SetEifsNoDifs (MicroSeconds (eifsNoDifsNoSifs + sifs));
   m_ackTimeoutValue = ackTimeoutValue;
+  m_checkAvoidedReschedules = false;
 }
 
 void
@@ -232,6 +236,11 @@ DcfManagerTest::EndTest (void)
 {
   Simulator::Run ();
   Simulator::Destroy ();
+  if (m_checkAvoidedReschedules)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_dcfManager->GetAvoidedReschedules (), m_expectedAvoidedReschedules,
+                             "Unexpected number of deferred access timeouts");
+    }
   for (DcfStates::const_iterator i = m_dcfStates.begin (); i != m_dcfStates.end (); i++)
     {
       DcfStateTest *state = *i;
@@ -244,6 +253,13 @@ DcfManagerTest::EndTest (void)
   delete m_dcfManager;
 }
 
+void
+DcfManagerTest::ExpectAvoidedReschedules (uint64_t n)
+{
+  m_checkAvoidedReschedules = true;
+  m_expectedAvoidedReschedules = n;
+}
+
 void
 DcfManagerTest::AddRxOkEvt (uint64_t at, uint64_t duration)
 {
@@ -444,6 +460,9 @@ DcfManagerTest::DoRun (void)
   AddRxErrorEvt (20, 40);
   AddAccessRequest (30, 2, 102, 0);
   ExpectCollision (30, 4, 0); // backoff: 4 slots
+  // the access timeout is only scheduled at the end of the rx, once the
+  // eifs is known.
+  ExpectAvoidedReschedules (1);
   EndTest ();
 
   // Test an EIFS which is interupted by a successfull transmission.
@@ -25,18 +25,30 @@
 #include "ns3/adhoc-wifi-mac.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/arf-wifi-manager.h"
+#include "ns3/wave-wifi-mac.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/error-rate-model.h"
 #include "ns3/yans-error-rate-model.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/table-error-rate-model.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 #include "ns3/object-factory.h"
 #include "ns3/dca-txop.h"
+#include "ns3/wifi-mac-queue.h"
 #include "ns3/mac-rx-middle.h"
 #include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include <cmath>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <map>
 
 namespace ns3 {
 
@@ -177,6 +189,269 @@ public:
   }
 };
 
+//-----------------------------------------------------------------------------
+class IdleStationEvictionTest : public TestCase
+{
+public:
+  IdleStationEvictionTest () : TestCase ("Forget idle remote stations")
+  {
+  }
+  virtual void DoRun (void)
+  {
+    Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+    phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+    Ptr<ArfWifiManager> manager = CreateObject<ArfWifiManager> ();
+    manager->SetAttribute ("IdleStationTimeout", TimeValue (Seconds (10)));
+    manager->SetupPhy (phy);
+
+    Mac48Address associated ("00:00:00:00:00:01");
+    Mac48Address disassociated ("00:00:00:00:00:02");
+    Mac48Address busy ("00:00:00:00:00:03");
+    manager->RecordGotAssocTxOk (associated);
+    manager->RecordDisassociated (disassociated);
+    manager->RecordWaitAssocTxOk (busy);
+    Simulator::Schedule (Seconds (5), &WifiRemoteStationManager::RecordWaitAssocTxOk, manager, busy);
+    Simulator::Schedule (Seconds (12), &IdleStationEvictionTest::LookupNewStation, this, manager);
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (associated), true, "associated stations are never forgotten");
+    NS_TEST_EXPECT_MSG_EQ (manager->IsBrandNew (disassociated), true, "idle station should have been forgotten");
+    NS_TEST_EXPECT_MSG_EQ (manager->IsWaitAssocTxOk (busy), true, "recently used station should be kept");
+    manager->Dispose ();
+    phy->Dispose ();
+  }
+private:
+  void LookupNewStation (Ptr<WifiRemoteStationManager> manager)
+  {
+    manager->IsBrandNew (Mac48Address ("00:00:00:00:00:04"));
+  }
+};
+
+//-----------------------------------------------------------------------------
+class TableErrorRateModelTest : public TestCase
+{
+public:
+  TableErrorRateModelTest () : TestCase ("Tabulated error rate model")
+  {
+  }
+  virtual void DoRun (void)
+  {
+    std::ostringstream oss;
+    oss << rand () << ".per";
+    std::string cacheFile = CreateTempDirFilename (oss.str ());
+
+    Ptr<NistErrorRateModel> nist = CreateObject<NistErrorRateModel> ();
+    Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+    table->SetAttribute ("CacheFile", StringValue (cacheFile));
+    WifiMode modes[] = { WifiPhy::GetOfdmRate6Mbps (), WifiPhy::GetOfdmRate12Mbps (),
+                         WifiPhy::GetOfdmRate24Mbps (), WifiPhy::GetOfdmRate54Mbps (),
+                         WifiPhy::GetDsssRate1Mbps () };
+    uint32_t sizes[] = { 8, 8 * 100, 8 * 1500 };
+    for (uint32_t m = 0; m < sizeof (modes) / sizeof (modes[0]); m++)
+      {
+        for (double snrDb = -15; snrDb < 45; snrDb += 0.37)
+          {
+            double snr = std::pow (10.0, snrDb / 10.0);
+            for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s++)
+              {
+                double expected = nist->GetChunkSuccessRate (modes[m], snr, sizes[s]);
+                double actual = table->GetChunkSuccessRate (modes[m], snr, sizes[s]);
+                NS_TEST_ASSERT_MSG_EQ_TOL (actual, expected, 0.01, "mode=" << modes[m] << " snr=" << snrDb << "dB nbits=" << sizes[s]);
+              }
+          }
+      }
+
+    // a second model reads the tables back from the cache file.
+    Ptr<TableErrorRateModel> cached = CreateObject<TableErrorRateModel> ();
+    cached->SetAttribute ("CacheFile", StringValue (cacheFile));
+    for (uint32_t m = 0; m < sizeof (modes) / sizeof (modes[0]); m++)
+      {
+        double snr = std::pow (10.0, 0.8);
+        NS_TEST_ASSERT_MSG_EQ_TOL (cached->GetChunkSuccessRate (modes[m], snr, 8 * 500),
+                                   table->GetChunkSuccessRate (modes[m], snr, 8 * 500),
+                                   1e-12, "cached table of " << modes[m] << " differs");
+      }
+    std::ifstream is (cacheFile.c_str ());
+    uint32_t lines = 0;
+    std::string line;
+    while (std::getline (is, line))
+      {
+        lines++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (lines, 1 + sizeof (modes) / sizeof (modes[0]), "the cache should hold one table per mode");
+    remove (cacheFile.c_str ());
+
+    // the tables built before a change of their range are not used anymore.
+    Ptr<TableErrorRateModel> ranged = CreateObject<TableErrorRateModel> ();
+    double snr = std::pow (10.0, 0.3);
+    ranged->GetChunkSuccessRate (modes[0], snr, 8 * 100);
+    ranged->SetAttribute ("MinSnr", DoubleValue (-20.0));
+    NS_TEST_EXPECT_MSG_EQ_TOL (ranged->GetChunkSuccessRate (modes[0], snr, 8 * 100),
+                               nist->GetChunkSuccessRate (modes[0], snr, 8 * 100),
+                               0.01, "table built for the previous range used");
+  }
+};
+
+//-----------------------------------------------------------------------------
+class WaveWifiMacTest : public TestCase
+{
+public:
+  WaveWifiMacTest () : TestCase ("Alternating CCH and SCH channel access")
+  {
+  }
+  virtual void DoRun (void);
+private:
+  Ptr<WifiNetDevice> CreateOne (Vector pos, Ptr<YansWifiChannel> channel);
+  void Send (Ptr<WifiNetDevice> dev, Address to, uint32_t size);
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  std::map<uint32_t, Time> m_received;
+};
+
+Ptr<WifiNetDevice>
+WaveWifiMacTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+  Ptr<WifiMac> mac = CreateObject<WaveWifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (node);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (CreateObject<ArfWifiManager> ());
+  node->AddDevice (dev);
+  dev->SetReceiveCallback (MakeCallback (&WaveWifiMacTest::Receive, this));
+  return dev;
+}
+
+void
+WaveWifiMacTest::Send (Ptr<WifiNetDevice> dev, Address to, uint32_t size)
+{
+  dev->Send (Create<Packet> (size), to, 1);
+}
+
+bool
+WaveWifiMacTest::Receive (Ptr<NetDevice> dev, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_received[packet->GetSize ()] = Simulator::Now ();
+  return true;
+}
+
+void
+WaveWifiMacTest::DoRun (void)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  Ptr<WifiNetDevice> a = CreateOne (Vector (0.0, 0.0, 0.0), channel);
+  Ptr<WifiNetDevice> b = CreateOne (Vector (5.0, 0.0, 0.0), channel);
+
+  // sync intervals start every 100ms, CCH first, with a 4ms guard.
+  Simulator::Schedule (Seconds (1.010), &WaveWifiMacTest::Send, this, a, a->GetBroadcast (), 100);
+  Simulator::Schedule (Seconds (1.020), &WaveWifiMacTest::Send, this, a, b->GetAddress (), 200);
+  Simulator::Schedule (Seconds (1.060), &WaveWifiMacTest::Send, this, a, a->GetBroadcast (), 300);
+  Simulator::Schedule (Seconds (1.102), &WaveWifiMacTest::Send, this, a, a->GetBroadcast (), 400);
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 4, "all the packets should have been received");
+  NS_TEST_EXPECT_MSG_EQ ((m_received[100] > Seconds (1.010) && m_received[100] < Seconds (1.050)), true,
+                         "broadcast sent during the CCH interval is received right away, got " << m_received[100]);
+  NS_TEST_EXPECT_MSG_EQ ((m_received[200] > Seconds (1.054) && m_received[200] < Seconds (1.100)), true,
+                         "unicast waits for the SCH interval, got " << m_received[200]);
+  NS_TEST_EXPECT_MSG_EQ ((m_received[300] > Seconds (1.104) && m_received[300] < Seconds (1.150)), true,
+                         "broadcast waits for the next CCH interval, got " << m_received[300]);
+  NS_TEST_EXPECT_MSG_EQ ((m_received[400] > Seconds (1.104) && m_received[400] < Seconds (1.150)), true,
+                         "broadcast waits for the end of the guard interval, got " << m_received[400]);
+  NS_TEST_EXPECT_MSG_EQ ((m_received[300] < m_received[400]), true, "queued packets keep their order");
+}
+
+//-----------------------------------------------------------------------------
+class WifiMacQueueTest : public TestCase
+{
+public:
+  WifiMacQueueTest ()
+    : TestCase ("WifiMacQueue per destination and tid lists"),
+      m_a ("00:00:00:00:00:0a"),
+      m_b ("00:00:00:00:00:0b")
+  {
+  }
+  virtual void DoRun (void)
+  {
+    m_queue = CreateObject<WifiMacQueue> ();
+    m_queue->SetMaxDelay (Seconds (1.0));
+    Simulator::Schedule (Seconds (0.0), &WifiMacQueueTest::Fill, this);
+    Simulator::Schedule (Seconds (0.5), &WifiMacQueueTest::Check, this);
+    Simulator::Schedule (Seconds (1.2), &WifiMacQueueTest::CheckExpiry, this);
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+private:
+  WifiMacHeader MakeHeader (Mac48Address to, uint8_t tid)
+  {
+    WifiMacHeader hdr;
+    hdr.SetType (WIFI_MAC_QOSDATA);
+    hdr.SetQosTid (tid);
+    hdr.SetAddr1 (to);
+    return hdr;
+  }
+  void Fill (void)
+  {
+    for (uint32_t i = 0; i < 60; i++)
+      {
+        m_queue->Enqueue (Create<Packet> (i + 1), MakeHeader (i % 3 ? m_a : m_b, i % 2));
+      }
+  }
+  void Check (void)
+  {
+    WifiMacHeader hdr;
+    NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), 60, "all the packets are queued");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, m_b), 10, "packets 3, 9, ...");
+    Ptr<const Packet> p = m_queue->PeekByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, m_b);
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 4, "first packet to b with tid 1");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->Remove (p), true, "peeked packet is removed");
+    p = m_queue->DequeueByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, m_b);
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "second packet to b with tid 1");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, m_b), 8, "two packets removed");
+    m_queue->PushFront (p, hdr);
+    p = m_queue->PeekByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, m_b);
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "pushed back at the head");
+    p = m_queue->Dequeue (&hdr);
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "pushed back at the head");
+    p = m_queue->Dequeue (&hdr);
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 1, "then the oldest packet");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), 57, "three packets removed");
+    // a packet enqueued now survives the others
+    m_queue->Enqueue (Create<Packet> (100), MakeHeader (m_b, 1));
+    m_queue->PushFront (Create<Packet> (200), MakeHeader (m_a, 0));
+  }
+  void CheckExpiry (void)
+  {
+    WifiMacHeader hdr;
+    NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, m_b), 1, "old packets expired");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, WifiMacHeader::ADDR1, m_a), 1, "old packets expired");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), 2, "old packets expired");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->Dequeue (&hdr)->GetSize (), 200, "pushed at the head");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->Dequeue (&hdr)->GetSize (), 100, "last packet");
+    NS_TEST_EXPECT_MSG_EQ (m_queue->IsEmpty (), true, "queue is empty");
+  }
+
+  Ptr<WifiMacQueue> m_queue;
+  Mac48Address m_a;
+  Mac48Address m_b;
+};
+
 //-----------------------------------------------------------------------------
 class InterferenceHelperSequenceTest : public TestCase
 {
@@ -297,6 +572,10 @@ WifiTestSuite::WifiTestSuite ()
 {
   AddTestCase (new WifiTest);
   AddTestCase (new QosUtilsIsOldPacketTest);
+  AddTestCase (new IdleStationEvictionTest);
+  AddTestCase (new TableErrorRateModelTest);
+  AddTestCase (new WaveWifiMacTest);
+  AddTestCase (new WifiMacQueueTest);
   AddTestCase (new InterferenceHelperSequenceTest); // Bug 991
 }
 
@@ -0,0 +1,801 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Benchmarks of the hot paths of typical wireless simulations.
+//
+// Each benchmark is run for a number of samples of a fixed number of
+// operations, calibrated so that a sample lasts at least --min-sample-time
+// milliseconds.  The time per operation of the samples is reported as JSON
+// with percentiles.  With --baseline, the medians are compared to those of
+// a previous JSON report and the program exits with status 1 if any of them
+// got slower by more than --tolerance.
+//
+//   ./waf --run "bench-hotpaths --output=baseline.json"
+//   ./waf --run "bench-hotpaths --baseline=baseline.json --filter=scheduler"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/interference-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/gpsr-ptable.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/scheduler.h"
+#include <sys/time.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <cmath>
+
+using namespace ns3;
+
+namespace {
+
+// A small deterministic generator: the benchmarks must see the same
+// inputs whatever the seed of the simulation and the benchmarks selected.
+class BenchRandom
+{
+public:
+  BenchRandom (uint32_t seed) : m_state (seed) {}
+  uint32_t GetInteger (void)
+  {
+    m_state = m_state * 1103515245 + 12345;
+    return m_state >> 8;
+  }
+  double GetValue (double max)
+  {
+    return max * (GetInteger () & 0xffffff) / 0x1000000;
+  }
+private:
+  uint32_t m_state;
+};
+
+class Benchmark
+{
+public:
+  virtual ~Benchmark () {}
+  virtual std::string GetName (void) const = 0;
+  // called once before the first sample and once after the last one.
+  virtual void Setup (void) {}
+  virtual void Teardown (void) {}
+  // the timed part of a sample: n operations.
+  virtual void Run (uint32_t n) = 0;
+  // called after each sample, not timed.
+  virtual void Drain (void) {}
+};
+
+// ===========================================================================
+// YansWifiChannel::Send to n phys, most of them in range of the sender.
+// Only the fan-out is timed, the receptions are run between the samples.
+// ===========================================================================
+class ChannelSendBenchmark : public Benchmark
+{
+public:
+  ChannelSendBenchmark (uint32_t nPhys) : m_nPhys (nPhys) {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "yans-channel-send/n=" << m_nPhys;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    NodeContainer nodes;
+    nodes.Create (m_nPhys);
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                   "DeltaX", DoubleValue (10.0),
+                                   "DeltaY", DoubleValue (10.0),
+                                   "GridWidth", UintegerValue (16));
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.Install (nodes);
+    WifiHelper wifi = WifiHelper::Default ();
+    wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+    wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager");
+    YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+    YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+    phy.SetChannel (channel.Create ());
+    NqosWifiMacHelper mac = NqosWifiMacHelper::Default ();
+    mac.SetType ("ns3::AdhocWifiMac");
+    NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+    m_phy = DynamicCast<YansWifiPhy> (DynamicCast<WifiNetDevice> (devices.Get (0))->GetPhy ());
+    m_channel = DynamicCast<YansWifiChannel> (m_phy->GetChannel ());
+    m_mode = WifiPhy::GetOfdmRate6Mbps ();
+    // a data frame for nobody, dropped by the MAC of the receivers.
+    WifiMacHeader hdr;
+    hdr.SetTypeData ();
+    hdr.SetAddr1 (Mac48Address ("00:00:00:00:ff:fe"));
+    hdr.SetAddr2 (Mac48Address ("00:00:00:00:ff:fd"));
+    hdr.SetAddr3 (Mac48Address ("00:00:00:00:ff:fd"));
+    Ptr<Packet> packet = Create<Packet> (1000);
+    packet->AddHeader (hdr);
+    m_packet = packet;
+  }
+  virtual void Run (uint32_t n)
+  {
+    for (uint32_t i = 0; i < n; i++)
+      {
+        m_channel->Send (m_phy, m_packet, 16.0206, m_mode, WIFI_PREAMBLE_LONG);
+      }
+  }
+  virtual void Drain (void)
+  {
+    Simulator::Run ();
+  }
+  virtual void Teardown (void)
+  {
+    m_phy = 0;
+    m_channel = 0;
+    m_packet = 0;
+    Simulator::Destroy ();
+  }
+private:
+  uint32_t m_nPhys;
+  Ptr<YansWifiPhy> m_phy;
+  Ptr<YansWifiChannel> m_channel;
+  Ptr<const Packet> m_packet;
+  WifiMode m_mode;
+};
+
+// ===========================================================================
+// InterferenceHelper: k overlapping frames of different durations and
+// powers, then the SNR and PER of the strongest one.
+// ===========================================================================
+class InterferenceBenchmark : public Benchmark
+{
+public:
+  InterferenceBenchmark (uint32_t nFrames) : m_nFrames (nFrames), m_sink (0) {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "interference-helper/k=" << m_nFrames;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    m_interference.SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+    m_interference.SetNoiseFigure (std::pow (10.0, 7.0 / 10.0));
+    m_mode = WifiPhy::GetOfdmRate24Mbps ();
+    for (uint32_t i = 0; i < m_nFrames; i++)
+      {
+        uint32_t size = 200 + 97 * i % 1300;
+        m_sizes.push_back (size);
+        m_durations.push_back (WifiPhy::CalculateTxDuration (size, m_mode, WIFI_PREAMBLE_LONG));
+      }
+  }
+  virtual void Run (uint32_t n)
+  {
+    for (uint32_t i = 0; i < n; i++)
+      {
+        m_interference.NotifyRxStart ();
+        Ptr<InterferenceHelper::Event> first;
+        for (uint32_t j = 0; j < m_nFrames; j++)
+          {
+            Ptr<InterferenceHelper::Event> event = m_interference.Add (m_sizes[j], m_mode, WIFI_PREAMBLE_LONG,
+                                                                       m_durations[j], 1e-9 / (j + 1));
+            if (j == 0)
+              {
+                first = event;
+              }
+          }
+        struct InterferenceHelper::SnrPer snrPer = m_interference.CalculateSnrPer (first);
+        m_sink += snrPer.per;
+        m_interference.NotifyRxEnd ();
+        m_interference.EraseEvents ();
+      }
+  }
+private:
+  uint32_t m_nFrames;
+  InterferenceHelper m_interference;
+  WifiMode m_mode;
+  std::vector<uint32_t> m_sizes;
+  std::vector<Time> m_durations;
+  double m_sink;
+};
+
+// ===========================================================================
+// GPSR greedy forwarding: PositionTable::BestNeighbor among n neighbors.
+// ===========================================================================
+class BestNeighborBenchmark : public Benchmark
+{
+public:
+  BestNeighborBenchmark (uint32_t nNeighbors) : m_nNeighbors (nNeighbors), m_sink (0) {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "gpsr-best-neighbor/n=" << m_nNeighbors;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    BenchRandom random (m_nNeighbors);
+    for (uint32_t i = 0; i < m_nNeighbors; i++)
+      {
+        m_table.AddEntry (Ipv4Address (0x0a000001 + i), Vector (random.GetValue (250.0), random.GetValue (250.0), 0));
+      }
+    for (uint32_t i = 0; i < 64; i++)
+      {
+        m_destinations.push_back (Vector (random.GetValue (5000.0), random.GetValue (5000.0), 0));
+      }
+  }
+  virtual void Run (uint32_t n)
+  {
+    Vector position (125.0, 125.0, 0);
+    for (uint32_t i = 0; i < n; i++)
+      {
+        m_sink += m_table.BestNeighbor (m_destinations[i % m_destinations.size ()], position).Get ();
+      }
+  }
+  virtual void Teardown (void)
+  {
+    m_table.Clear ();
+    Simulator::Destroy ();
+  }
+private:
+  uint32_t m_nNeighbors;
+  gpsr::PositionTable m_table;
+  std::vector<Vector> m_destinations;
+  uint32_t m_sink;
+};
+
+// ===========================================================================
+// Ipv4StaticRouting::RouteOutput in a table of n network routes of random
+// prefix lengths, with a default route.
+// ===========================================================================
+class StaticRoutingBenchmark : public Benchmark
+{
+public:
+  StaticRoutingBenchmark (uint32_t nRoutes) : m_nRoutes (nRoutes), m_sink (0) {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "ipv4-static-routing-lookup/routes=" << m_nRoutes;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    Ptr<Node> node = CreateObject<Node> ();
+    InternetStackHelper internet;
+    internet.Install (node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+    for (uint32_t i = 0; i < 4; i++)
+      {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+        device->SetAddress (Mac48Address::Allocate ());
+        node->AddDevice (device);
+        uint32_t interface = ipv4->AddInterface (device);
+        ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (0xc0a80001 + (i << 8)), Ipv4Mask ("255.255.255.0")));
+        ipv4->SetUp (interface);
+      }
+    Ipv4StaticRoutingHelper helper;
+    m_routing = helper.GetStaticRouting (ipv4);
+    m_routing->SetDefaultRoute (Ipv4Address ("192.168.0.254"), 1);
+    BenchRandom random (m_nRoutes);
+    for (uint32_t i = 0; i < m_nRoutes; i++)
+      {
+        uint32_t length = 16 + random.GetInteger () % 13;
+        Ipv4Address network (0x0a000000 | (random.GetInteger () & 0xffffff));
+        Ipv4Mask mask (0xffffffff << (32 - length));
+        m_routing->AddNetworkRouteTo (network.CombineMask (mask), mask, Ipv4Address (0xc0a80002 + (i % 4 << 8)),
+                                      1 + i % 4, random.GetInteger () % 3);
+      }
+    for (uint32_t i = 0; i < 256; i++)
+      {
+        Ipv4Header header;
+        header.SetDestination (Ipv4Address (0x0a000000 | (random.GetInteger () & 0xffffff)));
+        m_headers.push_back (header);
+      }
+  }
+  virtual void Run (uint32_t n)
+  {
+    Socket::SocketErrno error;
+    for (uint32_t i = 0; i < n; i++)
+      {
+        Ptr<Ipv4Route> route = m_routing->RouteOutput (0, m_headers[i % m_headers.size ()], 0, error);
+        m_sink += route->GetGateway ().Get ();
+      }
+  }
+  virtual void Teardown (void)
+  {
+    m_routing = 0;
+    m_headers.clear ();
+    Simulator::Destroy ();
+  }
+private:
+  uint32_t m_nRoutes;
+  Ptr<Ipv4StaticRouting> m_routing;
+  std::vector<Ipv4Header> m_headers;
+  uint32_t m_sink;
+};
+
+// ===========================================================================
+// The receive path of a wifi frame: Packet::Copy and the removal of the
+// wifi, LLC, IPv4 and UDP headers.
+// ===========================================================================
+class PacketHeadersBenchmark : public Benchmark
+{
+public:
+  PacketHeadersBenchmark (uint32_t size) : m_size (size), m_sink (0) {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "packet-copy-remove-headers/size=" << m_size;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    m_packet = Create<Packet> (m_size);
+    UdpHeader udp;
+    udp.SetSourcePort (49153);
+    udp.SetDestinationPort (9);
+    m_packet->AddHeader (udp);
+    Ipv4Header ipv4;
+    ipv4.SetSource (Ipv4Address ("10.0.0.1"));
+    ipv4.SetDestination (Ipv4Address ("10.0.0.2"));
+    ipv4.SetProtocol (17);
+    ipv4.SetPayloadSize (m_packet->GetSize ());
+    m_packet->AddHeader (ipv4);
+    LlcSnapHeader llc;
+    llc.SetType (0x0800);
+    m_packet->AddHeader (llc);
+    WifiMacHeader wifi;
+    wifi.SetTypeData ();
+    m_packet->AddHeader (wifi);
+  }
+  virtual void Run (uint32_t n)
+  {
+    for (uint32_t i = 0; i < n; i++)
+      {
+        Ptr<Packet> copy = m_packet->Copy ();
+        WifiMacHeader wifi;
+        copy->RemoveHeader (wifi);
+        LlcSnapHeader llc;
+        copy->RemoveHeader (llc);
+        Ipv4Header ipv4;
+        copy->RemoveHeader (ipv4);
+        UdpHeader udp;
+        copy->RemoveHeader (udp);
+        m_sink += udp.GetDestinationPort ();
+      }
+  }
+  virtual void Teardown (void)
+  {
+    m_packet = 0;
+  }
+private:
+  uint32_t m_size;
+  Ptr<Packet> m_packet;
+  uint32_t m_sink;
+};
+
+// ===========================================================================
+// The sender side of a bulk TCP transfer: segments of one MSS are taken
+// from a send buffer filled by writes of 512 bytes, half a window after
+// the first unacknowledged byte.
+// ===========================================================================
+class TcpTxBufferBenchmark : public Benchmark
+{
+public:
+  TcpTxBufferBenchmark (uint32_t window) : m_window (window), m_sink (0) {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "tcp-tx-buffer-segment/window=" << m_window;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    m_buffer = CreateObject<TcpTxBuffer> (0);
+    m_buffer->SetMaxBufferSize (m_window);
+    Fill ();
+    m_next = m_buffer->HeadSequence () + SequenceNumber32 (m_window / 2);
+  }
+  virtual void Run (uint32_t n)
+  {
+    for (uint32_t i = 0; i < n; i++)
+      {
+        Ptr<Packet> segment = m_buffer->CopyFromSequence (536, m_next);
+        m_sink += segment->GetSize ();
+        m_next += 536;
+        m_buffer->DiscardUpTo (m_next - m_window / 2);
+        Fill ();
+      }
+  }
+  virtual void Teardown (void)
+  {
+    m_buffer = 0;
+  }
+private:
+  void Fill (void)
+  {
+    while (m_buffer->Available () >= 512)
+      {
+        m_buffer->Add (Create<Packet> (512));
+      }
+  }
+  uint32_t m_window;
+  Ptr<TcpTxBuffer> m_buffer;
+  SequenceNumber32 m_next;
+  uint32_t m_sink;
+};
+
+// ===========================================================================
+// The receiver side of a bulk TCP transfer with losses: each window of
+// segments arrives with its first segment missing, which arrives last,
+// and the window is then read by the application.  An operation is the
+// reception of one segment.
+// ===========================================================================
+class TcpRxBufferBenchmark : public Benchmark
+{
+public:
+  TcpRxBufferBenchmark (uint32_t window) : m_window (window), m_sink (0) {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "tcp-rx-buffer-reorder/window=" << m_window;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    m_buffer = CreateObject<TcpRxBuffer> (0);
+    m_buffer->SetMaxBufferSize (m_window);
+    m_segments = m_window / 536;
+    m_received = 0;
+  }
+  virtual void Run (uint32_t n)
+  {
+    for (uint32_t i = 0; i < n; i++)
+      {
+        // segments 1 to m_segments - 1 of the window, then segment 0.
+        uint32_t index = (m_received + 1) % m_segments;
+        TcpHeader header;
+        header.SetSequenceNumber (m_buffer->NextRxSequence () + SequenceNumber32 (536 * index));
+        m_buffer->Add (Create<Packet> (536), header);
+        m_received++;
+        if (index == 0)
+          {
+            Ptr<Packet> data = m_buffer->Extract (m_window);
+            m_sink += data->GetSize ();
+            m_received = 0;
+          }
+      }
+  }
+  virtual void Teardown (void)
+  {
+    m_buffer = 0;
+  }
+private:
+  uint32_t m_window;
+  Ptr<TcpRxBuffer> m_buffer;
+  uint32_t m_segments;
+  uint32_t m_received;
+  uint32_t m_sink;
+};
+
+// ===========================================================================
+// The hold model on a Scheduler: with n pending events, remove the next
+// one and insert a new one at a random delay after it.
+// ===========================================================================
+class SchedulerBenchmark : public Benchmark
+{
+public:
+  SchedulerBenchmark (std::string typeId, uint32_t nEvents)
+    : m_typeId (typeId),
+      m_nEvents (nEvents),
+      m_random (nEvents)
+  {}
+  virtual std::string GetName (void) const
+  {
+    std::ostringstream oss;
+    oss << "scheduler/" << m_typeId.substr (m_typeId.find ("::") + 2) << "/n=" << m_nEvents;
+    return oss.str ();
+  }
+  virtual void Setup (void)
+  {
+    ObjectFactory factory;
+    factory.SetTypeId (m_typeId);
+    m_scheduler = factory.Create<Scheduler> ();
+    m_uid = 0;
+    for (uint32_t i = 0; i < m_nEvents; i++)
+      {
+        Scheduler::Event ev;
+        ev.impl = 0;
+        ev.key.m_ts = GetDelay ();
+        ev.key.m_uid = m_uid++;
+        ev.key.m_context = 0;
+        m_scheduler->Insert (ev);
+      }
+  }
+  virtual void Run (uint32_t n)
+  {
+    for (uint32_t i = 0; i < n; i++)
+      {
+        Scheduler::Event ev = m_scheduler->RemoveNext ();
+        ev.key.m_ts += GetDelay ();
+        ev.key.m_uid = m_uid++;
+        m_scheduler->Insert (ev);
+      }
+  }
+  virtual void Teardown (void)
+  {
+    while (!m_scheduler->IsEmpty ())
+      {
+        m_scheduler->RemoveNext ();
+      }
+    m_scheduler = 0;
+  }
+private:
+  uint64_t GetDelay (void)
+  {
+    // a mix of short protocol timers and longer application timers.
+    return (m_random.GetInteger () & 7) == 0 ? m_random.GetInteger () % 1000000000 : m_random.GetInteger () % 1000000;
+  }
+  std::string m_typeId;
+  uint32_t m_nEvents;
+  BenchRandom m_random;
+  Ptr<Scheduler> m_scheduler;
+  uint32_t m_uid;
+};
+
+struct BenchResult
+{
+  std::string name;
+  uint32_t iterations;
+  // nanoseconds per operation of each sample, sorted.
+  std::vector<double> samples;
+};
+
+uint64_t
+GetMicroSeconds (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return static_cast<uint64_t> (tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+uint64_t
+TimeSample (Benchmark &bench, uint32_t n)
+{
+  uint64_t start = GetMicroSeconds ();
+  bench.Run (n);
+  uint64_t end = GetMicroSeconds ();
+  bench.Drain ();
+  return end - start;
+}
+
+BenchResult
+Measure (Benchmark &bench, uint32_t nSamples, uint32_t minSampleMs)
+{
+  BenchResult result;
+  result.name = bench.GetName ();
+  bench.Setup ();
+  // the calibration samples also warm up the caches and the allocators.
+  uint32_t n = 1;
+  while (TimeSample (bench, n) < minSampleMs * 1000 && n < (1U << 24))
+    {
+      n *= 2;
+    }
+  result.iterations = n;
+  for (uint32_t i = 0; i < nSamples; i++)
+    {
+      result.samples.push_back (TimeSample (bench, n) * 1000.0 / n);
+    }
+  bench.Teardown ();
+  std::sort (result.samples.begin (), result.samples.end ());
+  return result;
+}
+
+// nearest rank percentile of sorted samples.
+double
+Percentile (const std::vector<double> &samples, double p)
+{
+  uint32_t rank = static_cast<uint32_t> (std::ceil (p / 100.0 * samples.size ()));
+  return samples[rank > 0 ? rank - 1 : 0];
+}
+
+void
+WriteJson (std::ostream &os, const std::vector<BenchResult> &results, uint32_t nSamples)
+{
+  // one benchmark per line, ReadBaseline depends on it.
+  os << "{\n  \"suite\": \"bench-hotpaths\",\n  \"unit\": \"ns/op\",\n  \"samples\": " << nSamples
+     << ",\n  \"benchmarks\": [\n";
+  os << std::fixed << std::setprecision (1);
+  for (uint32_t i = 0; i < results.size (); i++)
+    {
+      const BenchResult &r = results[i];
+      double sum = 0;
+      for (uint32_t j = 0; j < r.samples.size (); j++)
+        {
+          sum += r.samples[j];
+        }
+      os << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+         << ", \"min\": " << r.samples.front ()
+         << ", \"p50\": " << Percentile (r.samples, 50)
+         << ", \"p90\": " << Percentile (r.samples, 90)
+         << ", \"p99\": " << Percentile (r.samples, 99)
+         << ", \"max\": " << r.samples.back ()
+         << ", \"mean\": " << sum / r.samples.size ()
+         << "}" << (i + 1 < results.size () ? "," : "") << "\n";
+    }
+  os << "  ]\n}\n";
+}
+
+// the medians of a report written by WriteJson.
+bool
+ReadBaseline (std::string fileName, std::map<std::string, double> &medians)
+{
+  std::ifstream is (fileName.c_str ());
+  if (!is.is_open ())
+    {
+      return false;
+    }
+  const std::string nameKey = "\"name\": \"";
+  const std::string p50Key = "\"p50\": ";
+  std::string line;
+  while (std::getline (is, line))
+    {
+      std::string::size_type name = line.find (nameKey);
+      std::string::size_type p50 = line.find (p50Key);
+      if (name == std::string::npos || p50 == std::string::npos)
+        {
+          continue;
+        }
+      name += nameKey.size ();
+      std::string::size_type nameEnd = line.find ('"', name);
+      medians[line.substr (name, nameEnd - name)] = atof (line.c_str () + p50 + p50Key.size ());
+    }
+  return true;
+}
+
+// returns the number of regressions.
+uint32_t
+Compare (const std::vector<BenchResult> &results, const std::map<std::string, double> &baseline,
+         double tolerance)
+{
+  uint32_t regressions = 0;
+  std::cerr << std::fixed << std::setprecision (1);
+  for (std::vector<BenchResult>::const_iterator i = results.begin (); i != results.end (); ++i)
+    {
+      double median = Percentile (i->samples, 50);
+      std::cerr << std::left << std::setw (48) << i->name << std::right;
+      std::map<std::string, double>::const_iterator j = baseline.find (i->name);
+      if (j == baseline.end () || j->second <= 0)
+        {
+          std::cerr << std::setw (12) << "-" << std::setw (12) << median << "  (new)" << std::endl;
+          continue;
+        }
+      double change = (median - j->second) / j->second;
+      std::cerr << std::setw (12) << j->second << std::setw (12) << median
+                << std::showpos << std::setw (9) << change * 100 << "%" << std::noshowpos;
+      if (change > tolerance)
+        {
+          std::cerr << "  REGRESSION";
+          regressions++;
+        }
+      std::cerr << std::endl;
+    }
+  return regressions;
+}
+
+} // anonymous namespace
+
+int main (int argc, char *argv[])
+{
+  uint32_t nSamples = 31;
+  uint32_t minSampleMs = 20;
+  std::string filter;
+  std::string output;
+  std::string baselineFile;
+  double tolerance = 0.1;
+
+  CommandLine cmd;
+  cmd.AddValue ("samples", "The number of timed samples of each benchmark.", nSamples);
+  cmd.AddValue ("min-sample-time", "The minimum duration (ms) of a sample.", minSampleMs);
+  cmd.AddValue ("filter", "Only run the benchmarks whose name contains this string.", filter);
+  cmd.AddValue ("output", "The file to write the JSON report to, stdout if empty.", output);
+  cmd.AddValue ("baseline", "A JSON report to compare the medians with.", baselineFile);
+  cmd.AddValue ("tolerance", "The relative slowdown of a median reported as a regression.", tolerance);
+  cmd.Parse (argc, argv);
+
+  std::map<std::string, double> baseline;
+  if (!baselineFile.empty () && !ReadBaseline (baselineFile, baseline))
+    {
+      std::cerr << "unable to read baseline " << baselineFile << std::endl;
+      return 2;
+    }
+
+  std::vector<Benchmark *> benchmarks;
+  uint32_t nPhys[] = { 10, 50, 200 };
+  for (uint32_t i = 0; i < sizeof (nPhys) / sizeof (nPhys[0]); i++)
+    {
+      benchmarks.push_back (new ChannelSendBenchmark (nPhys[i]));
+    }
+  uint32_t nFrames[] = { 1, 4, 16 };
+  for (uint32_t i = 0; i < sizeof (nFrames) / sizeof (nFrames[0]); i++)
+    {
+      benchmarks.push_back (new InterferenceBenchmark (nFrames[i]));
+    }
+  uint32_t nNeighbors[] = { 10, 100, 1000 };
+  for (uint32_t i = 0; i < sizeof (nNeighbors) / sizeof (nNeighbors[0]); i++)
+    {
+      benchmarks.push_back (new BestNeighborBenchmark (nNeighbors[i]));
+    }
+  uint32_t nRoutes[] = { 10, 1000, 10000 };
+  for (uint32_t i = 0; i < sizeof (nRoutes) / sizeof (nRoutes[0]); i++)
+    {
+      benchmarks.push_back (new StaticRoutingBenchmark (nRoutes[i]));
+    }
+  uint32_t windows[] = { 16384, 131072, 1048576 };
+  for (uint32_t i = 0; i < sizeof (windows) / sizeof (windows[0]); i++)
+    {
+      benchmarks.push_back (new TcpTxBufferBenchmark (windows[i]));
+    }
+  for (uint32_t i = 0; i < sizeof (windows) / sizeof (windows[0]); i++)
+    {
+      benchmarks.push_back (new TcpRxBufferBenchmark (windows[i]));
+    }
+  benchmarks.push_back (new PacketHeadersBenchmark (64));
+  benchmarks.push_back (new PacketHeadersBenchmark (1500));
+  const char *schedulers[] = { "ns3::ListScheduler", "ns3::HeapScheduler", "ns3::MapScheduler",
+                               "ns3::CalendarScheduler", "ns3::Ns2CalendarScheduler" };
+  uint32_t nEvents[] = { 128, 4096 };
+  for (uint32_t i = 0; i < sizeof (schedulers) / sizeof (schedulers[0]); i++)
+    {
+      for (uint32_t j = 0; j < sizeof (nEvents) / sizeof (nEvents[0]); j++)
+        {
+          benchmarks.push_back (new SchedulerBenchmark (schedulers[i], nEvents[j]));
+        }
+    }
+
+  std::vector<BenchResult> results;
+  for (std::vector<Benchmark *>::iterator i = benchmarks.begin (); i != benchmarks.end (); ++i)
+    {
+      if ((*i)->GetName ().find (filter) != std::string::npos)
+        {
+          std::cerr << "running " << (*i)->GetName () << std::endl;
+          results.push_back (Measure (**i, nSamples, minSampleMs));
+        }
+      delete *i;
+    }
+
+  if (output.empty ())
+    {
+      WriteJson (std::cout, results, nSamples);
+    }
+  else
+    {
+      std::ofstream os (output.c_str ());
+      WriteJson (os, results, nSamples);
+    }
+
+  if (!baselineFile.empty ())
+    {
+      return Compare (results, baseline, tolerance) > 0 ? 1 : 0;
+    }
+  return 0;
+}
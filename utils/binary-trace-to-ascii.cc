@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Convert a trace written by BinaryTraceFile back to the line oriented
+// ascii trace format:
+//
+//   <event> <time in seconds> /NodeList/<node>/DeviceList/<device> uid <uid> size <size>
+//
+// The binary format does not keep packet contents, so the printed packet of
+// the ascii traces is replaced by the packet uid and size.
+//
+// Usage: binary-trace-to-ascii --input=trace.btr [--output=trace.tr]
+//        [--node=<id>] [--from=<seconds>] [--to=<seconds>]
+//
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <stdlib.h>
+
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+  int64_t node = -1;
+  double from = 0.0;
+  double to = -1.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "Binary trace file to read", input);
+  cmd.AddValue ("output", "Ascii file to write (default: standard output)", output);
+  cmd.AddValue ("node", "Only print events of this node id", node);
+  cmd.AddValue ("from", "Only print events at or after this time (s)", from);
+  cmd.AddValue ("to", "Only print events at or before this time (s)", to);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "binary-trace-to-ascii: --input is required" << std::endl;
+      exit (1);
+    }
+
+  BinaryTraceReader reader;
+  if (!reader.Open (input))
+    {
+      std::cerr << "binary-trace-to-ascii: unable to read " << input << std::endl;
+      exit (1);
+    }
+
+  std::ofstream file;
+  std::ostream *os = &std::cout;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      if (!file.is_open ())
+        {
+          std::cerr << "binary-trace-to-ascii: unable to open " << output << std::endl;
+          exit (1);
+        }
+      os = &file;
+    }
+
+  std::vector<BinaryTraceFile::Record> records;
+  uint64_t count = 0;
+  while (reader.ReadBlock (records))
+    {
+      for (std::vector<BinaryTraceFile::Record>::const_iterator i = records.begin (); i != records.end (); ++i)
+        {
+          double seconds = i->time / 1e9;
+          if (node >= 0 && i->node != node)
+            {
+              continue;
+            }
+          if (seconds < from || (to >= 0.0 && seconds > to))
+            {
+              continue;
+            }
+          *os << i->event << " " << seconds
+              << " /NodeList/" << i->node << "/DeviceList/" << i->device
+              << " uid " << i->uid << " size " << i->size << "\n";
+          ++count;
+        }
+    }
+  os->flush ();
+
+  std::cerr << count << " events converted" << std::endl;
+  return 0;
+}
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Format the log messages recorded by LogRecorder, one line per message:
+//
+//   <time in seconds>s <node> <component>:<function>(): <message>
+//
+// Usage: log-recorder-to-ascii --input=log.bin [--output=log.txt]
+//
+
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "Log recorder file to read", input);
+  cmd.AddValue ("output", "Ascii file to write (default: standard output)", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "log-recorder-to-ascii: --input is required" << std::endl;
+      exit (1);
+    }
+
+  std::ifstream is (input.c_str (), std::ios::in | std::ios::binary);
+  if (!is.is_open ())
+    {
+      std::cerr << "log-recorder-to-ascii: unable to read " << input << std::endl;
+      exit (1);
+    }
+
+  std::ofstream file;
+  std::ostream *os = &std::cout;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      if (!file.is_open ())
+        {
+          std::cerr << "log-recorder-to-ascii: unable to open " << output << std::endl;
+          exit (1);
+        }
+      os = &file;
+    }
+
+  if (!LogRecorder::Decode (is, *os))
+    {
+      os->flush ();
+      std::cerr << "log-recorder-to-ascii: " << input << " is not a log recorder file or is truncated" << std::endl;
+      exit (1);
+    }
+  os->flush ();
+  return 0;
+}